@@ -59,8 +59,8 @@ static void compute_score_way(type::PT_Data&, georef::GeoRef& georef) {
 
 static void compute_score_stop_point(type::PT_Data& pt_data, georef::GeoRef& georef) {
     // The scocre of each admin(level 8) is attributed to all its stop_points
-    for (auto it = pt_data.stop_point_autocomplete.word_quality_list.begin();
-         it != pt_data.stop_point_autocomplete.word_quality_list.end(); ++it) {
+    for (auto it = pt_data.stop_point_autocomplete->word_quality_list.begin();
+         it != pt_data.stop_point_autocomplete->word_quality_list.end(); ++it) {
         for (navitia::georef::Admin* admin : pt_data.stop_points[it->first]->admin_list) {
             if (admin->level == 8) {
                 it->second.score = georef.fl_admin.word_quality_list.at(admin->idx).score;
@@ -88,7 +88,7 @@ static void compute_score_stop_area(type::PT_Data& pt_data, const georef::GeoRef
 
     // Ajust the score of each stop_area from 0 to 100 using maximum score (max_score)
     if (max_score > 0) {
-        for (auto& it : pt_data.stop_area_autocomplete.word_quality_list) {
+        for (auto& it : pt_data.stop_area_autocomplete->word_quality_list) {
             const size_t ad_score = admin_score(pt_data.stop_areas[it.first]->admin_list, georef);
             it.second.score = ad_score + (pt_data.stop_areas[it.first]->stop_point_list.size() * 100) / max_score;
         }
@@ -159,11 +159,19 @@ void Autocomplete<T>::compute_score(type::PT_Data& pt_data, georef::GeoRef& geor
 }
 
 std::pair<size_t, size_t> longest_common_substring(const std::string& str1, const std::string& str2) {
+    std::vector<size_t> curr, prev;
+    return longest_common_substring(str1, str2, curr, prev);
+}
+
+std::pair<size_t, size_t> longest_common_substring(const std::string& str1,
+                                                   const std::string& str2,
+                                                   std::vector<size_t>& curr,
+                                                   std::vector<size_t>& prev) {
     if (str1.empty() || str2.empty()) {
         return {0, 0};
     }
-    auto curr = std::vector<size_t>(str2.size());
-    auto prev = std::vector<size_t>(str2.size());
+    curr.assign(str2.size(), 0);
+    prev.assign(str2.size(), 0);
     size_t max_substr = 0;
     size_t position = 0;
 
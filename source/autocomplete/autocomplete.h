@@ -35,11 +35,13 @@ www.navitia.io
 #include <boost/serialization/vector.hpp>
 #include <boost/serialization/utility.hpp>
 #include <boost/serialization/map.hpp>
+#include <boost/serialization/set.hpp>
 #include <algorithm>
 #include <boost/regex.hpp>
 #include <map>
 #include <unordered_map>
 #include <set>
+#include "autocomplete/trie.h"
 #include "type/type_interfaces.h"
 #include "type/geographical_coord.h"
 #include "type/fwd_type.h"
@@ -59,6 +61,11 @@ struct Compare {
 };
 
 std::pair<size_t, size_t> longest_common_substring(const std::string&, const std::string&);
+/// longest_common_substring, with the buffers to use
+std::pair<size_t, size_t> longest_common_substring(const std::string&,
+                                                   const std::string&,
+                                                   std::vector<size_t>& curr,
+                                                   std::vector<size_t>& prev);
 
 using autocomplete_map = std::map<std::string, std::string, Compare>;
 /** Map de type Autocomplete
@@ -104,16 +111,13 @@ struct Autocomplete {
     /// Structure temporaire pour construire l'indexe
     std::map<std::string, std::set<T> > temp_word_map;
 
-    /// À chaque mot (par exemple "rue" ou "jaures") on associe un tableau de T qui contient la liste des éléments
-    /// contenant ce mot
-    typedef std::pair<std::string, std::vector<T> > vec_elt;
-
-    /// Structure principale de notre indexe
-    std::vector<vec_elt> word_dictionnary;
+    /// Structure principale de notre indexe : à chaque mot (par exemple "rue" ou "jaures") on associe la liste des
+    /// éléments contenant ce mot
+    Trie<T> word_dictionnary;
 
     /// Structure temporaire pour garder les patterns et leurs indexs
     std::map<std::string, std::set<T> > temp_pattern_map;
-    std::vector<vec_elt> pattern_dictionnary;
+    Trie<T> pattern_dictionnary;
 
     /// Structure pour garder les informations comme nombre des mots, la distance des mots...dans chaque Autocomplete
     /// (Position)
@@ -122,9 +126,17 @@ struct Autocomplete {
     // for each T, we store the originaly indexed string (for better score handling)
     std::map<T, std::string> indexed_string;
 
+    /// The elements inserted, updated or erased after the build (by the realtime) are kept apart from the
+    /// dictionnaries, that are expensive to modify: their words and patterns are in these maps, and the elements
+    /// whose entries in the dictionnaries are outdated are ignored.
+    std::map<std::string, std::set<T> > word_delta;
+    std::map<std::string, std::set<T> > pattern_delta;
+    std::set<T> outdated;
+
     template <class Archive>
     void serialize(Archive& ar, const unsigned int) {
-        ar& word_dictionnary& word_quality_list& pattern_dictionnary& object_type& indexed_string;
+        ar& word_dictionnary& word_quality_list& pattern_dictionnary& object_type& indexed_string& word_delta&
+            pattern_delta& outdated;
     }
 
     /// Efface les structures de données sérialisées
@@ -135,6 +147,9 @@ struct Autocomplete {
         pattern_dictionnary.clear();
         word_quality_list.clear();
         indexed_string.clear();
+        word_delta.clear();
+        pattern_delta.clear();
+        outdated.clear();
     }
 
     // Méthodes permettant de construire l'indexe
@@ -147,24 +162,59 @@ struct Autocomplete {
                     T position,
                     const std::set<std::string>& ghostwords,
                     const autocomplete_map& synonyms) {
-        word_quality wc;
-        int distance = 0;
-
         // Appeler la méthode pour traiter les synonymes avant de les ajouter dans le dictionaire:
         auto vec_word = tokenize(str, ghostwords, synonyms);
         // créer des patterns pour chaque mot et les ajouter dans temp_pattern_map:
         add_vec_pattern(vec_word, position);
 
-        int count = vec_word.size();
-        auto vec = vec_word.begin();
-        while (vec != vec_word.end()) {
-            temp_word_map[*vec].insert(position);
-            distance += (*vec).size();
-            ++vec;
+        for (const auto& word : vec_word) {
+            temp_word_map[word].insert(position);
+        }
+        set_word_quality(str, position, vec_word, 0);
+    }
+
+    /** Adds or updates an element after the build, without rebuilding the dictionnaries
+     *
+     * The score of an updated element is kept.
+     */
+    void insert(const std::string& str,
+                T position,
+                const std::set<std::string>& ghostwords,
+                const autocomplete_map& synonyms) {
+        const auto it = word_quality_list.find(position);
+        const int score = it == word_quality_list.end() ? 0 : it->second.score;
+        erase(position);
+
+        auto vec_word = tokenize(str, ghostwords, synonyms);
+        for (const auto& pattern : make_vec_pattern(vec_word, 2)) {
+            pattern_delta[pattern].insert(position);
+        }
+        for (const auto& word : vec_word) {
+            word_delta[word].insert(position);
+        }
+        set_word_quality(str, position, vec_word, score);
+    }
+
+    /// Removes an element after the build, without rebuilding the dictionnaries
+    void erase(T position) {
+        if (word_quality_list.erase(position) == 0) {
+            return;
+        }
+        indexed_string.erase(position);
+        outdated.insert(position);
+        for (auto* delta : {&word_delta, &pattern_delta}) {
+            for (auto it = delta->begin(); it != delta->end();) {
+                it->second.erase(position);
+                it = it->second.empty() ? delta->erase(it) : std::next(it);
+            }
         }
-        wc.word_count = count;
-        wc.word_distance = distance;
-        wc.score = 0;
+    }
+
+    void set_word_quality(const std::string& str, T position, const std::set<std::string>& vec_word, int score) {
+        word_quality wc;
+        wc.word_count = vec_word.size();
+        wc.word_distance = words_length(vec_word);
+        wc.score = score;
         word_quality_list[position] = wc;
         indexed_string[position] = strip_accents_and_lower(str);
     }
@@ -201,94 +251,147 @@ struct Autocomplete {
     /** Construit la structure finale
      *
      * Les map et les set sont bien pratiques, mais leurs performances sont mauvaises avec des petites données (comme
-     * des ints)
+     * des ints), et ils prennent beaucoup de place : ils sont libérés une fois les tries construits.
      */
     void build() {
-        word_dictionnary.reserve(temp_word_map.size());
-        for (auto key_val : temp_word_map) {
-            word_dictionnary.push_back(
-                std::make_pair(key_val.first, std::vector<T>(key_val.second.begin(), key_val.second.end())));
-        }
+        word_dictionnary.build(temp_word_map);
+        temp_word_map.clear();
 
         // Dictionnaire des patterns:
-        pattern_dictionnary.reserve((temp_pattern_map.size()));
-        for (auto key_val : temp_pattern_map) {
-            pattern_dictionnary.push_back(
-                std::make_pair(key_val.first, std::vector<T>(key_val.second.begin(), key_val.second.end())));
-        }
+        pattern_dictionnary.build(temp_pattern_map);
+        temp_pattern_map.clear();
     }
 
     // Méthode pour calculer le score de chaque élément par son admin.
     void compute_score(type::PT_Data& pt_data, georef::GeoRef& georef, const type::Type_e type);
     // Méthodes premettant de retrouver nos éléments
-    /** Définit un fonctor permettant de parcourir notre structure un peu particulière */
-    struct comp {
-        /** Utilisé pour trouver la borne inf. Quand on cherche av, on veux que avenue soit également trouvé
-         * Il faut donc que "av" < "avenue" soit false
-         */
-        bool operator()(const std::string& a, const std::pair<std::string, std::vector<T> >& b) {
-            if (b.first.find(a) == 0)
-                return false;
-            return (a < b.first);
-        }
 
-        /** Utilisé pour la borne sup. Ici rien d'extraordinaire */
-        bool operator()(const std::pair<std::string, std::vector<T> >& b, const std::string& a) {
-            return (b.first < a);
-        }
+    /** Buffers reused by all the searches of a thread (i.e. of a worker), so that a search does not allocate once they
+     * are big enough
+     */
+    struct Scratch {
+        std::vector<T> found;
+        std::vector<T> matched;
+        /// for the search with patterns, the number of patterns found for each element, and the elements found
+        std::vector<int> nb_found;
+        std::vector<T> touched;
+        /// the best results, as a heap
+        std::vector<fl_quality> best;
+        std::vector<size_t> lcs_curr;
+        std::vector<size_t> lcs_prev;
     };
 
-    /** Retrouve toutes les positions des élements contenant le mot des mots qui commencent par token */
-    std::vector<T> match(const std::string& token, const std::vector<vec_elt>& vec_source) const {
-        // Les éléments dans vec_map sont triés par ordre alphabétiques, il suffit donc de trouver la borne inf et sup
-        auto lower = std::lower_bound(vec_source.begin(), vec_source.end(), token, comp());
-        auto upper = std::upper_bound(vec_source.begin(), vec_source.end(), token, comp());
+    static Scratch& scratch() {
+        static thread_local Scratch s;
+        return s;
+    }
 
-        std::vector<T> result;
+    /** Keeps the nbmax best elements pushed, with the same result as a sort_and_truncate on all of them
+     *
+     * It is what std::partial_sort does, without storing all the elements first.
+     */
+    template <class Cmp>
+    struct BoundedHeap {
+        std::vector<fl_quality>& heap;
+        size_t nbmax;
+        Cmp cmp;
+
+        BoundedHeap(std::vector<fl_quality>& heap, size_t nbmax, Cmp cmp) : heap(heap), nbmax(nbmax), cmp(cmp) {
+            heap.clear();
+            heap.reserve(nbmax);
+        }
 
-        // On concatène tous les indexes
-        // Pour les raisons de perfs mesurées expérimentalement, on accepte des doublons
-        for (; lower != upper; ++lower) {
-            std::vector<T> other = lower->second;
-            result.insert(result.end(), other.begin(), other.end());
+        void push(const fl_quality& quality) {
+            if (heap.size() < nbmax) {
+                heap.push_back(quality);
+                if (heap.size() == nbmax) {
+                    std::make_heap(heap.begin(), heap.end(), cmp);
+                }
+            } else if (nbmax > 0 && cmp(quality, heap.front())) {
+                // the worst result, at the top, is replaced
+                std::pop_heap(heap.begin(), heap.end(), cmp);
+                heap.back() = quality;
+                std::push_heap(heap.begin(), heap.end(), cmp);
+            }
         }
-        return result;
-    }
 
-    /** On passe une chaîne de charactère contenant des mots et on trouve toutes les positions contenant tous ces mots*/
-    std::vector<T> find(const std::set<std::string>& vecStr) const {
-        std::vector<T> result;
-        auto vec = vecStr.begin();
-        if (vec != vecStr.end()) {
-            // Premier résultat. Il y aura au plus ces indexes
-            result = match(*vec, word_dictionnary);
-
-            // If there is only one word to search we have to sort and delete duplicate results
-            if (vecStr.size() == 1) {
-                std::sort(result.begin(), result.end());
-                result.erase(unique(result.begin(), result.end()), result.end());
+        std::vector<fl_quality> sorted() {
+            if (heap.size() < nbmax) {
+                std::make_heap(heap.begin(), heap.end(), cmp);
             }
+            std::sort_heap(heap.begin(), heap.end(), cmp);
+            return std::vector<fl_quality>(heap.begin(), heap.end());
+        }
+    };
 
-            for (++vec; vec != vecStr.end(); ++vec) {
-                std::vector<T> new_result;
-                std::sort(result.begin(), result.end());
-                for (auto i : match(*vec, word_dictionnary)) {
-                    // Binary search fait une recherche dichotomique pour savoir si l'élément i existe
-                    // S'il existe dans les deux cas, on le garde
-                    if (binary_search(result.begin(), result.end(), i)) {
-                        new_result.push_back(i);
-                    }
+    template <class Cmp>
+    static BoundedHeap<Cmp> make_bounded_heap(std::vector<fl_quality>& heap, size_t nbmax, Cmp cmp) {
+        return BoundedHeap<Cmp>(heap, nbmax, cmp);
+    }
+
+    /** Ajoute à result toutes les positions des élements contenant un des mots qui commencent par token */
+    void match(const std::string& token,
+               const Trie<T>& dictionnary,
+               const std::map<std::string, std::set<T> >& delta,
+               std::vector<T>& result) const {
+        // Les mots commençant par token sont un sous arbre du trie, dont on concatène tous les indexes
+        // Pour les raisons de perfs mesurées expérimentalement, on accepte des doublons
+        if (outdated.empty()) {
+            dictionnary.for_each_posting(token, [&](T position) { result.push_back(position); });
+        } else {
+            dictionnary.for_each_posting(token, [&](T position) {
+                if (outdated.count(position) == 0) {
+                    result.push_back(position);
                 }
-                // The function "unique" works only if the vector new_result is sorted.
-                std::sort(new_result.begin(), new_result.end());
+            });
+        }
 
-                // std::unique retrie les donnée et fout les doublons à la fin
-                // La fonction retourne un itérateur vers le premier doublon
-                // Expérimentalement le gain est très faible
-                result.assign(new_result.begin(), std::unique(new_result.begin(), new_result.end()));
+        // the elements inserted after the build
+        for (auto it = delta.lower_bound(token); it != delta.end() && it->first.compare(0, token.size(), token) == 0;
+             ++it) {
+            result.insert(result.end(), it->second.begin(), it->second.end());
+        }
+    }
+
+    /// Keeps in the sorted and unique result only the elements also in the sorted other, in place
+    static void intersect(std::vector<T>& result, const std::vector<T>& other) {
+        auto out = result.begin();
+        auto it = other.begin();
+        for (auto in = result.begin(); in != result.end() && it != other.end(); ++in) {
+            it = std::lower_bound(it, other.end(), *in);
+            if (it != other.end() && *it == *in) {
+                *out++ = *in;
             }
         }
-        return result;
+        result.erase(out, result.end());
+    }
+
+    /** On passe une chaîne de charactère contenant des mots et on trouve toutes les positions contenant tous ces mots,
+     * triées, dans s.found */
+    void find(const std::set<std::string>& vecStr, Scratch& s) const {
+        s.found.clear();
+        auto vec = vecStr.begin();
+        if (vec == vecStr.end()) {
+            return;
+        }
+        // Premier résultat. Il y aura au plus ces indexes
+        match(*vec, word_dictionnary, word_delta, s.found);
+        std::sort(s.found.begin(), s.found.end());
+        s.found.erase(std::unique(s.found.begin(), s.found.end()), s.found.end());
+
+        for (++vec; vec != vecStr.end() && !s.found.empty(); ++vec) {
+            s.matched.clear();
+            match(*vec, word_dictionnary, word_delta, s.matched);
+            std::sort(s.matched.begin(), s.matched.end());
+            intersect(s.found, s.matched);
+        }
+    }
+
+    /** On passe une chaîne de charactère contenant des mots et on trouve toutes les positions contenant tous ces mots*/
+    std::vector<T> find(const std::set<std::string>& vecStr) const {
+        auto& s = scratch();
+        find(vecStr, s);
+        return s.found;
     }
 
     /** Définit un fonctor permettant de parcourir notqualityre structure un peu particulière : trier par la valeur
@@ -312,11 +415,6 @@ struct Autocomplete {
         bool operator()(T a, T b) const { return fl_result.at(a).quality > fl_result.at(b).quality; }
     };
 
-    std::vector<fl_quality> sort_and_truncate_by_quality(std::vector<fl_quality> input, size_t nbmax) const {
-        sort_and_truncate(input, nbmax, [](const fl_quality& a, const fl_quality& b) { return a.quality > b.quality; });
-        return input;
-    }
-
     /**
      * compute the scores of a result
      *
@@ -333,10 +431,17 @@ struct Autocomplete {
      * @param position: element to score
      */
     std::tuple<int, size_t, int> compute_result_scores(const std::string& str, T position) const {
+        return compute_lowered_result_scores(strip_accents_and_lower(str), position, scratch());
+    }
+
+    /// compute_result_scores, with the string to search already without accents and lower case
+    std::tuple<int, size_t, int> compute_lowered_result_scores(const std::string& lowered_str,
+                                                               T position,
+                                                               Scratch& s) const {
         auto global_score = word_quality_list.at(position).score;
 
         const auto& indexed_str = indexed_string.at(position);
-        auto lcs_and_pos = longest_common_substring(strip_accents_and_lower(str), indexed_str);
+        auto lcs_and_pos = longest_common_substring(lowered_str, indexed_str, s.lcs_curr, s.lcs_prev);
 
         return std::make_tuple(global_score, lcs_and_pos.first,
                                -1 * lcs_and_pos.second  // we want to minimize the position
@@ -349,32 +454,29 @@ struct Autocomplete {
                                           size_t nbmax,
                                           std::function<bool(T)> keep_element,
                                           const std::set<std::string>& ghostwords) const {
+        auto& s = scratch();
         auto vec = tokenize(str, ghostwords);
-        int wordLength = 0;
-        fl_quality quality;
-        std::vector<T> index_result;
         // Vector des ObjetTC index trouvés
-        index_result = find(vec);
-        wordLength = words_length(vec);
-
-        // Créer un vector de réponse:
-        std::vector<fl_quality> vec_quality;
+        find(vec, s);
+        const int wordLength = words_length(vec);
+        const auto lowered_str = strip_accents_and_lower(str);
 
-        for (auto i : index_result) {
+        // Seuls les nbmax meilleurs résultats sont gardés
+        auto best = make_bounded_heap(s.best, nbmax,
+                                      [](const fl_quality& a, const fl_quality& b) { return a.scores > b.scores; });
+        fl_quality quality;
+        for (auto i : s.found) {
             if (keep_element(i)) {
                 quality.idx = i;
                 quality.nb_found = word_quality_list.at(quality.idx).word_count;
                 quality.word_len = wordLength;
-                quality.scores = this->compute_result_scores(str, quality.idx);
+                quality.scores = this->compute_lowered_result_scores(lowered_str, quality.idx, s);
 
                 quality.quality = 100;
-                vec_quality.push_back(quality);
+                best.push(quality);
             }
         }
-
-        sort_and_truncate(vec_quality, nbmax,
-                          [](const fl_quality& a, const fl_quality& b) { return a.scores > b.scores; });
-        return vec_quality;
+        return best.sorted();
     }
 
     std::vector<fl_quality> compute_vec_quality(const std::string& str,
@@ -389,14 +491,15 @@ struct Autocomplete {
                                                       size_t nbmax,
                                                       std::function<bool(T)> keep_element,
                                                       const std::set<std::string>& ghostwords) const {
-        // Map temporaire pour garder les patterns trouvé:
-        std::unordered_map<T, fl_quality> fl_result;
-
-        // Vector temporaire des indexs
-        std::vector<T> index_result;
+        auto& s = scratch();
+        // the counts of the previous search are reset here, to be sure to start clean
+        for (auto i : s.touched) {
+            s.nb_found[i] = 0;
+        }
+        s.touched.clear();
 
-        // Créer un vector de réponse
-        std::vector<fl_quality> vec_quality;
+        auto best = make_bounded_heap(s.best, nbmax,
+                                      [](const fl_quality& a, const fl_quality& b) { return a.quality > b.quality; });
         fl_quality quality;
 
         auto vec_word = tokenize(str, ghostwords);
@@ -407,49 +510,48 @@ struct Autocomplete {
         // recherche pour le premier pattern:
         auto vec = vec_pattern.begin();
         if (vec != vec_pattern.end()) {
-            // Premier résultat:
-            index_result = match(*vec, pattern_dictionnary);
-
-            // Incrémenter la propriété "nb_found" pour chaque index des mots autocomplete dans vec_map
-            add_word_quality(fl_result, index_result);
-
-            // Recherche des mots qui restent
-            for (++vec; vec != vec_pattern.end(); ++vec) {
-                index_result = match(*vec, pattern_dictionnary);
-
-                // For each match of n-gram pattern word 1 is added to "nb_found"
-                add_word_quality(fl_result, index_result);
+            // For each match of n-gram pattern word 1 is added to "nb_found"
+            for (; vec != vec_pattern.end(); ++vec) {
+                s.matched.clear();
+                match(*vec, pattern_dictionnary, pattern_delta, s.matched);
+                add_word_quality(s, s.matched);
             }
 
             // Compute de highest score of objects found
             int max_score = 0;
-            for (auto ir : index_result) {
+            for (auto ir : s.matched) {
                 if (keep_element(ir)) {
                     max_score = word_quality_list.at(ir).score > max_score ? word_quality_list.at(ir).score : max_score;
                 }
             }
 
             // Here we keep object with match of patternized words >= 75%
-            for (auto pair : fl_result) {
-                if (keep_element(pair.first)
-                    && (((pattern_count - pair.second.nb_found) * 100) / pattern_count <= 25)) {
-                    quality.idx = pair.first;
-                    quality.nb_found = pair.second.nb_found;
+            const auto lowered_str = strip_accents_and_lower(str);
+            for (auto i : s.touched) {
+                const int nb_found = s.nb_found[i];
+                if (keep_element(i) && (((pattern_count - nb_found) * 100) / pattern_count <= 25)) {
+                    quality.idx = i;
+                    quality.nb_found = nb_found;
                     quality.word_len = wordLength;
-                    quality.scores = this->compute_result_scores(str, quality.idx);
+                    quality.scores = this->compute_lowered_result_scores(lowered_str, quality.idx, s);
                     quality.quality = calc_quality_pattern(quality, word_weight, max_score, pattern_count);
-                    vec_quality.push_back(quality);
+                    best.push(quality);
                 }
             }
         }
-        return sort_and_truncate_by_quality(vec_quality, nbmax);
+        return best.sorted();
     }
 
     /** pour chaque mot trouvé dans la liste des mots il faut incrémenter la propriété : nb_found*/
     /** Utilisé que pour une recherche partielle */
-    void add_word_quality(std::unordered_map<T, fl_quality>& fl_result, const std::vector<T>& found) const {
+    static void add_word_quality(Scratch& s, const std::vector<T>& found) {
         for (auto i : found) {
-            fl_result[i].nb_found++;
+            if (i >= s.nb_found.size()) {
+                s.nb_found.resize(i + 1, 0);
+            }
+            if (s.nb_found[i]++ == 0) {
+                s.touched.push_back(i);
+            }
         }
     }
 
@@ -467,7 +569,7 @@ struct Autocomplete {
         return result;
     }
 
-    int words_length(std::set<std::string>& words) const {
+    int words_length(const std::set<std::string>& words) const {
         int distance = 0;
         auto vec = words.begin();
         while (vec != words.end()) {
@@ -500,7 +602,8 @@ struct Autocomplete {
                                    const autocomplete_map& synonyms = autocomplete_map()) const {
         std::set<std::string> vec;
         boost::to_lower(strFind);
-        strFind = boost::regex_replace(strFind, boost::regex("( ){2,}"), " ");
+        static const boost::regex multiple_spaces("( ){2,}");
+        strFind = boost::regex_replace(strFind, multiple_spaces, " ");
 
         // traiter les caractères accentués
         strFind = strip_accents(strFind);
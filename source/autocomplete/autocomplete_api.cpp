@@ -169,8 +169,8 @@ static void update_quality(std::vector<Autocomplete<nt::idx_t>::fl_quality>& ac_
 static std::unordered_set<std::string> get_main_stop_areas(const navitia::type::Data& d) {
     std::unordered_set<std::string> result;
     for (const auto& admin : d.geo_ref->admins) {
-        for (const auto& sa : admin->main_stop_areas) {
-            result.insert(sa->uri);
+        for (const auto sa_idx : admin->main_stop_areas) {
+            result.insert(d.pt_data->stop_areas[sa_idx]->uri);
         }
     }
     return result;
@@ -188,10 +188,10 @@ static std::vector<Autocomplete<nt::idx_t>::fl_quality> complete(const type::Dat
     switch (type) {
         case nt::Type_e::StopArea:
             if (search_type == 0) {
-                result = d.pt_data->stop_area_autocomplete.find_complete(
+                result = d.pt_data->stop_area_autocomplete->find_complete(
                     q, nbmax, valid_admin_ptr(d.pt_data->stop_areas, admin_ptr), d.geo_ref->ghostwords);
             } else {
-                result = d.pt_data->stop_area_autocomplete.find_partial_with_pattern(
+                result = d.pt_data->stop_area_autocomplete->find_partial_with_pattern(
                     q, d.geo_ref->word_weight, nbmax, valid_admin_ptr(d.pt_data->stop_areas, admin_ptr),
                     d.geo_ref->ghostwords);
             }
@@ -206,10 +206,10 @@ static std::vector<Autocomplete<nt::idx_t>::fl_quality> complete(const type::Dat
             break;
         case nt::Type_e::StopPoint:
             if (search_type == 0) {
-                result = d.pt_data->stop_point_autocomplete.find_complete(
+                result = d.pt_data->stop_point_autocomplete->find_complete(
                     q, nbmax, valid_admin_ptr(d.pt_data->stop_points, admin_ptr), d.geo_ref->ghostwords);
             } else {
-                result = d.pt_data->stop_point_autocomplete.find_partial_with_pattern(
+                result = d.pt_data->stop_point_autocomplete->find_partial_with_pattern(
                     q, d.geo_ref->word_weight, nbmax, valid_admin_ptr(d.pt_data->stop_points, admin_ptr),
                     d.geo_ref->ghostwords);
             }
@@ -240,37 +240,37 @@ static std::vector<Autocomplete<nt::idx_t>::fl_quality> complete(const type::Dat
             break;
         case nt::Type_e::Network:
             if (search_type == 0) {
-                result = d.pt_data->network_autocomplete.find_complete(q, nbmax, [](type::idx_t) { return true; },
-                                                                       d.geo_ref->ghostwords);
+                result = d.pt_data->network_autocomplete->find_complete(q, nbmax, [](type::idx_t) { return true; },
+                                                                        d.geo_ref->ghostwords);
             } else {
-                result = d.pt_data->network_autocomplete.find_partial_with_pattern(
+                result = d.pt_data->network_autocomplete->find_partial_with_pattern(
                     q, d.geo_ref->word_weight, nbmax, [](type::idx_t) { return true; }, d.geo_ref->ghostwords);
             }
             break;
         case nt::Type_e::CommercialMode:
             if (search_type == 0) {
-                result = d.pt_data->mode_autocomplete.find_complete(q, nbmax, [](type::idx_t) { return true; },
-                                                                    d.geo_ref->ghostwords);
+                result = d.pt_data->mode_autocomplete->find_complete(q, nbmax, [](type::idx_t) { return true; },
+                                                                     d.geo_ref->ghostwords);
             } else {
-                result = d.pt_data->mode_autocomplete.find_partial_with_pattern(
+                result = d.pt_data->mode_autocomplete->find_partial_with_pattern(
                     q, d.geo_ref->word_weight, nbmax, [](type::idx_t) { return true; }, d.geo_ref->ghostwords);
             }
             break;
         case nt::Type_e::Line:
             if (search_type == 0) {
-                result = d.pt_data->line_autocomplete.find_complete(q, nbmax, [](type::idx_t) { return true; },
-                                                                    d.geo_ref->ghostwords);
+                result = d.pt_data->line_autocomplete->find_complete(q, nbmax, [](type::idx_t) { return true; },
+                                                                     d.geo_ref->ghostwords);
             } else {
-                result = d.pt_data->line_autocomplete.find_partial_with_pattern(
+                result = d.pt_data->line_autocomplete->find_partial_with_pattern(
                     q, d.geo_ref->word_weight, nbmax, [](type::idx_t) { return true; }, d.geo_ref->ghostwords);
             }
             break;
         case nt::Type_e::Route:
             if (search_type == 0) {
-                result = d.pt_data->route_autocomplete.find_complete(q, nbmax, [](type::idx_t) { return true; },
-                                                                     d.geo_ref->ghostwords);
+                result = d.pt_data->route_autocomplete->find_complete(q, nbmax, [](type::idx_t) { return true; },
+                                                                      d.geo_ref->ghostwords);
             } else {
-                result = d.pt_data->route_autocomplete.find_partial_with_pattern(
+                result = d.pt_data->route_autocomplete->find_partial_with_pattern(
                     q, d.geo_ref->word_weight, nbmax, [](type::idx_t) { return true; }, d.geo_ref->ghostwords);
             }
             break;
@@ -474,6 +474,102 @@ BOOST_AUTO_TEST_CASE(autocomplete_add_string_with_Line) {
     BOOST_CHECK_EQUAL(res.at(2).idx, 3);
 }
 
+/*
+ * Only the nbmax best results are kept, and the buffers reused from a search to another must not change the results
+ */
+BOOST_AUTO_TEST_CASE(autocomplete_find_truncated_test) {
+    autocomplete_map synonyms;
+    std::set<std::string> ghostwords;
+
+    Autocomplete<unsigned int> ac;
+    ac.add_string("rue jeanne d'arc", 0, ghostwords, synonyms);
+    ac.add_string("place jean jaures", 1, ghostwords, synonyms);
+    ac.add_string("rue jean paul gaultier paris", 2, ghostwords, synonyms);
+    ac.add_string("avenue jean jaures", 3, ghostwords, synonyms);
+    ac.add_string("rue jean jaures", 4, ghostwords, synonyms);
+    ac.add_string("rue jean zay", 5, ghostwords, synonyms);
+    ac.build();
+    for (unsigned int i = 0; i < 6; ++i) {
+        ac.word_quality_list[i].score = (i * 5) % 6;  // 0, 5, 4, 3, 2, 1
+    }
+    auto idx = [](const std::vector<Autocomplete<unsigned int>::fl_quality>& res) {
+        std::vector<unsigned int> result;
+        for (const auto& r : res) {
+            result.push_back(r.idx);
+        }
+        return result;
+    };
+    auto keep_all = [](unsigned int) { return true; };
+
+    // scores: 0 -> 0, 2 -> 4, 4 -> 2, 5 -> 1
+    BOOST_CHECK_EQUAL_RANGE(idx(ac.find_complete("rue jean", 10, keep_all, ghostwords)),
+                            std::vector<unsigned int>({2, 4, 5, 0}));
+    BOOST_CHECK_EQUAL_RANGE(idx(ac.find_complete("rue jean", 2, keep_all, ghostwords)),
+                            std::vector<unsigned int>({2, 4}));
+    BOOST_CHECK(ac.find_complete("rue jean", 0, keep_all, ghostwords).empty());
+    BOOST_CHECK_EQUAL_RANGE(idx(ac.find_complete("rue jean", 10, [](unsigned int i) { return i < 5; }, ghostwords)),
+                            std::vector<unsigned int>({2, 4, 0}));
+    BOOST_CHECK(ac.find_complete("rue toto", 10, keep_all, ghostwords).empty());
+
+    const auto partial = ac.find_partial_with_pattern("jaures", 5, 10, keep_all, ghostwords);
+    BOOST_REQUIRE_EQUAL(partial.size(), 3);
+    BOOST_CHECK_EQUAL(partial.at(0).nb_found, 5);
+    BOOST_CHECK_EQUAL(ac.find_partial_with_pattern("jaures", 5, 1, keep_all, ghostwords).size(), 1);
+    // the counts of the previous search are not kept
+    const auto again = ac.find_partial_with_pattern("jaures", 5, 10, keep_all, ghostwords);
+    BOOST_CHECK_EQUAL_RANGE(idx(again), idx(partial));
+    BOOST_CHECK_EQUAL(again.at(0).nb_found, 5);
+}
+
+/// The elements inserted, updated and erased after the build are found as if they were built
+BOOST_AUTO_TEST_CASE(autocomplete_insert_and_erase_after_build) {
+    autocomplete_map synonyms;
+    std::set<std::string> ghostwords;
+    int nbmax = 10;
+    auto keep_all = [](int) { return true; };
+    auto idxs = [](const std::vector<Autocomplete<unsigned int>::fl_quality>& res) {
+        std::set<unsigned int> result;
+        for (const auto& r : res) {
+            result.insert(r.idx);
+        }
+        return result;
+    };
+
+    Autocomplete<unsigned int> ac;
+    ac.add_string("rue jeanne d'arc", 0, ghostwords, synonyms);
+    ac.add_string("place jean jaures", 1, ghostwords, synonyms);
+    ac.add_string("avenue jean jaures", 2, ghostwords, synonyms);
+    ac.build();
+    ac.word_quality_list[2].score = 42;
+
+    ac.insert("rue jean zay", 3, ghostwords, synonyms);
+    BOOST_CHECK_EQUAL_RANGE(idxs(ac.find_complete("jean", nbmax, keep_all, ghostwords)),
+                            (std::set<unsigned int>{0, 1, 2, 3}));
+    BOOST_CHECK_EQUAL_RANGE(idxs(ac.find_complete("rue je", nbmax, keep_all, ghostwords)),
+                            (std::set<unsigned int>{0, 3}));
+
+    // updated: not found anymore with its old name, the score being kept
+    ac.insert("boulevard jean zay", 2, ghostwords, synonyms);
+    BOOST_CHECK_EQUAL_RANGE(idxs(ac.find_complete("jaures", nbmax, keep_all, ghostwords)),
+                            (std::set<unsigned int>{1}));
+    BOOST_CHECK_EQUAL_RANGE(idxs(ac.find_complete("zay", nbmax, keep_all, ghostwords)),
+                            (std::set<unsigned int>{2, 3}));
+    BOOST_CHECK_EQUAL(ac.word_quality_list.at(2).score, 42);
+    BOOST_CHECK_EQUAL(ac.word_quality_list.at(2).word_count, 3);
+
+    ac.erase(3);
+    ac.erase(0);
+    BOOST_CHECK_EQUAL_RANGE(idxs(ac.find_complete("jean", nbmax, keep_all, ghostwords)),
+                            (std::set<unsigned int>{1, 2}));
+    BOOST_CHECK(ac.word_delta.count("rue") == 0);
+
+    // the typing errors are found with the patterns of the inserted elements
+    ac.insert("gare bateau", 4, ghostwords, synonyms);
+    auto res = ac.find_partial_with_pattern("batau", 5, nbmax, keep_all, ghostwords);
+    BOOST_REQUIRE_EQUAL(res.size(), 1);
+    BOOST_CHECK_EQUAL(res.at(0).idx, 4);
+}
+
 BOOST_AUTO_TEST_CASE(autocompletesynonym_and_weight_test) {
     autocomplete_map synonyms;
     std::set<std::string> ghostwords;
@@ -630,7 +726,7 @@ BOOST_AUTO_TEST_CASE(autocomplete_main_stop_area_test) {
     ad->postal_codes.push_back("29000");
     ad->idx = 0;
     b.data->geo_ref->admins.push_back(ad);
-    ad->main_stop_areas.push_back(b.data->pt_data->stop_areas_map["Luther King"]);
+    ad->main_stop_areas.push_back(b.data->pt_data->stop_areas_map["Luther King"]->idx);
     b.manage_admin();
     b.build_autocomplete();
 
@@ -1150,7 +1246,7 @@ BOOST_AUTO_TEST_CASE(autocomplete_functional_test_SA_temp_test) {
 
     auto set_sa_score = [&](const char* uri, int score) {
         const auto idx = b.data->pt_data->stop_areas_map.at(uri)->idx;
-        b.data->pt_data->stop_area_autocomplete.word_quality_list.at(idx).score = score;
+        b.data->pt_data->stop_area_autocomplete->word_quality_list.at(idx).score = score;
     };
 
     b.data->geo_ref->fl_admin.word_quality_list.at(0).score = 50;
@@ -1308,7 +1404,7 @@ BOOST_AUTO_TEST_CASE(autocomplete_with_multi_postal_codes_test) {
     b.data->geo_ref->admins.push_back(ad);
     b.manage_admin();
     b.build_autocomplete();
-    b.data->pt_data->stop_area_autocomplete.word_quality_list.at(0).score = 100;
+    b.data->pt_data->stop_area_autocomplete->word_quality_list.at(0).score = 100;
 
     type_filter.push_back(navitia::type::Type_e::StopArea);
     type_filter.push_back(navitia::type::Type_e::Admin);
@@ -1343,7 +1439,7 @@ BOOST_AUTO_TEST_CASE(autocomplete_with_multi_postal_codes_alphanumeric_test) {
     b.data->geo_ref->admins.push_back(ad);
     b.manage_admin();
     b.build_autocomplete();
-    b.data->pt_data->stop_area_autocomplete.word_quality_list.at(0).score = 100;
+    b.data->pt_data->stop_area_autocomplete->word_quality_list.at(0).score = 100;
 
     type_filter.push_back(navitia::type::Type_e::StopArea);
     type_filter.push_back(navitia::type::Type_e::Admin);
@@ -1375,7 +1471,7 @@ BOOST_AUTO_TEST_CASE(autocomplete_without_postal_codes_test) {
     b.data->geo_ref->admins.push_back(ad);
     b.manage_admin();
     b.build_autocomplete();
-    b.data->pt_data->stop_area_autocomplete.word_quality_list.at(0).score = 100;
+    b.data->pt_data->stop_area_autocomplete->word_quality_list.at(0).score = 100;
 
     type_filter.push_back(navitia::type::Type_e::StopArea);
     type_filter.push_back(navitia::type::Type_e::Admin);
@@ -2034,7 +2130,7 @@ BOOST_AUTO_TEST_CASE(autocomplete_test_stop_area_longest_substring) {
     auto* data_ptr = b.data.get();
 
     std::string search("Jean Jaurès Toulouse");
-    std::string search_low = data_ptr->pt_data->stop_area_autocomplete.strip_accents_and_lower(search);
+    std::string search_low = data_ptr->pt_data->stop_area_autocomplete->strip_accents_and_lower(search);
 
     // No accents, one less byte
     BOOST_REQUIRE_EQUAL(search.size(), search_low.size() + 1);
@@ -2063,7 +2159,7 @@ BOOST_AUTO_TEST_CASE(autocomplete_test_stop_area_longest_substring) {
 
     // we should have the same result on stop_points
     std::string sp_search("stop_point:Jean Jaurès Toulouse");
-    std::string sp_search_low = data_ptr->pt_data->stop_area_autocomplete.strip_accents_and_lower(sp_search);
+    std::string sp_search_low = data_ptr->pt_data->stop_area_autocomplete->strip_accents_and_lower(sp_search);
 
     std::vector<navitia::type::Type_e> sp_type_filter;
     sp_type_filter.push_back(navitia::type::Type_e::StopPoint);
@@ -2089,3 +2185,40 @@ BOOST_AUTO_TEST_CASE(autocomplete_test_stop_area_longest_substring) {
         BOOST_REQUIRE_EQUAL(resp.places(0).scores(2), (sp_search_low.size() - 1) * -1);
     }
 }
+
+/*
+ * The trie must give the postings of all the words beginning with the prefix, whatever the size of the postings
+ */
+BOOST_AUTO_TEST_CASE(trie_prefix_postings_test) {
+    std::map<std::string, std::set<uint32_t>> words;
+    words["av"] = {4};
+    words["avenue"] = {1, 3, 300000};
+    words["avion"] = {2, 4000000000u};
+    words["bd"] = {5};
+    words["boulevard"] = {5, 6};
+    words["\xc3\xa9glise"] = {7};  // high bit characters must be sorted as unsigned
+
+    navitia::autocomplete::Trie<uint32_t> trie;
+    trie.build(words);
+
+    auto postings = [&](const std::string& prefix) {
+        std::vector<uint32_t> res;
+        trie.for_each_posting(prefix, [&](uint32_t p) { res.push_back(p); });
+        std::sort(res.begin(), res.end());
+        return res;
+    };
+
+    BOOST_CHECK_EQUAL_RANGE(postings("av"), std::vector<uint32_t>({1, 2, 3, 4, 300000, 4000000000u}));
+    BOOST_CHECK_EQUAL_RANGE(postings("ave"), std::vector<uint32_t>({1, 3, 300000}));
+    BOOST_CHECK_EQUAL_RANGE(postings("avion"), std::vector<uint32_t>({2, 4000000000u}));
+    BOOST_CHECK_EQUAL_RANGE(postings("b"), std::vector<uint32_t>({5, 5, 6}));
+    BOOST_CHECK_EQUAL_RANGE(postings("\xc3\xa9"), std::vector<uint32_t>({7}));
+    BOOST_CHECK_EQUAL_RANGE(postings(""), std::vector<uint32_t>({1, 2, 3, 4, 5, 5, 6, 7, 300000, 4000000000u}));
+    BOOST_CHECK(postings("avions").empty());
+    BOOST_CHECK(postings("c").empty());
+    BOOST_CHECK(postings("a\xc3").empty());
+
+    trie.clear();
+    BOOST_CHECK(trie.empty());
+    BOOST_CHECK(postings("av").empty());
+}
@@ -0,0 +1,189 @@
+/* Copyright © 2001-2015, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+#include <boost/serialization/vector.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace navitia {
+namespace autocomplete {
+
+/** Compact dictionary associating words to sorted lists of T (the postings)
+ *
+ * The nodes of the trie are stored in depth first order in flat arrays: the words beginning with a prefix are the
+ * subtree of the node of this prefix, i.e. a contiguous range of nodes, and as the postings are stored in the same
+ * order, their postings are a contiguous range of bytes. Searching a prefix is thus a walk down the trie followed by a
+ * sequential read.
+ *
+ * Each posting list is encoded as its size followed by the differences between consecutive elements, as varints.
+ */
+template <class T>
+struct Trie {
+    /// for each node, the character of the edge from its parent
+    std::vector<char> labels;
+    /// for each node, the end of its subtree, i.e. its next sibling if any
+    std::vector<uint32_t> subtree_ends;
+    /// for each node, the beginning of the postings of its subtree, with the end of the postings at the end
+    std::vector<uint32_t> postings_begins;
+    std::vector<uint8_t> postings;
+
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int) {
+        ar& labels& subtree_ends& postings_begins& postings;
+    }
+
+    void clear() {
+        labels.clear();
+        subtree_ends.clear();
+        postings_begins.clear();
+        postings.clear();
+    }
+
+    bool empty() const { return labels.empty(); }
+    size_t nb_nodes() const { return labels.size(); }
+
+    /// Builds the trie from words sorted in lexicographical order, associated to sorted collections of T
+    template <class SortedMap>
+    void build(const SortedMap& words) {
+        clear();
+        add_node('\0');
+        // the nodes of the previous word, from the root
+        std::vector<uint32_t> path = {0};
+        const std::string* previous = nullptr;
+        for (const auto& word_postings : words) {
+            const std::string& word = word_postings.first;
+            size_t common = 0;
+            if (previous) {
+                while (common < previous->size() && common < word.size() && (*previous)[common] == word[common]) {
+                    ++common;
+                }
+            }
+            // the words are sorted, thus the subtrees below the common prefix are complete
+            while (path.size() > common + 1) {
+                subtree_ends[path.back()] = labels.size();
+                path.pop_back();
+            }
+            for (size_t i = common; i < word.size(); ++i) {
+                path.push_back(add_node(word[i]));
+            }
+            encode(word_postings.second);
+            previous = &word;
+        }
+        for (const auto node : path) {
+            subtree_ends[node] = labels.size();
+        }
+        postings_begins.push_back(postings.size());
+        labels.shrink_to_fit();
+        subtree_ends.shrink_to_fit();
+        postings_begins.shrink_to_fit();
+        postings.shrink_to_fit();
+    }
+
+    /** Calls f on the postings of every word beginning with prefix
+     *
+     * The postings are sorted for each word, but an element can be found for several words
+     */
+    template <class F>
+    void for_each_posting(const std::string& prefix, const F& f) const {
+        if (empty()) {
+            return;
+        }
+        uint32_t node = 0;
+        for (const char c : prefix) {
+            // the children are sorted, the next sibling of a node being the end of its subtree
+            const uint32_t end = subtree_ends[node];
+            uint32_t child = node + 1;
+            while (child < end && uchar(labels[child]) < uchar(c)) {
+                child = subtree_ends[child];
+            }
+            if (child >= end || labels[child] != c) {
+                return;
+            }
+            node = child;
+        }
+        decode(postings_begins[node], postings_begins[subtree_ends[node]], f);
+    }
+
+private:
+    static unsigned char uchar(char c) { return static_cast<unsigned char>(c); }
+
+    uint32_t add_node(char label) {
+        labels.push_back(label);
+        subtree_ends.push_back(0);
+        postings_begins.push_back(postings.size());
+        return labels.size() - 1;
+    }
+
+    void write_varint(uint64_t val) {
+        while (val >= 0x80) {
+            postings.push_back(uint8_t(val) | 0x80);
+            val >>= 7;
+        }
+        postings.push_back(uint8_t(val));
+    }
+
+    uint64_t read_varint(uint32_t& pos) const {
+        uint64_t val = 0;
+        for (int shift = 0;; shift += 7) {
+            const uint8_t byte = postings[pos++];
+            val |= uint64_t(byte & 0x7f) << shift;
+            if (byte < 0x80) {
+                return val;
+            }
+        }
+    }
+
+    template <class SortedCollection>
+    void encode(const SortedCollection& elements) {
+        write_varint(elements.size());
+        uint64_t prev = 0;
+        for (const auto& elt : elements) {
+            write_varint(uint64_t(elt) - prev);
+            prev = uint64_t(elt);
+        }
+    }
+
+    template <class F>
+    void decode(uint32_t pos, uint32_t end, const F& f) const {
+        while (pos < end) {
+            const auto nb = read_varint(pos);
+            uint64_t elt = 0;
+            for (uint64_t i = 0; i < nb; ++i) {
+                elt += read_varint(pos);
+                f(T(elt));
+            }
+        }
+    }
+};
+
+}  // namespace autocomplete
+}  // namespace navitia
@@ -30,6 +30,7 @@ www.navitia.io
 
 #include "line_reports_api.h"
 #include "type/meta_data.h"
+#include "ptreferential/ptreferential_utils.h"
 #include "utils/paginate.h"
 
 #include <boost/optional.hpp>
@@ -106,6 +107,18 @@ struct LineReport {
     }
 };
 
+// the lines related to an object linked to an impact, the only ones that can have a report
+static type::Indexes get_impacted_lines(const type::Data& d) {
+    const auto& impact_index = d.pt_data->impact_index;
+    type::Indexes result = impact_index.get(type::Type_e::Line);
+    for (const auto type : {type::Type_e::Network, type::Type_e::Route, type::Type_e::StopArea,
+                            type::Type_e::StopPoint}) {
+        const auto lines = ptref::get_corresponding(impact_index.get(type), type, type::Type_e::Line, d);
+        result.insert(lines.begin(), lines.end());
+    }
+    return result;
+}
+
 void line_reports(navitia::PbCreator& pb_creator,
                   const navitia::type::Data& d,
                   const size_t depth,
@@ -135,7 +148,7 @@ void line_reports(navitia::PbCreator& pb_creator,
         return;
     }
     std::vector<LineReport> line_reports;
-    for (auto idx : line_indices) {
+    for (auto idx : ptref::get_intersection(line_indices, get_impacted_lines(d))) {
         auto line_report =
             LineReport(d.pt_data->lines[idx], filter, forbidden_uris, d, pb_creator.now, pb_creator.action_period);
         if (line_report.has_disruption(pb_creator.now, pb_creator.action_period)) {
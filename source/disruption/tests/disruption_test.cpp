@@ -437,3 +437,26 @@ BOOST_FIXTURE_TEST_CASE(traffic_report_on_a_tagged_line_section, DisruptedNetwor
     std::set<std::string> res = {"disrup_line_section"};
     BOOST_CHECK_EQUAL_RANGE(res, uris);
 }
+
+BOOST_FIXTURE_TEST_CASE(reports_should_not_return_deleted_disruptions, DisruptedNetwork) {
+    const auto& impact_index = b.data->pt_data->impact_index;
+    const auto* sp3_2 = b.sps.at("sp3_2");
+    BOOST_CHECK_EQUAL(impact_index.get(nt::Type_e::StopPoint).count(sp3_2->idx), 1);
+
+    navitia::delete_disruption("disrup_line_section", *b.data->pt_data, *b.data->meta);
+    BOOST_CHECK_EQUAL(impact_index.get(nt::Type_e::StopPoint).count(sp3_2->idx), 0);
+
+    disruption::traffic_reports(pb_creator, *b.data, 1, 25, 0, "", {});
+    std::set<std::string> uris = get_impacts_uris(pb_creator.impacts);
+    BOOST_CHECK_EQUAL(uris.count("disrup_line_section"), 0);
+    BOOST_CHECK_EQUAL(uris.count("disrup_sp_1"), 1);
+
+    navitia::PbCreator line_reports_pb_creator(b.data.get(), since, time_period(since, until));
+    disruption::line_reports(line_reports_pb_creator, *b.data, 1, 25, 0, "", {}, since, until);
+    uris = get_impacts_uris(line_reports_pb_creator.impacts);
+    BOOST_CHECK_EQUAL(uris.count("disrup_line_section"), 0);
+    BOOST_CHECK_EQUAL(uris.count("disrup_sp_1"), 1);
+    for (const auto& line_report : line_reports_pb_creator.get_response().line_reports()) {
+        BOOST_CHECK_NE(line_report.line().uri(), "line_3");
+    }
+}
@@ -31,6 +31,7 @@ www.navitia.io
 #include "traffic_reports_api.h"
 #include "type/pb_converter.h"
 #include "ptreferential/ptreferential.h"
+#include "ptreferential/ptreferential_utils.h"
 #include "utils/logger.h"
 #include "utils/paginate.h"
 
@@ -102,6 +103,20 @@ static int min_priority(const DisruptionSet& disruptions) {
     return min;
 }
 
+// group the objects by the networks they belong to
+static std::map<type::idx_t, type::Indexes> group_by_network(const type::Indexes& indexes,
+                                                             const type::Type_e type,
+                                                             const type::Data& d) {
+    std::map<type::idx_t, type::Indexes> result;
+    for (const auto idx : indexes) {
+        const auto networks = ptref::get_corresponding(type::make_indexes({idx}), type, type::Type_e::Network, d);
+        for (const auto network_idx : networks) {
+            result[network_idx].insert(idx);
+        }
+    }
+    return result;
+}
+
 NetworkDisrupt& TrafficReport::find_or_create(const type::Network* network) {
     auto find_predicate = [&](const NetworkDisrupt& network_disrupt) { return network == network_disrupt.network; };
     auto it = boost::find_if(this->disrupts, find_predicate);
@@ -120,22 +135,42 @@ void TrafficReport::add_stop_areas(const type::Indexes& network_idx,
                                    const std::vector<std::string>& forbidden_uris,
                                    const type::Data& d,
                                    const boost::posix_time::ptime now) {
-    for (auto idx : network_idx) {
-        const auto* network = d.pt_data->networks[idx];
-        std::string new_filter = "network.uri=" + network->uri;
-        if (!filter.empty()) {
-            new_filter += " and " + filter;
+    // without filter, only the stop points linked to an impact, directly or by their stop area,
+    // can have messages, there is no need to walk all the stop points of the networks
+    const bool use_impact_index = filter.empty() && forbidden_uris.empty();
+    std::map<type::idx_t, type::Indexes> impacted_stop_points;
+    if (use_impact_index) {
+        auto stop_points = d.pt_data->impact_index.get(type::Type_e::StopPoint);
+        for (const auto sa_idx : d.pt_data->impact_index.get(type::Type_e::StopArea)) {
+            for (const auto* sp : d.pt_data->stop_areas[sa_idx]->stop_point_list) {
+                stop_points.insert(sp->idx);
+            }
         }
+        impacted_stop_points = group_by_network(stop_points, type::Type_e::StopPoint, d);
+    }
 
+    for (auto idx : network_idx) {
+        const auto* network = d.pt_data->networks[idx];
         type::Indexes stop_points;
-        try {
-            stop_points = ptref::make_query(type::Type_e::StopPoint, new_filter, forbidden_uris, d);
-        } catch (const ptref::parsing_error& parse_error) {
-            LOG4CPLUS_WARN(logger, "Disruption::add_stop_points : Unable to parse filter " + parse_error.more);
-        } catch (const ptref::ptref_error& /*ptref_error*/) {
-            // that can arrive quite often if there is a filter, and
-            // it's quite normal. Imagine /line/metro1/traffic_reports
-            // for the network SNCF.
+        if (use_impact_index) {
+            const auto it = impacted_stop_points.find(idx);
+            if (it != impacted_stop_points.end()) {
+                stop_points = it->second;
+            }
+        } else {
+            std::string new_filter = "network.uri=" + network->uri;
+            if (!filter.empty()) {
+                new_filter += " and " + filter;
+            }
+            try {
+                stop_points = ptref::make_query(type::Type_e::StopPoint, new_filter, forbidden_uris, d);
+            } catch (const ptref::parsing_error& parse_error) {
+                LOG4CPLUS_WARN(logger, "Disruption::add_stop_points : Unable to parse filter " + parse_error.more);
+            } catch (const ptref::ptref_error& /*ptref_error*/) {
+                // that can arrive quite often if there is a filter, and
+                // it's quite normal. Imagine /line/metro1/traffic_reports
+                // for the network SNCF.
+            }
         }
 
         // build a map of messages per stop_area (iterate only on stop_points of the network)
@@ -198,18 +233,35 @@ void TrafficReport::add_vehicle_journeys(const type::Indexes& network_idx,
                                          const std::vector<std::string>& forbidden_uris,
                                          const type::Data& d,
                                          const boost::posix_time::ptime now) {
+    // without filter, the disrupted vehicle journeys are found from the impacts, not from the networks
+    const bool use_impacts = filter.empty() && forbidden_uris.empty();
+    std::map<type::idx_t, type::Indexes> disrupted_vehicle_journeys;
+    if (use_impacts) {
+        disrupted_vehicle_journeys =
+            group_by_network(ptref::get_indexes_by_impacts(type::Type_e::VehicleJourney, d),
+                             type::Type_e::VehicleJourney, d);
+    }
+
     for (const auto idx : network_idx) {
         const auto* network = d.pt_data->networks[idx];
-        std::string new_filter = "network.uri=" + network->uri + " and vehicle_journey.has_disruption()";
-        if (!filter.empty()) {
-            new_filter += " and " + filter;
-        }
         type::Indexes vehicle_journeys;
-        try {
-            vehicle_journeys = ptref::make_query(type::Type_e::VehicleJourney, new_filter, forbidden_uris, d);
-        } catch (const ptref::parsing_error& parse_error) {
-            LOG4CPLUS_WARN(logger, "Disruption::add_vehicle_journeys : Unable to parse filter " << parse_error.more);
-        } catch (const ptref::ptref_error&) {
+        if (use_impacts) {
+            const auto it = disrupted_vehicle_journeys.find(idx);
+            if (it != disrupted_vehicle_journeys.end()) {
+                vehicle_journeys = it->second;
+            }
+        } else {
+            std::string new_filter = "network.uri=" + network->uri + " and vehicle_journey.has_disruption()";
+            if (!filter.empty()) {
+                new_filter += " and " + filter;
+            }
+            try {
+                vehicle_journeys = ptref::make_query(type::Type_e::VehicleJourney, new_filter, forbidden_uris, d);
+            } catch (const ptref::parsing_error& parse_error) {
+                LOG4CPLUS_WARN(logger,
+                               "Disruption::add_vehicle_journeys : Unable to parse filter " << parse_error.more);
+            } catch (const ptref::ptref_error&) {
+            }
         }
         for (const auto vj_idx : vehicle_journeys) {
             const auto* vj = d.pt_data->vehicle_journeys[vj_idx];
@@ -257,12 +309,22 @@ void TrafficReport::add_lines(const std::string& filter,
                               const type::Data& d,
                               const boost::posix_time::ptime now) {
     type::Indexes line_list;
-    try {
-        line_list = ptref::make_query(type::Type_e::Line, filter, forbidden_uris, d);
-    } catch (const ptref::parsing_error& parse_error) {
-        LOG4CPLUS_WARN(logger, "Disruption::add_lines : Unable to parse filter " + parse_error.more);
-    } catch (const ptref::ptref_error& ptref_error) {
-        LOG4CPLUS_WARN(logger, "Disruption::add_lines : ptref : " + ptref_error.more);
+    if (filter.empty() && forbidden_uris.empty()) {
+        // without filter, only the lines linked to an impact, directly or by a route, can have messages
+        line_list = d.pt_data->impact_index.get(type::Type_e::Line);
+        for (const auto route_idx : d.pt_data->impact_index.get(type::Type_e::Route)) {
+            if (const auto* line = d.pt_data->routes[route_idx]->line) {
+                line_list.insert(line->idx);
+            }
+        }
+    } else {
+        try {
+            line_list = ptref::make_query(type::Type_e::Line, filter, forbidden_uris, d);
+        } catch (const ptref::parsing_error& parse_error) {
+            LOG4CPLUS_WARN(logger, "Disruption::add_lines : Unable to parse filter " + parse_error.more);
+        } catch (const ptref::ptref_error& ptref_error) {
+            LOG4CPLUS_WARN(logger, "Disruption::add_lines : ptref : " + ptref_error.more);
+        }
     }
     for (auto idx : line_list) {
         const auto* line = d.pt_data->lines[idx];
@@ -454,6 +454,8 @@ Impacter& Impacter::severity(const std::string& uri) {
 Impacter& Impacter::on(nt::Type_e type, const std::string& uri) {
     dis::Impact::link_informed_entity(dis::make_pt_obj(type, uri, *b.data->pt_data), impact,
                                       b.data->meta->production_date, get_disruption().rt_level);
+    b.data->pt_data->pb_fragment_cache.clear();
+    b.data->pt_data->impact_index.add(impact);
     return *this;
 }
 
@@ -477,6 +479,8 @@ Impacter& Impacter::on_line_section(const std::string& line_uri,
 
     dis::Impact::link_informed_entity(std::move(line_section), impact, b.data->meta->production_date,
                                       get_disruption().rt_level);
+    b.data->pt_data->pb_fragment_cache.clear();
+    b.data->pt_data->impact_index.add(impact);
     return *this;
 }
 
@@ -166,8 +166,9 @@ struct FindAdminWithCities {
 };
 
 int ed2nav(int argc, const char* argv[]) {
-    std::string output, connection_string, region_name, cities_connection_string;
+    std::string output, raw_output, connection_string, region_name, cities_connection_string;
     double min_non_connected_graph_ratio;
+    size_t next_st_snapshot_days;
     po::options_description desc("Allowed options");
 
     // clang-format off
@@ -177,6 +178,8 @@ int ed2nav(int argc, const char* argv[]) {
         ("config-file", po::value<std::string>(), "Path to config file")
         ("output,o", po::value<std::string>(&output)->default_value("data.nav.lz4"),
             "Output file")
+        ("raw_output", po::value<std::string>(&raw_output)->default_value(""),
+            "Optional uncompressed output file, bigger but faster to load by kraken")
         ("name,n", po::value<std::string>(&region_name)->default_value("default"),
             "Name of the region you are extracting")
         ("min_non_connected_ratio,m",
@@ -189,6 +192,11 @@ int ed2nav(int argc, const char* argv[]) {
          "database connection parameters: host=localhost user=navitia dbname=navitia password=navitia")
         ("cities-connection-string", po::value<std::string>(&cities_connection_string)->default_value(""),
          "cities database connection parameters: host=localhost user=navitia dbname=cities password=navitia")
+        ("next_st_snapshot_days", po::value<size_t>(&next_st_snapshot_days)->default_value(0),
+         "number of days, from today, of base schedule next stop time caches to pre-build next to the output file, "
+         "so that kraken doesn't have to build them on the first requests")
+        ("contraction_hierarchies", "build the contraction hierarchies of the car and bike direct paths, "
+         "long to build but the direct paths are much faster")
         ("local_syslog", "activate log redirection within local syslog")
         ("log_comment", po::value<std::string>(), "optional field to add extra information like coverage name");
     // clang-format on
@@ -253,6 +261,13 @@ int ed2nav(int argc, const char* argv[]) {
 
     read = (pt::microsec_clock::local_time() - start).total_milliseconds();
     data.complete();
+    // close intersections get close indexes, for the cache locality of the street network dijkstras
+    data.geo_ref->reorder_vertices();
+    // the street network is complete, its edges are packed before building the contraction hierarchies
+    data.geo_ref->graph.compress();
+    if (vm.count("contraction_hierarchies")) {
+        data.geo_ref->build_contraction_hierarchies();
+    }
     data.meta->publication_date = pt::microsec_clock::local_time();
 
     LOG4CPLUS_INFO(logger, "line: " << data.pt_data->lines.size());
@@ -267,7 +282,7 @@ int ed2nav(int argc, const char* argv[]) {
     LOG4CPLUS_INFO(logger, "validity pattern : " << data.pt_data->validity_patterns.size());
     LOG4CPLUS_INFO(logger, "calendars: " << data.pt_data->calendars.size());
     LOG4CPLUS_INFO(logger, "synonyms : " << data.geo_ref->synonyms.size());
-    LOG4CPLUS_INFO(logger, "fare tickets: " << data.fare->fare_map.size());
+    LOG4CPLUS_INFO(logger, "fare tickets: " << data.fare->nb_tickets());
     LOG4CPLUS_INFO(logger, "fare transitions: " << data.fare->nb_transitions());
     LOG4CPLUS_INFO(logger, "fare od: " << data.fare->od_tickets.size());
     LOG4CPLUS_INFO(logger, "Begin to save ...");
@@ -275,6 +290,9 @@ int ed2nav(int argc, const char* argv[]) {
     start = pt::microsec_clock::local_time();
     try {
         data.save(output);
+        if (!raw_output.empty()) {
+            data.save(raw_output, navitia::type::NavFormat::Raw);
+        }
     } catch (const navitia::exception& e) {
         LOG4CPLUS_ERROR(logger, "Unable to save");
         LOG4CPLUS_ERROR(logger, e.what());
@@ -283,6 +301,17 @@ int ed2nav(int argc, const char* argv[]) {
     save = (pt::microsec_clock::local_time() - start).total_milliseconds();
     LOG4CPLUS_INFO(logger, "Data saved");
 
+    if (next_st_snapshot_days > 0) {
+        try {
+            data.build_raptor();
+            data.save_next_st_snapshots(output, next_st_snapshot_days);
+        } catch (const navitia::exception& e) {
+            LOG4CPLUS_ERROR(logger, "Unable to save the next stop time snapshots");
+            LOG4CPLUS_ERROR(logger, e.what());
+            return 1;
+        }
+    }
+
     LOG4CPLUS_INFO(logger, "Computing times");
     LOG4CPLUS_INFO(logger, "\t File reading: " << read << "ms");
     LOG4CPLUS_INFO(logger, "\t Data writing: " << save << "ms");
@@ -32,6 +32,7 @@ www.navitia.io
 #include "ed/connectors/fare_utils.h"
 #include "type/meta_data.h"
 #include <boost/foreach.hpp>
+#include <boost/graph/adjacency_list.hpp>
 #include <boost/geometry.hpp>
 #include <boost/smart_ptr/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
@@ -209,7 +210,7 @@ void EdReader::fill_admin_stop_areas(navitia::type::Data&, pqxx::work& work) {
 
         navitia::type::StopArea* sa = it_sa->second;
 
-        admin->main_stop_areas.push_back(sa);
+        admin->main_stop_areas.push_back(sa->idx);
         nb_valid_admin++;
     }
     LOG4CPLUS_INFO(log, nb_valid_admin << " admin with at least one main stop");
@@ -1690,9 +1691,7 @@ void EdReader::fill_prices(navitia::type::Data& data, pqxx::work& work) {
         bg::date start = bg::from_string(const_it["valid_from"].as<std::string>());
         bg::date end = bg::from_string(const_it["valid_to"].as<std::string>());
 
-        nf::DateTicket& date_ticket = data.fare->fare_map[ticket.key];
-
-        date_ticket.add(start, end, ticket);
+        data.fare->add_ticket(ticket.key, start, end, ticket);
     }
 }
 
@@ -1729,19 +1728,19 @@ void EdReader::fill_transitions(navitia::type::Data& data, pqxx::work& work) {
 
         nf::Fare::vertex_t start_v, end_v;
         if (state_map.find(start) == state_map.end()) {
-            start_v = boost::add_vertex(start, data.fare->g);
+            start_v = data.fare->add_state(start);
             state_map[start] = start_v;
         } else
             start_v = state_map[start];
 
         if (state_map.find(end) == state_map.end()) {
-            end_v = boost::add_vertex(end, data.fare->g);
+            end_v = data.fare->add_state(end);
             state_map[end] = end_v;
         } else
             end_v = state_map[end];
 
         // add the edge to the fare graph
-        boost::add_edge(start_v, end_v, transition, data.fare->g);
+        data.fare->add_transition(start_v, end_v, transition);
     }
 }
 
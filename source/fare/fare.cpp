@@ -35,6 +35,9 @@ www.navitia.io
 #include <boost/lexical_cast.hpp>
 #include <boost/optional.hpp>
 
+#include <algorithm>
+#include <deque>
+
 #include "type/datetime.h"
 
 namespace greg = boost::gregorian;
@@ -42,23 +45,103 @@ namespace greg = boost::gregorian;
 namespace navitia {
 namespace fare {
 
-static Label next_label(Label label, Ticket ticket, const SectionKey& section) {
+namespace {
+
+/**
+ * The buffers of a fare computation, reused by all the computations of a thread (i.e. of a worker)
+ *
+ * The labels share the tickets they buy: a bought ticket knows the previous ticket of its label, so a label is copied
+ * without its tickets, and adding a section to the last ticket of a label only copies the sections of this ticket.
+ */
+struct Scratch {
+    struct BoughtTicket {
+        const Ticket* ticket;             //< in the automaton, or in od_tickets
+        Ticket::ticket_type type;         //< the type it has been bought with
+        uint32_t previous;                //< previous ticket of the label, invalid_ticket_idx for the first one
+        std::vector<uint32_t> sections;  //< index of the sections paid with the ticket, in Scratch::sections
+    };
+
+    std::vector<SectionKey> sections;
+    std::vector<BoughtTicket> bought;
+    /// the OD tickets, summed for the computation
+    std::deque<Ticket> od_tickets;
+    /// the labels by state, before and after the current section
+    std::vector<std::vector<Label>> labels;
+    std::vector<std::vector<Label>> new_labels;
+    /// the states matching the current section
+    std::vector<char> reachable;
+    /// the labels matching the state they are in
+    std::vector<char> label_valid;
+
+    void clear(const size_t nb_states) {
+        sections.clear();
+        bought.clear();
+        od_tickets.clear();
+        for (auto* labels_by_state : {&labels, &new_labels}) {
+            labels_by_state->resize(nb_states);
+            for (auto& state_labels : *labels_by_state) {
+                state_labels.clear();
+            }
+        }
+        reachable.assign(nb_states, false);
+    }
+
+    const Ticket* last_ticket(const Label& label) const {
+        return label.last_ticket == invalid_ticket_idx ? nullptr : bought[label.last_ticket].ticket;
+    }
+
+    uint32_t buy(const Ticket& ticket,
+                 const Ticket::ticket_type type,
+                 const uint32_t previous,
+                 std::vector<uint32_t> ticket_sections) {
+        bought.push_back({&ticket, type, previous, std::move(ticket_sections)});
+        return bought.size() - 1;
+    }
+
+    uint32_t add_section(const uint32_t ticket_idx, const uint32_t section_idx) {
+        BoughtTicket ticket = bought[ticket_idx];
+        ticket.sections.push_back(section_idx);
+        bought.push_back(std::move(ticket));
+        return bought.size() - 1;
+    }
+
+    std::vector<Ticket> get_tickets(const Label& label) const {
+        std::vector<Ticket> tickets;
+        for (auto idx = label.last_ticket; idx != invalid_ticket_idx; idx = bought[idx].previous) {
+            tickets.push_back(*bought[idx].ticket);
+            tickets.back().type = bought[idx].type;
+            for (const auto section_idx : bought[idx].sections) {
+                tickets.back().sections.push_back(sections[section_idx]);
+            }
+        }
+        std::reverse(tickets.begin(), tickets.end());
+        return tickets;
+    }
+};
+
+}  // namespace
+
+static Label next_label(Label label,
+                        const Ticket& ticket,
+                        const Ticket::ticket_type type,
+                        const uint32_t section_idx,
+                        Scratch& scratch) {
+    const SectionKey& section = scratch.sections[section_idx];
     // we save the informations about the last mod used
     label.line = section.line;
     label.mode = section.mode;
     label.network = section.network;
 
-    if (ticket.type == Ticket::ODFare) {
+    if (type == Ticket::ODFare) {
         if (label.stop_area == "" || label.current_type != Ticket::ODFare) {  // It's a new OD ticket
             label.stop_area = section.start_stop_area;
             label.zone = section.start_zone;
             label.nb_changes = 0;
             label.start_time = section.start_time;
 
-            ticket.sections.push_back(section);
-            label.tickets.push_back(ticket);
+            label.last_ticket = scratch.buy(ticket, type, label.last_ticket, {section_idx});
         } else {  // We got an old ticket
-            label.tickets.back().sections.push_back(section);
+            label.last_ticket = scratch.add_section(label.last_ticket, section_idx);
             label.nb_changes++;
         }
 
@@ -67,6 +150,10 @@ static Label next_label(Label label, Ticket ticket, const SectionKey& section) {
         // we have to update the number of changes and the duration with the same ticket
         if (ticket.caption == "" && ticket.value == 0) {
             label.nb_changes++;
+            if (label.last_ticket == invalid_ticket_idx) {
+                throw navitia::recoverable_exception("internal problem");
+            }
+            label.last_ticket = scratch.add_section(label.last_ticket, section_idx);
         } else {
             // we bought a new ticket
             // we save the global cost, and we reset the number of changes and duration
@@ -74,17 +161,13 @@ static Label next_label(Label label, Ticket ticket, const SectionKey& section) {
                 label.nb_undefined_sub_cost++;  // we need to track the number of undefined ticket for the comparison
                                                 // operator
             label.cost += ticket.value;
-            label.tickets.push_back(ticket);
+            label.last_ticket = scratch.buy(ticket, type, label.last_ticket, {section_idx});
             label.nb_changes = 0;
             label.start_time = section.start_time;
             label.stop_area = section.start_stop_area;
         }
-        if (label.tickets.size() == 0) {
-            throw navitia::recoverable_exception("internal problem");
-        }
-        label.tickets.back().sections.push_back(section);
     }
-    label.current_type = ticket.type;
+    label.current_type = type;
     return label;
 }
 
@@ -96,11 +179,11 @@ static bool valid(const State& state, const SectionKey& section) {
     return true;
 }
 
-static bool valid(const State& state, const Label& label) {
+static bool valid(const State& state, const Label& label, const Ticket* last_ticket) {
     if ((state.mode != "" && !boost::iequals(state.mode, label.mode))
         || (state.network != "" && !boost::iequals(state.network, label.network))
         || (state.line != "" && !boost::iequals(state.line, label.line))
-        || (state.ticket != "" && !boost::iequals(state.ticket, label.tickets.back().caption)))
+        || (state.ticket != "" && (!last_ticket || !boost::iequals(state.ticket, last_ticket->caption))))
         return false;
     return true;
 }
@@ -126,115 +209,176 @@ std::string comp_to_string(const Comp_e comp) {
     }
 }
 
+Fare::Automaton::Automaton(const Graph& g, const std::map<std::string, DateTicket>& fare_map) {
+    std::map<std::string, uint32_t> ticket_ids;
+    const auto get_ticket_id = [&](const std::string& key) {
+        if (key.empty()) {
+            return free_transition;
+        }
+        auto it = ticket_ids.find(key);
+        if (it == ticket_ids.end()) {
+            const auto fare = fare_map.find(key);
+            tickets.push_back(fare == fare_map.end() ? DateTicket() : fare->second);
+            it = ticket_ids.insert({key, tickets.size() - 1}).first;
+        }
+        return it->second;
+    };
+
+    const size_t nb_states = boost::num_vertices(g);
+    states.reserve(nb_states);
+    arc_begins.reserve(nb_states + 1);
+    arc_begins.push_back(0);
+    for (vertex_t u = 0; u < nb_states; ++u) {
+        states.push_back(g[u]);
+        BOOST_FOREACH (edge_t e, boost::out_edges(u, g)) {
+            arcs.push_back({uint32_t(boost::target(e, g)), get_ticket_id(g[e].ticket_key), g[e]});
+        }
+        arc_begins.push_back(arcs.size());
+    }
+}
+
 results Fare::compute_fare(const routing::Path& path) const {
     results res;
-    int nb_nodes = boost::num_vertices(g);
 
-    if (nb_nodes < 2) {
+    if (boost::num_vertices(g) < 2) {
         LOG4CPLUS_TRACE(logger, "no fare data loaded, cannot compute fare");
         return res;
     }
-    std::vector<std::vector<Label>> labels(nb_nodes);
+    // the fare is compiled at load, but not when it is built or modified by hand
+    Automaton not_compiled;
+    if (!compiled) {
+        not_compiled = Automaton(g, fare_map);
+    }
+    const Automaton& fa = compiled ? automaton : not_compiled;
+    const size_t nb_states = fa.states.size();
+    // the ticket of the transitions without ticket key, it is just a change
+    static const Ticket no_ticket_to_buy;
+
+    static thread_local Scratch scratch;
+    scratch.clear(nb_states);
+    size_t section_idx(0);
+    for (const auto& item : path.items) {
+        if (item.type == routing::ItemType::public_transport) {
+            scratch.sections.emplace_back(item, section_idx);
+        }
+        section_idx++;
+    }
+
+    auto& labels = scratch.labels;
+    auto& new_labels = scratch.new_labels;
     // Start label
     labels[0].push_back(Label());
-    size_t section_idx(0);
 
-    for (auto item : path.items) {
-        if (item.type != routing::ItemType::public_transport) {
-            section_idx++;
-            continue;
+    for (uint32_t s = 0; s < scratch.sections.size(); ++s) {
+        const SectionKey& section_key = scratch.sections[s];
+        for (auto& state_labels : new_labels) {
+            state_labels.clear();
+        }
+        for (size_t v = 0; v < nb_states; ++v) {
+            scratch.reachable[v] = valid(fa.states[v], section_key);
         }
 
-        SectionKey section_key(item, section_idx++);
+        // exclusive segment, we have to use its ticket
+        const Ticket* exclusive_ticket = nullptr;
+        for (size_t u = 0; u < nb_states && !exclusive_ticket; ++u) {
+            const std::vector<Label>& u_labels = labels[u];
+            if (u_labels.empty()) {
+                continue;
+            }
+            scratch.label_valid.resize(u_labels.size());
+            for (size_t i = 0; i < u_labels.size(); ++i) {
+                scratch.label_valid[i] = valid(fa.states[u], u_labels[i], scratch.last_ticket(u_labels[i]));
+            }
 
-        std::vector<std::vector<Label>> new_labels(nb_nodes);
-        try {
-            BOOST_FOREACH (edge_t e, boost::edges(g)) {
-                vertex_t u = boost::source(e, g);
-                vertex_t v = boost::target(e, g);
-                if (!valid(g[v], section_key))
+            for (auto a = fa.arc_begins[u]; a < fa.arc_begins[u + 1] && !exclusive_ticket; ++a) {
+                const Automaton::Arc& arc = fa.arcs[a];
+                if (!scratch.reachable[arc.target]) {
                     continue;
-
-                for (const Label& label : labels[u]) {
-                    Ticket ticket;
-                    const Transition& transition = g[e];
-                    if (valid(g[u], label) && transition.valid(section_key, label)) {
-                        if (transition.ticket_key != "") {
-                            bool ticket_found = false;  // TODO refactor this, optional is way better
-                            auto it = fare_map.find(transition.ticket_key);
-                            try {
-                                if (it != fare_map.end()) {
-                                    ticket = it->second.get_fare(section_key.date);
-                                    ticket_found = true;
-                                }
-                            } catch (no_ticket) {  // the ticket_found bool is still false
-                            }
-                            if (!ticket_found) {
-                                ticket = make_default_ticket();
-                            }
-                        }
-                        if (transition.global_condition == Transition::GlobalCondition::exclusive)
-                            throw ticket;
-                        else if (transition.global_condition == Transition::GlobalCondition::with_changes) {
-                            ticket.type = Ticket::ODFare;
+                }
+                const Transition& transition = arc.transition;
+                for (size_t i = 0; i < u_labels.size(); ++i) {
+                    const Label& label = u_labels[i];
+                    if (!scratch.label_valid[i] || !transition.valid(section_key, label, scratch.last_ticket(label))) {
+                        continue;
+                    }
+                    const Ticket* ticket = &no_ticket_to_buy;
+                    if (arc.ticket_id != Automaton::free_transition) {
+                        ticket = fa.tickets[arc.ticket_id].get_fare(section_key.date);
+                        if (!ticket) {
+                            ticket = &fa.default_ticket;
                         }
-                        Label next = next_label(label, ticket, section_key);
-
-                        // we process the OD ticket: case where we'll not use this ticket anymore
-                        if (label.current_type == Ticket::ODFare || ticket.type == Ticket::ODFare) {
-                            try {
-                                Ticket ticket_od;
-                                ticket_od = get_od(next, section_key).get_fare(section_key.date);
-                                if (label.tickets.size() > 0 && label.current_type == Ticket::ODFare)
-                                    ticket_od.sections = label.tickets.back().sections;
-
-                                ticket_od.sections.push_back(section_key);
-                                Label n = next;
-                                n.cost += ticket_od.value;
-                                n.tickets.back() = ticket_od;
-                                n.current_type = Ticket::FlatFare;
-
-                                new_labels[0].push_back(n);
-                            } catch (no_ticket) {
-                                LOG4CPLUS_TRACE(logger, "Unable to get the OD ticket SA="
-                                                            << next.stop_area << ", zone=" << next.zone
-                                                            << ", section start_zone=" << section_key.start_zone
-                                                            << ", dest_zone=" << section_key.dest_zone
-                                                            << ", start_sa=" << section_key.start_stop_area
-                                                            << ", dest_sa=" << section_key.dest_stop_area
-                                                            << ", mode=" << section_key.mode);
+                    }
+                    if (transition.global_condition == Transition::GlobalCondition::exclusive) {
+                        exclusive_ticket = ticket;
+                        break;
+                    }
+                    const auto type = transition.global_condition == Transition::GlobalCondition::with_changes
+                                          ? Ticket::ODFare
+                                          : ticket->type;
+                    Label next = next_label(label, *ticket, type, s, scratch);
+
+                    // we process the OD ticket: case where we'll not use this ticket anymore
+                    if (label.current_type == Ticket::ODFare || type == Ticket::ODFare) {
+                        const auto od = get_od(next, section_key);
+                        const Ticket* ticket_od = od ? od->get_fare(section_key.date) : nullptr;
+                        if (ticket_od) {
+                            std::vector<uint32_t> od_sections;
+                            if (label.last_ticket != invalid_ticket_idx && label.current_type == Ticket::ODFare) {
+                                od_sections = scratch.bought[label.last_ticket].sections;
                             }
+                            od_sections.push_back(s);
+                            scratch.od_tickets.push_back(*ticket_od);
+
+                            // the OD ticket replaces the last ticket
+                            Label n = next;
+                            n.cost += ticket_od->value;
+                            const auto previous = scratch.bought[next.last_ticket].previous;
+                            n.last_ticket = scratch.buy(scratch.od_tickets.back(), ticket_od->type, previous,
+                                                        std::move(od_sections));
+                            n.current_type = Ticket::FlatFare;
+
+                            new_labels[0].push_back(std::move(n));
                         } else {
-                            new_labels[0].push_back(next);
+                            LOG4CPLUS_TRACE(logger, "Unable to get the OD ticket SA="
+                                                        << next.stop_area << ", zone=" << next.zone
+                                                        << ", section start_zone=" << section_key.start_zone
+                                                        << ", dest_zone=" << section_key.dest_zone
+                                                        << ", start_sa=" << section_key.start_stop_area
+                                                        << ", dest_sa=" << section_key.dest_stop_area
+                                                        << ", mode=" << section_key.mode);
                         }
-                        new_labels[v].push_back(next);
+                    } else {
+                        new_labels[0].push_back(next);
                     }
+                    new_labels[arc.target].push_back(std::move(next));
                 }
             }
         }
-        // exclusive segment, we have to use that ticket
-        catch (const Ticket& ticket) {
+        if (exclusive_ticket) {
             LOG4CPLUS_TRACE(logger, "\texclusive section for fare");
-            new_labels.clear();
-            new_labels.resize(nb_nodes);
-            for (Label label : labels.at(0)) {
-                new_labels.at(0).push_back(next_label(label, ticket, section_key));
+            for (auto& state_labels : new_labels) {
+                state_labels.clear();
+            }
+            for (const Label& label : labels[0]) {
+                new_labels[0].push_back(next_label(label, *exclusive_ticket, exclusive_ticket->type, s, scratch));
             }
         }
-        labels = std::move(new_labels);
+        std::swap(labels, new_labels);
     }
 
     // We look for the cheapest label
     // if 2 label have the same cost, we take the one with the least number of tickets
-    boost::optional<Label> best_label;
-    for (const Label& label : labels.at(0)) {
-        if (!best_label || label < (*best_label)) {
-            res.tickets = label.tickets;
-            res.not_found = (label.nb_undefined_sub_cost != 0);
-            res.total = label.cost;
-            best_label = label;
+    const Label* best_label = nullptr;
+    for (const Label& label : labels[0]) {
+        if (!best_label || label < *best_label) {
+            best_label = &label;
         }
     }
+    if (best_label) {
+        res.tickets = scratch.get_tickets(*best_label);
+        res.not_found = (best_label->nb_undefined_sub_cost != 0);
+        res.total = best_label->cost;
+    }
 
     return res;
 }
@@ -301,13 +445,12 @@ int SectionKey::duration_at_end(int ticket_start_time) const {
         return (dest_time + 24 * 3600) - ticket_start_time;
 }
 
-Ticket DateTicket::get_fare(boost::gregorian::date date) const {
+const Ticket* DateTicket::get_fare(boost::gregorian::date date) const {
     for (const auto& dticket : tickets) {
         if (dticket.validity_period.contains(date))
-            return dticket.ticket;
+            return &dticket.ticket;
     }
-
-    throw no_ticket();
+    return nullptr;
 }
 
 DateTicket DateTicket::operator+(const DateTicket& other) const {
@@ -325,8 +468,8 @@ DateTicket DateTicket::operator+(const DateTicket& other) const {
     return new_ticket;
 }
 
-bool Transition::valid(const SectionKey& section, const Label& label) const {
-    if (label.tickets.size() == 0 && ticket_key == ""
+bool Transition::valid(const SectionKey& section, const Label& label, const Ticket* last_ticket) const {
+    if (!last_ticket && ticket_key == ""
         && global_condition != Transition::GlobalCondition::with_changes) {
         // the transition is a continuation and we don't have any
         // ticket, thus this transition is not valid
@@ -354,9 +497,9 @@ bool Transition::valid(const SectionKey& section, const Label& label) const {
             if (!compare(label.nb_changes, nb_changes, cond.comparaison)) {
                 return false;
             }
-        } else if (cond.key == "ticket" && label.tickets.size() > 0) {
-            LOG4CPLUS_INFO(log4cplus::Logger::getInstance("fare"), label.tickets.back().key << " " << cond.value);
-            if (!compare(label.tickets.back().key, cond.value, cond.comparaison)) {
+        } else if (cond.key == "ticket" && last_ticket) {
+            LOG4CPLUS_INFO(log4cplus::Logger::getInstance("fare"), last_ticket->key << " " << cond.value);
+            if (!compare(last_ticket->key, cond.value, cond.comparaison)) {
                 return false;
             }
         }
@@ -394,7 +537,7 @@ static boost::optional<OD_map::const_iterator> get_od_dest(const OD_map& od_map,
     return od_t;
 }
 
-DateTicket Fare::get_od(const Label& label, const SectionKey& section) const {
+boost::optional<DateTicket> Fare::get_od(const Label& label, const SectionKey& section) const {
     OD_key o_sa(OD_key::StopArea, label.stop_area);
     OD_key o_mode(OD_key::Mode, label.mode);
     OD_key o_zone(OD_key::Zone, label.zone);
@@ -425,7 +568,7 @@ DateTicket Fare::get_od(const Label& label, const SectionKey& section) const {
         }
     }
     if (!od) {
-        throw no_ticket();
+        return boost::none;
     }
 
     // We create a new ticket, sum of all atomic elements
@@ -448,6 +591,24 @@ DateTicket Fare::get_od(const Label& label, const SectionKey& section) const {
     return ticket;
 }
 
+Fare::vertex_t Fare::add_state(const State& state) {
+    compiled = false;
+    return boost::add_vertex(state, g);
+}
+
+void Fare::add_transition(vertex_t start, vertex_t end, const Transition& transition) {
+    compiled = false;
+    boost::add_edge(start, end, transition, g);
+}
+
+void Fare::add_ticket(const std::string& key,
+                      boost::gregorian::date begin_date,
+                      boost::gregorian::date end_date,
+                      const Ticket& ticket) {
+    compiled = false;
+    fare_map[key].add(begin_date, end_date, ticket);
+}
+
 size_t Fare::nb_transitions() const {
     return boost::num_edges(g);
 }
@@ -39,6 +39,8 @@ www.navitia.io
 #include <boost/date_time/gregorian/greg_serialize.hpp>
 #include "utils/serialization_vector.h"
 #include <boost/serialization/utility.hpp>
+#include <boost/optional.hpp>
+#include <limits>
 
 namespace navitia {
 namespace fare {
@@ -144,8 +146,8 @@ struct PeriodTicket {
 struct DateTicket {
     std::vector<PeriodTicket> tickets;
 
-    /// Returns fare for a given date
-    Ticket get_fare(boost::gregorian::date date) const;
+    /// Returns fare for a given date, nullptr if there is none
+    const Ticket* get_fare(boost::gregorian::date date) const;
 
     /// Add a new period to a ticket
     void add(boost::gregorian::date begin_date, boost::gregorian::date end_date, const Ticket& ticket);
@@ -160,8 +162,6 @@ struct DateTicket {
     }
 };
 
-struct no_ticket {};
-
 /// Defines the current state
 struct State {
     /// Last used mode
@@ -230,6 +230,8 @@ struct Condition {
     }
 };
 
+constexpr uint32_t invalid_ticket_idx = std::numeric_limits<uint32_t>::max();
+
 /// Structure représentant une étiquette
 struct Label {
     Cost cost = 0;  //< Coût cummulé
@@ -246,7 +248,9 @@ struct Label {
 
     Ticket::ticket_type current_type = Ticket::FlatFare;
 
-    std::vector<Ticket> tickets;  //< Ensemble de billets à acheter pour arriver à cette étiquette
+    /// last ticket to buy to reach this label, in the tickets bought during the computation, which are shared between
+    /// the labels: each one knows the previous ticket of its label
+    uint32_t last_ticket = invalid_ticket_idx;
     /// Constructeur par défaut
     Label() {}
     bool operator==(const Label& l) const {
@@ -291,7 +295,8 @@ struct Transition {
     std::string ticket_key;                                       //< clef vers le tarif correspondant
     GlobalCondition global_condition = GlobalCondition::nothing;  //< condition telle que exclusivité ou OD
 
-    bool valid(const SectionKey& section, const Label& label) const;
+    /// last_ticket is the last ticket of the label, nullptr if it has none
+    bool valid(const SectionKey& section, const Label& label, const Ticket* last_ticket) const;
 
     template <class Archive>
     void serialize(Archive& ar, const unsigned int) {
@@ -326,20 +331,48 @@ struct results {
 
 /// Contient l'ensemble du système tarifaire
 struct Fare {
-    /// Map qui associe les clefs de tarifs aux tarifs
-    std::map<std::string, DateTicket> fare_map;
-
     std::map<OD_key, std::map<OD_key, std::vector<std::string>>> od_tickets;
 
-    /// Contient le graph des transitions
     typedef boost::adjacency_list<boost::listS, boost::vecS, boost::directedS, State, Transition> Graph;
     typedef boost::graph_traits<Graph>::vertex_descriptor vertex_t;
     typedef boost::graph_traits<Graph>::edge_descriptor edge_t;
-    Graph g;
     Fare::vertex_t begin_v;  // begin vertex descriptor
 
+    /**
+     * The transitions graph compiled for compute_fare: the tickets are numbered, and the transitions are stored by
+     * start state in one array, in the order of the graph's edges
+     */
+    struct Automaton {
+        static constexpr uint32_t free_transition = std::numeric_limits<uint32_t>::max();
+
+        struct Arc {
+            uint32_t target;
+            uint32_t ticket_id;  //< in tickets, free_transition if there is no ticket to buy
+            Transition transition;
+        };
+
+        std::vector<State> states;
+        /// the transitions from the state u are arcs[arc_begins[u]] to arcs[arc_begins[u + 1]]
+        std::vector<uint32_t> arc_begins;
+        std::vector<Arc> arcs;
+        /// the tickets by id, with no period for the ticket keys without price
+        std::vector<DateTicket> tickets;
+        Ticket default_ticket = make_default_ticket();
+
+        Automaton() = default;
+        Automaton(const Graph& g, const std::map<std::string, DateTicket>& fare_map);
+    };
+
     Fare() { add_default_ticket(); }
 
+    /// The fare is modified through these methods only, so that it knows it must be compiled again
+    vertex_t add_state(const State& state);
+    void add_transition(vertex_t start, vertex_t end, const Transition& transition);
+    void add_ticket(const std::string& key,
+                    boost::gregorian::date begin_date,
+                    boost::gregorian::date end_date,
+                    const Ticket& ticket);
+
     /// Effectue la recherche du meilleur tarif
     /// Retourne une liste de billets à acheter
     results compute_fare(const routing::Path& path) const;
@@ -354,14 +387,34 @@ struct Fare {
         // boost adjacency load does not seems to empty the graph, hence there was a memory leak
         g.clear();
         ar& fare_map& od_tickets& g;
+        compile();
     }
     BOOST_SERIALIZATION_SPLIT_MEMBER()
 
+    /// compile the transitions and the tickets for compute_fare, to be done again if the fare is modified.
+    /// A fare not compiled is compiled for each computation
+    void compile() {
+        automaton = Automaton(g, fare_map);
+        compiled = true;
+    }
+    /// false as soon as the fare is modified after its compilation
+    bool is_compiled() const { return compiled; }
+
+    size_t nb_tickets() const { return fare_map.size(); }
     size_t nb_transitions() const;
 
 private:
-    /// Retourne le ticket OD qui va bien ou lève une exception no_ticket si on ne trouve pas
-    DateTicket get_od(const Label& label, const SectionKey& section) const;
+    /// Map qui associe les clefs de tarifs aux tarifs
+    std::map<std::string, DateTicket> fare_map;
+
+    /// Contient le graph des transitions
+    Graph g;
+
+    Automaton automaton;
+    bool compiled = false;
+
+    /// Retourne le ticket OD qui va bien, ou rien si on ne le trouve pas
+    boost::optional<DateTicket> get_od(const Label& label, const SectionKey& section) const;
 
     void add_default_ticket();
 
@@ -69,23 +69,23 @@ BOOST_AUTO_TEST_CASE(test_protobuff) {
     // fare data initialization
     boost::gregorian::date start_date(boost::gregorian::from_undelimited_string("20110101"));
     boost::gregorian::date end_date(boost::gregorian::from_undelimited_string("20350101"));
-    b.data->fare->fare_map["price1"].add(start_date, end_date, fare::Ticket("price1", "Ticket vj 1", 100, "125"));
-    b.data->fare->fare_map["price2"].add(start_date, end_date, fare::Ticket("price2", "Ticket vj 2", 200, "175"));
+    b.data->fare->add_ticket("price1", start_date, end_date, fare::Ticket("price1", "Ticket vj 1", 100, "125"));
+    b.data->fare->add_ticket("price2", start_date, end_date, fare::Ticket("price2", "Ticket vj 2", 200, "175"));
 
     // dummy transition
     fare::Transition transitionA;
     fare::State endA;
     endA.line = "A";
     transitionA.ticket_key = "price1";
-    auto endA_v = boost::add_vertex(endA, b.data->fare->g);
-    boost::add_edge(b.data->fare->begin_v, endA_v, transitionA, b.data->fare->g);
+    auto endA_v = b.data->fare->add_state(endA);
+    b.data->fare->add_transition(b.data->fare->begin_v, endA_v, transitionA);
 
     fare::Transition transitionB;
     fare::State endB;
     endB.line = "B";
     transitionB.ticket_key = "price2";
-    auto endB_v = boost::add_vertex(endB, b.data->fare->g);
-    boost::add_edge(b.data->fare->begin_v, endB_v, transitionB, b.data->fare->g);
+    auto endB_v = b.data->fare->add_state(endB);
+    b.data->fare->add_transition(b.data->fare->begin_v, endB_v, transitionB);
 
     // call to raptor
     type::EntryPoint origin(type::Type_e::StopArea, "stop1");
@@ -141,7 +141,10 @@ static Fare load_fare_from_ed(const ed::Data& ed_data) {
     // for od and price, easy
     fare.od_tickets = ed_data.od_tickets;
     for (const auto& f : ed_data.fare_map) {
-        fare.fare_map.insert(f);
+        for (const auto& period_ticket : f.second.tickets) {
+            fare.add_ticket(f.first, period_ticket.validity_period.begin(), period_ticket.validity_period.end(),
+                            period_ticket.ticket);
+        }
     }
 
     // for transition we have to build the graph
@@ -158,18 +161,18 @@ static Fare load_fare_from_ed(const ed::Data& ed_data) {
 
         Fare::vertex_t start_v, end_v;
         if (state_map.find(start) == state_map.end()) {
-            start_v = boost::add_vertex(start, fare.g);
+            start_v = fare.add_state(start);
             state_map[start] = start_v;
         } else
             start_v = state_map[start];
 
         if (state_map.find(end) == state_map.end()) {
-            end_v = boost::add_vertex(end, fare.g);
+            end_v = fare.add_state(end);
             state_map[end] = end_v;
         } else
             end_v = state_map[end];
 
-        boost::add_edge(start_v, end_v, transition, fare.g);
+        fare.add_transition(start_v, end_v, transition);
     }
 
     return fare;
@@ -610,14 +613,70 @@ BOOST_FIXTURE_TEST_CASE(journeys_with_unknown_section, fare_load_fixture) {
     BOOST_CHECK_EQUAL(res.tickets.at(2).key, make_default_ticket().key);
 }
 
+/*
+ * The fare compiled, as when it is loaded, gives the tickets expected by the tests above, and it is no longer
+ * compiled as soon as it is modified
+ */
+BOOST_FIXTURE_TEST_CASE(compiled_fare, fare_load_fixture) {
+    BOOST_REQUIRE(!f.is_compiled());
+    f.compile();
+    BOOST_REQUIRE(f.is_compiled());
+
+    keys.push_back("ratp;8739300;FILGATO-2;8775890;2011|12|01;04|40;04|50;4;1;rapidtransit");
+    keys.push_back("ratp;nation;montparnasse;FILGATO-2;2011|12|01;04|40;04|50;1;1;bus");
+    keys.push_back("ratp;8775890;FILGATO-2;8775499;2011|12|01;04|40;04|50;1;5;rapidtransit");
+    res = f.compute_fare(string_to_path(keys));
+    BOOST_REQUIRE_EQUAL(res.tickets.size(), 3);
+    BOOST_CHECK_EQUAL(res.tickets.at(0).value, 320);
+    BOOST_CHECK_EQUAL(res.tickets.at(1).value, 170);
+    BOOST_CHECK_EQUAL(res.tickets.at(2).value, 700);
+
+    keys.clear();
+    keys.push_back("5604:127;11:120;050050023:23;8727622;2011|07|31;09|28;09|39;4;4;Bus");
+    keys.push_back(";8727622;800:D;8775890;2011|07|31;09|47;10|09;4;1;RapidTransit");
+    keys.push_back(";8775860;100110007:7;R_0007;2011|07|31;10|20;10|21;1;1;Metro");
+    res = f.compute_fare(string_to_path(keys));
+    BOOST_REQUIRE_EQUAL(res.tickets.size(), 2);
+    BOOST_CHECK_EQUAL(res.tickets.at(0).value, 170);
+    BOOST_CHECK_EQUAL(res.tickets.at(0).sections.size(), 1);
+    BOOST_CHECK_EQUAL(res.tickets.at(1).value, 395);
+    BOOST_CHECK_EQUAL(res.tickets.at(1).sections.size(), 2);
+
+    keys.clear();
+    keys.push_back(";8711388;800:T4;8727141;2011|07|31;09|28;09|39;4;4;tramway");
+    keys.push_back(";8727141;RER B;8770870;2011|07|31;09|28;09|39;4;4;RapidTransit");
+    res = f.compute_fare(string_to_path(keys));
+    BOOST_REQUIRE_EQUAL(res.tickets.size(), 1);
+    BOOST_CHECK_EQUAL(res.tickets.at(0).value, 545);
+
+    keys.clear();
+    keys.push_back("ratp;mantes;FILNav31;FILGATO-2;2015|03|11;04|40;04|50;4;1;metro");
+    res = f.compute_fare(string_to_path(keys));
+    BOOST_REQUIRE_EQUAL(res.tickets.size(), 1);
+    BOOST_CHECK_EQUAL(res.tickets.at(0).key, make_default_ticket().key);
+
+    // any modification of the graph or of the tickets must be compiled again
+    State metro;
+    metro.mode = "metro";
+    Transition transition;
+    transition.ticket_key = "price1";
+    f.add_transition(f.begin_v, f.add_state(metro), transition);
+    BOOST_CHECK(!f.is_compiled());
+    f.compile();
+    BOOST_CHECK(f.is_compiled());
+    f.add_ticket("price1", boost::gregorian::date(2011, 1, 1), boost::gregorian::date(2035, 1, 1),
+                 Ticket("price1", "Ticket 1", 100, "125"));
+    BOOST_CHECK(!f.is_compiled());
+}
+
 BOOST_AUTO_TEST_CASE(test_without_file_load_and_unknown_fare) {
     std::vector<std::string> keys;
 
     Fare fare;
     boost::gregorian::date start_date(boost::gregorian::from_undelimited_string("20110101"));
     boost::gregorian::date end_date(boost::gregorian::from_undelimited_string("20350101"));
-    fare.fare_map["price1"].add(start_date, end_date, Ticket("price1", "Ticket vj 1", 100, "125"));
-    fare.fare_map["price2"].add(start_date, end_date, Ticket("price2", "Ticket vj 2", 200, "175"));
+    fare.add_ticket("price1", start_date, end_date, Ticket("price1", "Ticket vj 1", 100, "125"));
+    fare.add_ticket("price2", start_date, end_date, Ticket("price2", "Ticket vj 2", 200, "175"));
 
     Transition transition;
     transition.start_conditions = {};
@@ -628,9 +687,9 @@ BOOST_AUTO_TEST_CASE(test_without_file_load_and_unknown_fare) {
     State end;
     start.mode = "metro";
     end.mode = "metro";
-    auto start_v = boost::add_vertex(start, fare.g);
-    auto end_v = boost::add_vertex(end, fare.g);
-    boost::add_edge(start_v, end_v, transition, fare.g);
+    auto start_v = fare.add_state(start);
+    auto end_v = fare.add_state(end);
+    fare.add_transition(start_v, end_v, transition);
 
     // Un trajet simple
     keys.push_back("bob;morane;contre;tout;2011|07|01;02|06;02|10;1;1;chacal");
@@ -68,10 +68,12 @@ struct Admin : nt::Header, nt::Nameable {
     nt::GeographicalCoord coord;
     multi_polygon_type boundary;
     std::vector<const Admin*> admin_list;
-    std::vector<const nt::StopArea*> main_stop_areas;
+    // The admins are shared by the data cloned for realtime, so they only
+    // refer to the public transport objects by their idx
+    std::vector<nt::idx_t> main_stop_areas;
 
     // TODO ODT NTFSv0.3: remove that when we stop to support NTFSv0.1
-    std::vector<const nt::StopPoint*> odt_stop_points;  // zone odt stop points for the admin
+    std::vector<nt::idx_t> odt_stop_points;  // zone odt stop points for the admin
     std::vector<std::string> postal_codes;
 
     Admin() : level(-1) {}
@@ -0,0 +1,422 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include "utils/serialization_vector.h"
+
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/properties.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/tuple/tuple.hpp>
+
+#include <cstdint>
+#include <ostream>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace navitia {
+namespace georef {
+
+/**
+ * Directed graph with bundled vertex and edge properties, stored as a compressed sparse row
+ *
+ * Once compressed, the out edges of all the vertices are packed in one array, vertex after vertex, with the
+ * offset of the first out edge of each vertex: an edge costs its 32 bits target and its property, and a
+ * vertex its property and its 32 bits offset.
+ * While the graph is built, each vertex has its own vector of out edges, so the edges can be added in any
+ * order. Adding an edge to a compressed graph expands it again. The graph is always serialized compressed.
+ *
+ * The graph models the boost IncidenceGraph, VertexListGraph and EdgeListGraph concepts, and can be built
+ * with boost::add_vertex and boost::add_edge, like the adjacency_list it replaces. An edge descriptor points
+ * to the stored edge, and is invalidated by the next add_edge.
+ **/
+template <typename V, typename E>
+class CompressedGraph {
+public:
+    struct OutEdge {
+        uint32_t target = 0;
+        E property;
+
+        OutEdge() = default;
+        OutEdge(uint32_t target, const E& property) : target(target), property(property) {}
+
+        template <class Archive>
+        void serialize(Archive& ar, const unsigned int) {
+            ar& target& property;
+        }
+    };
+
+    struct edge_descriptor {
+        std::size_t source = 0;
+        const OutEdge* out_edge = nullptr;
+
+        edge_descriptor() = default;
+        edge_descriptor(std::size_t source, const OutEdge* out_edge) : source(source), out_edge(out_edge) {}
+
+        bool operator==(const edge_descriptor& other) const { return out_edge == other.out_edge; }
+        bool operator!=(const edge_descriptor& other) const { return out_edge != other.out_edge; }
+        bool operator<(const edge_descriptor& other) const { return out_edge < other.out_edge; }
+
+        friend std::ostream& operator<<(std::ostream& os, const edge_descriptor& e) {
+            return os << "(" << e.source << "," << (e.out_edge ? e.out_edge->target : 0) << ")";
+        }
+    };
+
+    class out_edge_iterator : public boost::iterator_facade<out_edge_iterator,
+                                                            edge_descriptor,
+                                                            boost::random_access_traversal_tag,
+                                                            edge_descriptor> {
+    public:
+        out_edge_iterator() = default;
+        out_edge_iterator(std::size_t source, const OutEdge* out_edge) : source(source), out_edge(out_edge) {}
+
+    private:
+        friend class boost::iterator_core_access;
+        std::size_t source = 0;
+        const OutEdge* out_edge = nullptr;
+
+        edge_descriptor dereference() const { return {source, out_edge}; }
+        bool equal(const out_edge_iterator& other) const { return out_edge == other.out_edge; }
+        void increment() { ++out_edge; }
+        void decrement() { --out_edge; }
+        void advance(std::ptrdiff_t n) { out_edge += n; }
+        std::ptrdiff_t distance_to(const out_edge_iterator& other) const { return other.out_edge - out_edge; }
+    };
+
+    // all the edges, vertex after vertex
+    class edge_iterator
+        : public boost::iterator_facade<edge_iterator, edge_descriptor, boost::forward_traversal_tag, edge_descriptor> {
+    public:
+        edge_iterator() = default;
+        edge_iterator(const CompressedGraph* g, std::size_t source) : g(g), source(source) { skip_empty_rows(); }
+
+    private:
+        friend class boost::iterator_core_access;
+        const CompressedGraph* g = nullptr;
+        std::size_t source = 0;
+        const OutEdge* out_edge = nullptr;
+        const OutEdge* row_end = nullptr;
+
+        void skip_empty_rows() {
+            for (; source < g->num_vertices(); ++source) {
+                std::tie(out_edge, row_end) = g->row(source);
+                if (out_edge != row_end) {
+                    return;
+                }
+            }
+            out_edge = row_end = nullptr;
+        }
+        edge_descriptor dereference() const { return {source, out_edge}; }
+        bool equal(const edge_iterator& other) const { return out_edge == other.out_edge; }
+        void increment() {
+            if (++out_edge == row_end) {
+                ++source;
+                skip_empty_rows();
+            }
+        }
+    };
+
+    struct traversal_category : public boost::incidence_graph_tag,
+                                public boost::vertex_list_graph_tag,
+                                public boost::edge_list_graph_tag {};
+
+    typedef std::size_t vertex_descriptor;
+    typedef boost::counting_iterator<std::size_t> vertex_iterator;
+    typedef boost::directed_tag directed_category;
+    typedef boost::allow_parallel_edge_tag edge_parallel_category;
+    typedef std::size_t vertices_size_type;
+    typedef std::size_t edges_size_type;
+    typedef std::size_t degree_size_type;
+
+    typedef V vertex_bundled;
+    typedef E edge_bundled;
+    typedef boost::no_property graph_bundled;
+    typedef V vertex_property_type;
+    typedef E edge_property_type;
+    typedef boost::no_property graph_property_type;
+
+    std::size_t num_vertices() const { return vertices.size(); }
+    std::size_t num_edges() const { return nb_edges; }
+    bool is_compressed() const { return compressed; }
+
+    // the out edges of a vertex
+    std::pair<const OutEdge*, const OutEdge*> row(const std::size_t u) const {
+        if (compressed) {
+            return {edges.data() + row_begins[u], edges.data() + row_begins[u + 1]};
+        }
+        return {rows[u].data(), rows[u].data() + rows[u].size()};
+    }
+
+    std::size_t add_vertex(const V& v) {
+        vertices.push_back(v);
+        if (compressed) {
+            row_begins.push_back(row_begins.back());
+        } else {
+            rows.emplace_back();
+        }
+        return vertices.size() - 1;
+    }
+
+    edge_descriptor add_edge(const std::size_t u, const std::size_t v, const E& e) {
+        expand();
+        rows[u].emplace_back(uint32_t(v), e);
+        ++nb_edges;
+        return {u, &rows[u].back()};
+    }
+
+    /// pack the out edges of all the vertices in one array, once the graph is built
+    void compress() {
+        if (compressed) {
+            return;
+        }
+        fill_rows(row_begins, edges);
+        rows = std::vector<std::vector<OutEdge>>();
+        compressed = true;
+    }
+
+    /// give each vertex its own vector of out edges again, to add edges
+    void expand() {
+        if (!compressed) {
+            return;
+        }
+        rows.assign(vertices.size(), {});
+        for (std::size_t u = 0; u < vertices.size(); ++u) {
+            rows[u].assign(edges.begin() + row_begins[u], edges.begin() + row_begins[u + 1]);
+        }
+        row_begins = std::vector<uint32_t>();
+        edges = std::vector<OutEdge>();
+        compressed = false;
+    }
+
+    /// renumber the vertices, v becoming new_index[v], each vertex keeps its out edges in the same order
+    void permute(const std::vector<std::size_t>& new_index) {
+        const bool was_compressed = compressed;
+        expand();
+        std::vector<V> new_vertices(vertices.size());
+        std::vector<std::vector<OutEdge>> new_rows(vertices.size());
+        for (std::size_t u = 0; u < vertices.size(); ++u) {
+            new_vertices[new_index[u]] = std::move(vertices[u]);
+            auto& new_row = new_rows[new_index[u]];
+            new_row = std::move(rows[u]);
+            for (auto& out_edge : new_row) {
+                out_edge.target = uint32_t(new_index[out_edge.target]);
+            }
+        }
+        vertices.swap(new_vertices);
+        rows.swap(new_rows);
+        if (was_compressed) {
+            compress();
+        }
+    }
+
+    void clear() {
+        vertices.clear();
+        rows.clear();
+        row_begins.clear();
+        edges.clear();
+        nb_edges = 0;
+        compressed = false;
+    }
+
+    V& operator[](const std::size_t v) { return vertices[v]; }
+    const V& operator[](const std::size_t v) const { return vertices[v]; }
+    E& operator[](const edge_descriptor& e) { return const_cast<OutEdge*>(e.out_edge)->property; }
+    const E& operator[](const edge_descriptor& e) const { return e.out_edge->property; }
+
+    template <class Archive>
+    void save(Archive& ar, const unsigned int) const {
+        if (compressed) {
+            ar& vertices& row_begins& edges;
+        } else {
+            std::vector<uint32_t> begins;
+            std::vector<OutEdge> packed_edges;
+            fill_rows(begins, packed_edges);
+            ar& vertices& begins& packed_edges;
+        }
+    }
+    template <class Archive>
+    void load(Archive& ar, const unsigned int) {
+        clear();
+        ar& vertices& row_begins& edges;
+        nb_edges = edges.size();
+        compressed = true;
+    }
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
+
+private:
+    std::vector<V> vertices;
+    // out edges of each vertex, while the graph is built
+    std::vector<std::vector<OutEdge>> rows;
+    // once compressed, the out edges of u are edges[row_begins[u]] to edges[row_begins[u + 1]]
+    std::vector<uint32_t> row_begins;
+    std::vector<OutEdge> edges;
+    std::size_t nb_edges = 0;
+    bool compressed = false;
+
+    void fill_rows(std::vector<uint32_t>& begins, std::vector<OutEdge>& packed_edges) const {
+        begins.clear();
+        begins.reserve(rows.size() + 1);
+        begins.push_back(0);
+        packed_edges.clear();
+        packed_edges.reserve(nb_edges);
+        for (const auto& r : rows) {
+            packed_edges.insert(packed_edges.end(), r.begin(), r.end());
+            begins.push_back(uint32_t(packed_edges.size()));
+        }
+    }
+};
+
+/// readable property map of a member of the edge property, like the bundled properties of the boost graphs
+template <typename V, typename E, typename T>
+struct EdgeMemberMap : public boost::put_get_helper<const T&, EdgeMemberMap<V, E, T>> {
+    typedef typename CompressedGraph<V, E>::edge_descriptor key_type;
+    typedef T value_type;
+    typedef const T& reference;
+    typedef boost::readable_property_map_tag category;
+
+    T E::*member;
+
+    explicit EdgeMemberMap(T E::*member) : member(member) {}
+    const T& operator[](const key_type& e) const { return e.out_edge->property.*member; }
+};
+
+// the boost graph interface, found by argument dependent lookup, and from the boost namespace below
+
+template <typename V, typename E, typename T>
+EdgeMemberMap<V, E, T> get(T E::*member, const CompressedGraph<V, E>&) {
+    return EdgeMemberMap<V, E, T>(member);
+}
+
+template <typename V, typename E>
+std::size_t num_vertices(const CompressedGraph<V, E>& g) {
+    return g.num_vertices();
+}
+
+template <typename V, typename E>
+std::size_t num_edges(const CompressedGraph<V, E>& g) {
+    return g.num_edges();
+}
+
+template <typename V, typename E>
+std::pair<typename CompressedGraph<V, E>::vertex_iterator, typename CompressedGraph<V, E>::vertex_iterator> vertices(
+    const CompressedGraph<V, E>& g) {
+    return {typename CompressedGraph<V, E>::vertex_iterator(0),
+            typename CompressedGraph<V, E>::vertex_iterator(g.num_vertices())};
+}
+
+template <typename V, typename E>
+std::pair<typename CompressedGraph<V, E>::edge_iterator, typename CompressedGraph<V, E>::edge_iterator> edges(
+    const CompressedGraph<V, E>& g) {
+    return {typename CompressedGraph<V, E>::edge_iterator(&g, 0),
+            typename CompressedGraph<V, E>::edge_iterator(&g, g.num_vertices())};
+}
+
+template <typename V, typename E>
+std::pair<typename CompressedGraph<V, E>::out_edge_iterator, typename CompressedGraph<V, E>::out_edge_iterator>
+out_edges(const std::size_t u, const CompressedGraph<V, E>& g) {
+    const auto row = g.row(u);
+    return {{u, row.first}, {u, row.second}};
+}
+
+template <typename V, typename E>
+std::size_t out_degree(const std::size_t u, const CompressedGraph<V, E>& g) {
+    const auto row = g.row(u);
+    return row.second - row.first;
+}
+
+template <typename V, typename E>
+std::size_t source(const typename CompressedGraph<V, E>::edge_descriptor& e, const CompressedGraph<V, E>&) {
+    return e.source;
+}
+
+template <typename V, typename E>
+std::size_t target(const typename CompressedGraph<V, E>::edge_descriptor& e, const CompressedGraph<V, E>&) {
+    return e.out_edge->target;
+}
+
+template <typename V, typename E>
+std::pair<typename CompressedGraph<V, E>::edge_descriptor, bool> edge(const std::size_t u,
+                                                                      const std::size_t v,
+                                                                      const CompressedGraph<V, E>& g) {
+    const auto row = g.row(u);
+    for (auto out_edge = row.first; out_edge != row.second; ++out_edge) {
+        if (out_edge->target == v) {
+            return {{u, out_edge}, true};
+        }
+    }
+    return {{}, false};
+}
+
+template <typename V, typename E>
+std::size_t add_vertex(const V& v, CompressedGraph<V, E>& g) {
+    return g.add_vertex(v);
+}
+
+template <typename V, typename E>
+std::size_t add_vertex(CompressedGraph<V, E>& g) {
+    return g.add_vertex(V());
+}
+
+template <typename V, typename E>
+std::pair<typename CompressedGraph<V, E>::edge_descriptor, bool> add_edge(const std::size_t u,
+                                                                          const std::size_t v,
+                                                                          const E& e,
+                                                                          CompressedGraph<V, E>& g) {
+    return {g.add_edge(u, v, e), true};
+}
+
+template <typename V, typename E>
+std::pair<typename CompressedGraph<V, E>::edge_descriptor, bool> add_edge(const std::size_t u,
+                                                                          const std::size_t v,
+                                                                          CompressedGraph<V, E>& g) {
+    return {g.add_edge(u, v, E()), true};
+}
+
+}  // namespace georef
+}  // namespace navitia
+
+namespace boost {
+using navitia::georef::add_edge;
+using navitia::georef::add_vertex;
+using navitia::georef::edge;
+using navitia::georef::edges;
+using navitia::georef::get;
+using navitia::georef::num_edges;
+using navitia::georef::num_vertices;
+using navitia::georef::out_degree;
+using navitia::georef::out_edges;
+using navitia::georef::source;
+using navitia::georef::target;
+using navitia::georef::vertices;
+}  // namespace boost
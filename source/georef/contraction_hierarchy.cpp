@@ -0,0 +1,294 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "contraction_hierarchy.h"
+#include "georef.h"
+#include "path_finder.h"
+#include "utils/logger.h"
+
+#include <boost/range/iterator_range_core.hpp>
+#include <algorithm>
+#include <chrono>
+#include <queue>
+
+namespace navitia {
+namespace georef {
+
+constexpr uint32_t ContractionHierarchy::invalid;
+
+namespace {
+
+using Arc = ContractionHierarchy::Arc;
+const auto invalid = ContractionHierarchy::invalid;
+
+uint32_t add(uint32_t a, uint32_t b) {
+    return uint32_t(std::min(uint64_t(a) + b, uint64_t(invalid)));
+}
+
+// add the arc, or update it if it is shorter than the existing one
+void upsert_arc(std::vector<Arc>& arcs, uint32_t target, uint32_t weight, uint32_t middle) {
+    for (auto& arc : arcs) {
+        if (arc.target == target) {
+            if (weight < arc.weight) {
+                arc.weight = weight;
+                arc.middle = middle;
+            }
+            return;
+        }
+    }
+    arcs.emplace_back(target, weight, middle);
+}
+
+// remove the arc to target
+void remove_arc(std::vector<Arc>& arcs, uint32_t target) {
+    for (auto& arc : arcs) {
+        if (arc.target == target) {
+            arc = arcs.back();
+            arcs.pop_back();
+            return;
+        }
+    }
+}
+
+/*
+ * The graph being contracted, only with the vertices not yet contracted
+ * in_arcs[v] contains the arcs u->v, with u as target
+ */
+struct Contractor {
+    // a witness search is stopped after this number of settled vertices, at worst a useless shortcut is added
+    static const size_t max_settled = 100;
+
+    struct Shortcut {
+        uint32_t from;
+        uint32_t to;
+        uint32_t weight;
+    };
+    using Item = std::pair<uint32_t, uint32_t>;
+
+    std::vector<std::vector<Arc>> out_arcs;
+    std::vector<std::vector<Arc>> in_arcs;
+    std::vector<int> nb_contracted_neighbours;
+    std::vector<Shortcut> shortcuts;
+    std::vector<uint32_t> witness_dist;
+    std::vector<uint32_t> witness_touched;
+    std::vector<Item> witness_heap;
+
+    explicit Contractor(size_t n) : out_arcs(n), in_arcs(n), nb_contracted_neighbours(n, 0), witness_dist(n, invalid) {}
+
+    // dijkstra from source without the vertex via
+    void witness_search(uint32_t source, uint32_t via, uint32_t max_dist) {
+        for (const auto v : witness_touched) {
+            witness_dist[v] = invalid;
+        }
+        witness_touched.clear();
+        witness_heap.clear();
+
+        const auto cmp = std::greater<Item>();
+        witness_dist[source] = 0;
+        witness_touched.push_back(source);
+        witness_heap.emplace_back(0, source);
+        size_t nb_settled = 0;
+        while (!witness_heap.empty() && nb_settled < max_settled) {
+            std::pop_heap(witness_heap.begin(), witness_heap.end(), cmp);
+            const auto item = witness_heap.back();
+            witness_heap.pop_back();
+            if (item.first > max_dist) {
+                break;
+            }
+            if (item.first > witness_dist[item.second]) {
+                continue;
+            }
+            ++nb_settled;
+            for (const auto& arc : out_arcs[item.second]) {
+                if (arc.target == via) {
+                    continue;
+                }
+                const auto dist = add(item.first, arc.weight);
+                if (dist < witness_dist[arc.target]) {
+                    if (witness_dist[arc.target] == invalid) {
+                        witness_touched.push_back(arc.target);
+                    }
+                    witness_dist[arc.target] = dist;
+                    witness_heap.emplace_back(dist, arc.target);
+                    std::push_heap(witness_heap.begin(), witness_heap.end(), cmp);
+                }
+            }
+        }
+    }
+
+    // fill shortcuts with the ones needed to contract v
+    void find_shortcuts(uint32_t v) {
+        shortcuts.clear();
+        uint32_t max_out = 0;
+        for (const auto& out : out_arcs[v]) {
+            max_out = std::max(max_out, out.weight);
+        }
+        for (const auto& in : in_arcs[v]) {
+            const auto u = in.target;
+            witness_search(u, v, add(in.weight, max_out));
+            for (const auto& out : out_arcs[v]) {
+                const auto w = out.target;
+                if (w == u) {
+                    continue;
+                }
+                const auto dist = add(in.weight, out.weight);
+                if (witness_dist[w] > dist) {
+                    shortcuts.push_back({u, w, dist});
+                }
+            }
+        }
+    }
+
+    // edge difference: the less the contraction of v adds arcs the sooner it is contracted,
+    // the contracted neighbours spread the contraction uniformly over the graph
+    int priority(uint32_t v) {
+        find_shortcuts(v);
+        const int nb_arcs = out_arcs[v].size() + in_arcs[v].size();
+        return 2 * (int(shortcuts.size()) - nb_arcs) + nb_contracted_neighbours[v];
+    }
+
+    // contract v with the shortcuts computed by the last call to priority(v)
+    // the remaining arcs of v go to vertices contracted after it, they are moved to up and down
+    void contract(uint32_t v, std::vector<Arc>& up, std::vector<Arc>& down) {
+        for (const auto& shortcut : shortcuts) {
+            upsert_arc(out_arcs[shortcut.from], shortcut.to, shortcut.weight, v);
+            upsert_arc(in_arcs[shortcut.to], shortcut.from, shortcut.weight, v);
+        }
+        for (const auto& out : out_arcs[v]) {
+            remove_arc(in_arcs[out.target], v);
+            ++nb_contracted_neighbours[out.target];
+        }
+        for (const auto& in : in_arcs[v]) {
+            remove_arc(out_arcs[in.target], v);
+            ++nb_contracted_neighbours[in.target];
+        }
+        up = std::move(out_arcs[v]);
+        down = std::move(in_arcs[v]);
+        out_arcs[v] = {};
+        in_arcs[v] = {};
+    }
+};
+
+}  // namespace
+
+void ContractionHierarchy::build(const GeoRef& geo_ref, type::Mode_e mode) {
+    auto logger = log4cplus::Logger::getInstance("log");
+    const auto start = std::chrono::steady_clock::now();
+    const auto& graph = geo_ref.graph;
+    const size_t n = boost::num_vertices(graph);
+    const TransportationModeFilter filter(mode, geo_ref);
+
+    Contractor contractor(n);
+    size_t nb_edges = 0;
+    for (const auto e : boost::make_iterator_range(boost::edges(graph))) {
+        const uint32_t u = boost::source(e, graph);
+        const uint32_t v = boost::target(e, graph);
+        if (u == v || !filter(u) || !filter(v)) {
+            continue;
+        }
+        // parallel edges: only the shortest one is kept, like in the path building
+        const uint32_t weight = graph[e].duration.ticks();
+        upsert_arc(contractor.out_arcs[u], v, weight, invalid);
+        upsert_arc(contractor.in_arcs[v], u, weight, invalid);
+        ++nb_edges;
+    }
+
+    // the priorities are lazily updated: a vertex is contracted only if its priority is still the smallest
+    using Item = std::pair<int, uint32_t>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+    for (uint32_t v = 0; v < n; ++v) {
+        if (filter(v)) {
+            queue.emplace(contractor.priority(v), v);
+        }
+    }
+    rank.assign(n, invalid);
+    std::vector<std::vector<Arc>> up(n), down(n);
+    uint32_t next_rank = 0;
+    size_t nb_shortcuts = 0;
+    while (!queue.empty()) {
+        const auto v = queue.top().second;
+        queue.pop();
+        const int priority = contractor.priority(v);
+        if (!queue.empty() && priority > queue.top().first) {
+            queue.emplace(priority, v);
+            continue;
+        }
+        nb_shortcuts += contractor.shortcuts.size();
+        contractor.contract(v, up[v], down[v]);
+        rank[v] = next_rank++;
+    }
+
+    up_first.assign(n + 1, 0);
+    up_arcs.clear();
+    down_first.assign(n + 1, 0);
+    down_arcs.clear();
+    for (uint32_t u = 0; u < n; ++u) {
+        up_first[u] = up_arcs.size();
+        up_arcs.insert(up_arcs.end(), up[u].begin(), up[u].end());
+        down_first[u] = down_arcs.size();
+        down_arcs.insert(down_arcs.end(), down[u].begin(), down[u].end());
+    }
+    up_first[n] = up_arcs.size();
+    down_first[n] = down_arcs.size();
+
+    const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+    LOG4CPLUS_INFO(logger, "contraction hierarchy for " << mode << ": " << next_rank << " vertices, " << nb_edges
+                                                        << " edges, " << nb_shortcuts << " shortcuts, built in "
+                                                        << duration.count() << "s");
+}
+
+uint32_t ContractionHierarchy::get_middle(uint32_t from, uint32_t to) const {
+    if (rank[from] < rank[to]) {
+        for (auto i = up_first[from]; i < up_first[from + 1]; ++i) {
+            if (up_arcs[i].target == to) {
+                return up_arcs[i].middle;
+            }
+        }
+    } else {
+        for (auto i = down_first[to]; i < down_first[to + 1]; ++i) {
+            if (down_arcs[i].target == from) {
+                return down_arcs[i].middle;
+            }
+        }
+    }
+    throw navitia::exception("impossible to find an arc of the contraction hierarchy");
+}
+
+void ContractionHierarchy::unpack(uint32_t from, uint32_t to, uint32_t middle, std::vector<uint32_t>& path) const {
+    if (middle == invalid) {
+        path.push_back(to);
+        return;
+    }
+    unpack(from, middle, get_middle(from, middle), path);
+    unpack(middle, to, get_middle(middle, to), path);
+}
+
+}  // namespace georef
+}  // namespace navitia
@@ -0,0 +1,98 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include "type/type_interfaces.h"
+#include "utils/serialization_vector.h"
+
+#include <limits>
+#include <vector>
+
+namespace navitia {
+namespace georef {
+
+struct GeoRef;
+
+/**
+ * Contraction hierarchy of the part of the street network graph usable by a transportation mode
+ *
+ * The vertices are contracted one by one, from the least important one, and shortcuts are added
+ * between their neighbours when no other path (witness) is as short. A query is then a
+ * bidirectional dijkstra only relaxing the arcs going to more important vertices, which settles
+ * a tiny part of the graph, even for long car trips.
+ *
+ * The vertices keep their index in GeoRef::graph, the arcs are stored by vertex (like a CSR):
+ *  - up_arcs: the arcs u->v with rank[v] > rank[u], stored in u
+ *  - down_arcs: the arcs v->u with rank[v] > rank[u], stored in u (for the backward search)
+ * The weights are the edges' durations in ticks (tenths of second), without the speed factor.
+ */
+struct ContractionHierarchy {
+    static constexpr uint32_t invalid = std::numeric_limits<uint32_t>::max();
+
+    struct Arc {
+        uint32_t target = invalid;
+        uint32_t weight = 0;
+        uint32_t middle = invalid;  // contracted vertex of a shortcut, invalid for an edge of the graph
+
+        Arc() = default;
+        Arc(uint32_t target, uint32_t weight, uint32_t middle) : target(target), weight(weight), middle(middle) {}
+
+        template <class Archive>
+        void serialize(Archive& ar, const unsigned int) {
+            ar& target& weight& middle;
+        }
+    };
+
+    std::vector<uint32_t> rank;  // invalid for the vertices not usable by the mode
+    std::vector<uint32_t> up_first;
+    std::vector<Arc> up_arcs;
+    std::vector<uint32_t> down_first;
+    std::vector<Arc> down_arcs;
+
+    bool empty() const { return rank.empty(); }
+
+    /// build the hierarchy of the vertices allowed for the mode (cf allowed_transportation_mode)
+    void build(const GeoRef& geo_ref, type::Mode_e mode);
+
+    /// middle of the arc from -> to, invalid if it is an edge of the graph
+    uint32_t get_middle(uint32_t from, uint32_t to) const;
+
+    /// append to path the vertices of the graph represented by the arc from -> to (without from)
+    void unpack(uint32_t from, uint32_t to, uint32_t middle, std::vector<uint32_t>& path) const;
+
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int) {
+        ar& rank& up_first& up_arcs& down_first& down_arcs;
+    }
+};
+
+}  // namespace georef
+}  // namespace navitia
@@ -0,0 +1,175 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "contraction_hierarchy_path_finder.h"
+
+#include <queue>
+#include <unordered_map>
+
+namespace navitia {
+namespace georef {
+
+ContractionHierarchyPathFinder::~ContractionHierarchyPathFinder() = default;
+
+uint32_t ContractionHierarchyPathFinder::to_ticks(const navitia::time_duration& duration) const {
+    if (duration.is_pos_infinity()) {
+        return ContractionHierarchy::invalid;
+    }
+    return uint32_t(std::min(double(duration.ticks()) * speed_factor, double(ContractionHierarchy::invalid - 1)));
+}
+
+Path ContractionHierarchyPathFinder::get_direct_path(const ContractionHierarchy& ch,
+                                                     const ProjectionData& target,
+                                                     const navitia::time_duration& max_duration) {
+    constexpr auto invalid = ContractionHierarchy::invalid;
+    if (!starting_edge.found || !target.found) {
+        return {};
+    }
+    computation_launch = true;
+
+    const size_t n = ch.rank.size();
+    if (forward_labels.size() != n) {
+        forward_labels.assign(n, Label());
+        backward_labels.assign(n, Label());
+        touched.clear();
+    }
+    for (const auto v : touched) {
+        forward_labels[v] = Label();
+        backward_labels[v] = Label();
+    }
+    touched.clear();
+
+    using Item = std::pair<uint32_t, uint32_t>;
+    using Queue = std::priority_queue<Item, std::vector<Item>, std::greater<Item>>;
+    Queue forward_queue, backward_queue;
+    const uint32_t limit = to_ticks(max_duration);
+
+    auto push = [&](std::vector<Label>& labels, Queue& queue, uint32_t v, uint64_t dist, uint32_t parent,
+                    uint32_t arc_idx) {
+        if (dist > limit || dist >= labels[v].dist) {
+            return;
+        }
+        if (forward_labels[v].dist == invalid && backward_labels[v].dist == invalid) {
+            touched.push_back(v);
+        }
+        labels[v] = {uint32_t(dist), parent, arc_idx};
+        queue.emplace(uint32_t(dist), v);
+    };
+
+    // the forward search starts from the starting edge, the backward one from the target edge, both with the
+    // projection durations
+    for (const auto d : {source_e, target_e}) {
+        const auto start = starting_edge[d];
+        if (distances[start] != bt::pos_infin && ch.rank[start] != invalid) {
+            push(forward_labels, forward_queue, start, to_ticks(distances[start]), invalid, invalid);
+        }
+        const auto dest = target[d];
+        if (ch.rank[dest] != invalid) {
+            push(backward_labels, backward_queue, dest, to_ticks(crow_fly_duration(target.distances[d])), invalid,
+                 invalid);
+        }
+    }
+
+    // both searches only go up in the hierarchy, they stop when they can't improve the best meeting
+    uint64_t best = invalid;
+    uint32_t meeting = invalid;
+    auto settle = [&](Queue& queue, std::vector<Label>& labels, const std::vector<Label>& other_labels,
+                      const std::vector<uint32_t>& first, const std::vector<ContractionHierarchy::Arc>& arcs) {
+        const auto item = queue.top();
+        queue.pop();
+        const auto v = item.second;
+        if (item.first > labels[v].dist) {
+            return;
+        }
+        if (other_labels[v].dist != invalid && uint64_t(item.first) + other_labels[v].dist < best) {
+            best = uint64_t(item.first) + other_labels[v].dist;
+            meeting = v;
+        }
+        for (auto i = first[v]; i < first[v + 1]; ++i) {
+            push(labels, queue, arcs[i].target, uint64_t(item.first) + arcs[i].weight, v, i);
+        }
+    };
+    while (true) {
+        const bool forward = !forward_queue.empty() && forward_queue.top().first < best;
+        const bool backward = !backward_queue.empty() && backward_queue.top().first < best;
+        if (!forward && !backward) {
+            break;
+        }
+        if (forward && (!backward || forward_queue.top().first <= backward_queue.top().first)) {
+            settle(forward_queue, forward_labels, backward_labels, ch.up_first, ch.up_arcs);
+        } else {
+            settle(backward_queue, backward_labels, forward_labels, ch.down_first, ch.down_arcs);
+        }
+    }
+    if (meeting == invalid || best > limit) {
+        return {};
+    }
+
+    // unpack the shortcuts from the start to the meeting vertex, then from the meeting vertex to the target
+    std::vector<uint32_t> forward_chain;
+    for (auto v = meeting; v != invalid; v = forward_labels[v].parent) {
+        forward_chain.push_back(v);
+    }
+    std::vector<uint32_t> vertices = {forward_chain.back()};
+    for (size_t i = forward_chain.size() - 1; i > 0; --i) {
+        const auto to = forward_chain[i - 1];
+        ch.unpack(forward_chain[i], to, ch.up_arcs[forward_labels[to].arc_idx].middle, vertices);
+    }
+    for (auto v = meeting; backward_labels[v].parent != invalid; v = backward_labels[v].parent) {
+        ch.unpack(v, backward_labels[v].parent, ch.down_arcs[backward_labels[v].arc_idx].middle, vertices);
+    }
+
+    // with edges of null duration, the path can go through a vertex twice, the loop is removed
+    std::unordered_map<uint32_t, size_t> positions;
+    size_t nb_vertices = 0;
+    for (const auto v : vertices) {
+        const auto it = positions.find(v);
+        if (it != positions.end()) {
+            for (size_t i = it->second + 1; i < nb_vertices; ++i) {
+                positions.erase(vertices[i]);
+            }
+            nb_vertices = it->second + 1;
+            continue;
+        }
+        positions[v] = nb_vertices;
+        vertices[nb_vertices++] = v;
+    }
+    vertices.resize(nb_vertices);
+
+    predecessors[vertices.front()] = vertices.front();
+    for (size_t i = 1; i < vertices.size(); ++i) {
+        predecessors[vertices[i]] = vertices[i - 1];
+    }
+    const auto direction = vertices.back() == target[source_e] ? source_e : target_e;
+    return PathFinder::get_path(target, {navitia::milliseconds(int32_t(best * 100)) / speed_factor, direction});
+}
+
+}  // namespace georef
+}  // namespace navitia
@@ -0,0 +1,75 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include "path_finder.h"
+
+namespace navitia {
+namespace georef {
+
+/**
+ * Direct path computed with a contraction hierarchy
+ *
+ * Like the other path finders, the predecessors of the found path are updated so the path is built
+ * with PathFinder::get_path
+ */
+class ContractionHierarchyPathFinder : public PathFinder {
+public:
+    ContractionHierarchyPathFinder(const GeoRef& geo_ref) : PathFinder(geo_ref) {}
+    ContractionHierarchyPathFinder(const ContractionHierarchyPathFinder& o) = default;
+    virtual ~ContractionHierarchyPathFinder();
+
+    void init(const type::GeographicalCoord& start_coord, nt::Mode_e mode, const float speed_factor) {
+        PathFinder::init_start(start_coord, mode, speed_factor);
+    }
+
+    /// shortest path to the target, an empty path if it's not reachable under max_duration
+    Path get_direct_path(const ContractionHierarchy& ch,
+                         const ProjectionData& target,
+                         const navitia::time_duration& max_duration);
+
+private:
+    struct Label {
+        uint32_t dist = ContractionHierarchy::invalid;
+        uint32_t parent = ContractionHierarchy::invalid;
+        uint32_t arc_idx = ContractionHierarchy::invalid;
+    };
+    // labels of the forward and backward searches, only the touched ones are reset between queries
+    std::vector<Label> forward_labels;
+    std::vector<Label> backward_labels;
+    std::vector<uint32_t> touched;
+
+    // ticks of a duration without the speed factor, like the weights of the hierarchy
+    uint32_t to_ticks(const navitia::time_duration& duration) const;
+};
+
+}  // namespace georef
+}  // namespace navitia
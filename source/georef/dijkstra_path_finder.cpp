@@ -53,8 +53,25 @@ void DijkstraPathFinder::start_distance_dijkstra(const navitia::time_duration& r
 static routing::SpIdx get_id(const routing::SpIdx& idx) {
     return idx;
 }
-static std::string get_id(const type::GeographicalCoord& coord) {
-    return coord.uri();
+
+georef::RoutingElement DijkstraPathFinder::get_routing_element(const ProjectionData& projection,
+                                                               const navitia::time_duration& radius) {
+    // if our two points are projected on the same edge the
+    // Dijkstra won't give us the correct value we need to handle
+    // this case separately
+    navitia::time_duration duration;
+    if (is_projected_on_same_edge(starting_edge, projection)) {
+        // We calculate the duration for going to the edge, then to
+        // the projected destination on the edge and finally to the
+        // destination
+        duration = path_duration_on_same_edge(starting_edge, projection);
+    } else {
+        duration = find_nearest_vertex(projection, true).first;
+    }
+    if (duration <= radius) {
+        return georef::RoutingElement(duration, georef::RoutingStatus_e::reached);
+    }
+    return georef::RoutingElement(navitia::time_duration(), georef::RoutingStatus_e::unreached);
 }
 
 template <typename K, typename U, typename G>
@@ -81,25 +98,7 @@ boost::container::flat_map<K, georef::RoutingElement> DijkstraPathFinder::start_
     start_distance_dijkstra(radius);
 
     for (const auto& dest : projection_found_dests) {
-        // if our two points are projected on the same edge the
-        // Dijkstra won't give us the correct value we need to handle
-        // this case separately
-        auto& projection = dest.second;
-        auto& id = dest.first;
-        navitia::time_duration duration;
-        if (is_projected_on_same_edge(starting_edge, projection)) {
-            // We calculate the duration for going to the edge, then to
-            // the projected destination on the edge and finally to the
-            // destination
-            duration = path_duration_on_same_edge(starting_edge, projection);
-        } else {
-            duration = find_nearest_vertex(projection, true).first;
-        }
-        if (duration <= radius) {
-            result[id] = georef::RoutingElement(duration, georef::RoutingStatus_e::reached);
-        } else {
-            result[id] = georef::RoutingElement(navitia::time_duration(), georef::RoutingStatus_e::unreached);
-        }
+        result[dest.first] = get_routing_element(dest.second, radius);
     }
     return result;
 }
@@ -174,20 +173,10 @@ routing::map_stop_point_duration DijkstraPathFinder::find_nearest_stop_points(
     return result;
 }
 
-struct ProjectionGetterOnFly {
-    const GeoRef& geo_ref;
-    const nt::idx_t offset;
-    const georef::ProjectionData operator()(const type::GeographicalCoord& coord) const {
-        return georef::ProjectionData{coord, geo_ref, offset, geo_ref.pl};
-    }
-};
-
-boost::container::flat_map<DijkstraPathFinder::coord_uri, georef::RoutingElement>
-DijkstraPathFinder::get_duration_with_dijkstra(const navitia::time_duration& radius,
-                                               const std::vector<type::GeographicalCoord>& dest_coords) {
-    if (dest_coords.empty()) {
-        return {};
-    }
+std::vector<ProjectionData> DijkstraPathFinder::project_destinations(
+    const GeoRef& geo_ref,
+    nt::Mode_e mode,
+    const std::vector<type::GeographicalCoord>& destinations) {
     nt::idx_t offset;
     if (mode == type::Mode_e::Car) {
         // on direct path with car we want to arrive on the walking graph
@@ -195,10 +184,33 @@ DijkstraPathFinder::get_duration_with_dijkstra(const navitia::time_duration& rad
     } else {
         offset = geo_ref.offsets[mode];
     }
+    std::vector<ProjectionData> projections;
+    projections.reserve(destinations.size());
+    for (const auto& coord : destinations) {
+        projections.emplace_back(coord, geo_ref, offset, geo_ref.pl);
+    }
+    return projections;
+}
+
+std::vector<georef::RoutingElement> DijkstraPathFinder::get_duration_with_dijkstra(
+    const navitia::time_duration& radius,
+    const std::vector<ProjectionData>& destinations) {
+    std::vector<georef::RoutingElement> result(
+        destinations.size(), georef::RoutingElement(navitia::time_duration(), georef::RoutingStatus_e::unknown));
+    // if there are no destinations projected on the graph, there is no need to start the dijkstra
+    if (std::none_of(destinations.begin(), destinations.end(),
+                     [](const ProjectionData& projection) { return projection.found; })) {
+        return result;
+    }
+
+    start_distance_dijkstra(radius);
 
-    ProjectionGetterOnFly projection_getter{geo_ref, offset};
-    return start_dijkstra_and_fill_duration_map<DijkstraPathFinder::coord_uri, type::GeographicalCoord,
-                                                ProjectionGetterOnFly>(radius, dest_coords, projection_getter);
+    for (size_t i = 0; i < destinations.size(); ++i) {
+        if (destinations[i].found) {
+            result[i] = get_routing_element(destinations[i], radius);
+        }
+    }
+    return result;
 }
 
 template <class Visitor>
@@ -214,8 +226,16 @@ void DijkstraPathFinder::dijkstra(const std::array<georef::vertex_t, 2>& origin_
     auto const weight_map = boost::get(&Edge::duration, geo_ref.graph);
     auto const combiner = SpeedDistanceCombiner(speed_factor);  // we multiply the edge duration by a speed factor
 
-    dijkstra_shortest_paths_no_init_with_heap(g, origin_vertexes.front(), origin_vertexes.back(), visitor, weight_map,
-                                              combiner);
+    if (radix_heap_by_mode[mode]) {
+        radix_heap.clear(&distances[0]);
+        dijkstra_shortest_paths_no_init_with_queue(g, origin_vertexes.front(), origin_vertexes.back(), visitor,
+                                                   weight_map, combiner, radix_heap);
+    } else {
+        boost::d_ary_heap_indirect<vertex_t, 4, vertex_t*, navitia::time_duration*> heap(&distances[0],
+                                                                                         &index_in_heap_map[0]);
+        dijkstra_shortest_paths_no_init_with_queue(g, origin_vertexes.front(), origin_vertexes.back(), visitor,
+                                                   weight_map, combiner, heap);
+    }
 }
 
 std::pair<navitia::time_duration, ProjectionData::Direction> DijkstraPathFinder::update_path(
@@ -265,19 +285,16 @@ navitia::time_duration DijkstraPathFinder::get_distance(type::idx_t target_idx)
     return nearest_edge.first;
 }
 
-template <class Graph, class DijkstraVisitor, class WeightMap, class Compare>
-void DijkstraPathFinder::dijkstra_shortest_paths_no_init_with_heap(const Graph& g,
-                                                                   const vertex_t& s_begin,
-                                                                   const vertex_t& s_end,
-                                                                   const DijkstraVisitor& visitor,
-                                                                   const WeightMap& weight,
-                                                                   const SpeedDistanceCombiner& combine,
-                                                                   const Compare& compare) {
-    typedef boost::d_ary_heap_indirect<vertex_t, 4, vertex_t*, navitia::time_duration*, Compare> MutableQueue;
-
-    MutableQueue Q(&distances[0], &index_in_heap_map[0], compare);
-
-    boost::detail::dijkstra_bfs_visitor<DijkstraVisitor, MutableQueue, WeightMap, vertex_t*, navitia::time_duration*,
+template <class Graph, class DijkstraVisitor, class WeightMap, class Queue, class Compare>
+void DijkstraPathFinder::dijkstra_shortest_paths_no_init_with_queue(const Graph& g,
+                                                                    const vertex_t& s_begin,
+                                                                    const vertex_t& s_end,
+                                                                    const DijkstraVisitor& visitor,
+                                                                    const WeightMap& weight,
+                                                                    const SpeedDistanceCombiner& combine,
+                                                                    Queue& Q,
+                                                                    const Compare& compare) {
+    boost::detail::dijkstra_bfs_visitor<DijkstraVisitor, Queue, WeightMap, vertex_t*, navitia::time_duration*,
                                         SpeedDistanceCombiner, Compare>
         bfs_vis(visitor, Q, weight, &predecessors[0], &distances[0], combine, compare, navitia::seconds(0));
 
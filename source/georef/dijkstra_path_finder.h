@@ -32,6 +32,7 @@ www.navitia.io
 
 #include "path_finder.h"
 #include "visitor.h"
+#include "radix_heap.h"
 
 #include <boost/graph/filtered_graph.hpp>
 
@@ -48,16 +49,23 @@ public:
         PathFinder::init_start(start_coord, mode, speed_factor);
     }
 
+    // the modes whose dijkstra uses the radix heap instead of the d-ary heap
+    map_by_mode<bool> radix_heap_by_mode = {{{}}};
+
     void start_distance_dijkstra(const navitia::time_duration& radius);
 
     // compute the reachable stop points within the radius
     routing::map_stop_point_duration find_nearest_stop_points(const navitia::time_duration& radius,
                                                               const proximitylist::ProximityList<type::idx_t>& pl);
 
-    using coord_uri = std::string;
-    boost::container::flat_map<coord_uri, georef::RoutingElement> get_duration_with_dijkstra(
-        const navitia::time_duration& radius,
-        const std::vector<type::GeographicalCoord>& entry_points);
+    /// project the destinations of get_duration_with_dijkstra on the graph where the mode arrives
+    static std::vector<ProjectionData> project_destinations(const GeoRef& geo_ref,
+                                                            nt::Mode_e mode,
+                                                            const std::vector<type::GeographicalCoord>& destinations);
+
+    /// compute the durations to the projected destinations within the radius, in the order of the destinations
+    std::vector<georef::RoutingElement> get_duration_with_dijkstra(const navitia::time_duration& radius,
+                                                                   const std::vector<ProjectionData>& destinations);
 
     /**
      * Launch a dijkstra without initializing the data structure
@@ -76,6 +84,9 @@ public:
     navitia::time_duration get_distance(type::idx_t target_idx);
 
 private:
+    // the duration to a projected destination, once the dijkstra has been run
+    georef::RoutingElement get_routing_element(const ProjectionData& projection, const navitia::time_duration& radius);
+
     template <typename K, typename U, typename G>
     boost::container::flat_map<K, georef::RoutingElement> start_dijkstra_and_fill_duration_map(
         const navitia::time_duration& radius,
@@ -87,16 +98,24 @@ private:
         const navitia::time_duration& radius,
         const proximitylist::ProximityList<type::idx_t>& pl);
 
+    // queue of the dijkstra for the modes of radix_heap_by_mode (to avoid extra alloc)
+    RadixHeap radix_heap;
+
     // Call breadth first search
     // Allow to pass color map so that user deals with the allocation (and white init)
-    template <class Graph, class DijkstraVisitor, class WeightMap, class Compare = std::less<navitia::time_duration>>
-    void dijkstra_shortest_paths_no_init_with_heap(const Graph& g,
-                                                   const vertex_t& s_begin,
-                                                   const vertex_t& s_end,
-                                                   const DijkstraVisitor& visitor,
-                                                   const WeightMap& weight,
-                                                   const SpeedDistanceCombiner& combine,
-                                                   const Compare& compare = Compare());
+    template <class Graph,
+              class DijkstraVisitor,
+              class WeightMap,
+              class Queue,
+              class Compare = std::less<navitia::time_duration>>
+    void dijkstra_shortest_paths_no_init_with_queue(const Graph& g,
+                                                    const vertex_t& s_begin,
+                                                    const vertex_t& s_end,
+                                                    const DijkstraVisitor& visitor,
+                                                    const WeightMap& weight,
+                                                    const SpeedDistanceCombiner& combine,
+                                                    Queue& Q,
+                                                    const Compare& compare = Compare());
 };
 
 }  // namespace georef
@@ -402,6 +402,105 @@ void GeoRef::build_proximity_list() {
     poi_proximity_list.build();
 }
 
+void GeoRef::build_contraction_hierarchies() {
+    for (const auto mode : {nt::Mode_e::Car, nt::Mode_e::Bike}) {
+        contraction_hierarchies[mode].build(*this, mode);
+    }
+}
+
+// distance of the cell (x, y) along the Hilbert curve filling a 2^order x 2^order grid
+static uint64_t hilbert_index(uint32_t x, uint32_t y, const unsigned order) {
+    uint64_t index = 0;
+    for (uint32_t s = uint32_t(1) << (order - 1); s > 0; s /= 2) {
+        const uint32_t rx = (x & s) > 0;
+        const uint32_t ry = (y & s) > 0;
+        index += uint64_t(s) * s * ((3 * rx) ^ ry);
+        // rotate the quadrant so that the curve is continuous
+        if (ry == 0) {
+            if (rx == 1) {
+                x = s - 1 - (x & (s - 1));
+                y = s - 1 - (y & (s - 1));
+            }
+            std::swap(x, y);
+        }
+        x &= s - 1;
+        y &= s - 1;
+    }
+    return index;
+}
+
+void GeoRef::reorder_vertices() {
+    if (nb_vertex_by_mode == 0) {
+        return;
+    }
+    double min_lon = std::numeric_limits<double>::max(), max_lon = std::numeric_limits<double>::lowest();
+    double min_lat = min_lon, max_lat = max_lon;
+    for (vertex_t v = 0; v < nb_vertex_by_mode; ++v) {
+        const auto& coord = graph[v].coord;
+        min_lon = std::min(min_lon, coord.lon());
+        max_lon = std::max(max_lon, coord.lon());
+        min_lat = std::min(min_lat, coord.lat());
+        max_lat = std::max(max_lat, coord.lat());
+    }
+
+    // a 65536 x 65536 grid on the bounding box, about 15m wide cells for a whole country
+    const unsigned order = 16;
+    const double nb_cells = (1 << order) - 1;
+    const double lon_step = std::max(max_lon - min_lon, 1e-9) / nb_cells;
+    const double lat_step = std::max(max_lat - min_lat, 1e-9) / nb_cells;
+    std::vector<std::pair<uint64_t, vertex_t>> keys;
+    keys.reserve(nb_vertex_by_mode);
+    for (vertex_t v = 0; v < nb_vertex_by_mode; ++v) {
+        const auto& coord = graph[v].coord;
+        keys.emplace_back(hilbert_index(uint32_t((coord.lon() - min_lon) / lon_step),
+                                        uint32_t((coord.lat() - min_lat) / lat_step), order),
+                          v);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<vertex_t> new_index(nb_vertex_by_mode);
+    for (vertex_t i = 0; i < keys.size(); ++i) {
+        new_index[keys[i].second] = i;
+    }
+    permute_vertices(new_index);
+}
+
+void GeoRef::permute_vertices(const std::vector<vertex_t>& new_index) {
+    if (!contraction_hierarchies[nt::Mode_e::Car].empty() || !contraction_hierarchies[nt::Mode_e::Bike].empty()) {
+        throw navitia::exception("the vertices cannot be renumbered once the contraction hierarchies are built");
+    }
+    // the vertices of each transportation mode are the walking ones, shifted by the offset of the mode
+    std::vector<vertex_t> new_graph_index(boost::num_vertices(graph));
+    for (vertex_t v = 0; v < new_graph_index.size(); ++v) {
+        const auto layer_begin = v - v % nb_vertex_by_mode;
+        new_graph_index[v] = layer_begin + new_index[v - layer_begin];
+    }
+    graph.permute(new_graph_index);
+
+    for (Way* way : ways) {
+        for (auto& edge : way->edges) {
+            edge = {new_graph_index[edge.first], new_graph_index[edge.second]};
+        }
+    }
+    for (auto& projections : projected_stop_points) {
+        for (const auto mode : enum_range<nt::Mode_e>()) {
+            auto& projection = projections[mode];
+            if (!projection.found) {
+                continue;
+            }
+            for (const auto d : {ProjectionData::Direction::Source, ProjectionData::Direction::Target}) {
+                projection.vertices[d] = new_graph_index[projection.vertices[d]];
+            }
+        }
+    }
+
+    pl.clear();
+    for (vertex_t v = 0; v < nb_vertex_by_mode; ++v) {
+        pl.add(graph[v].coord, v);
+    }
+    pl.build();
+}
+
 static const Admin* find_city_admin(const std::vector<Admin*>& admins) {
     for (Admin* admin : admins) {
         // Level 8: City
@@ -32,10 +32,10 @@ www.navitia.io
 #include "autocomplete/autocomplete.h"
 #include "proximity_list/proximity_list.h"
 #include "adminref.h"
+#include "contraction_hierarchy.h"
+#include "compressed_graph.h"
 #include "utils/exception.h"
 #include "utils/flat_enum_map.h"
-#include <boost/graph/adjacency_list.hpp>
-#include <boost/graph/adj_list_serialize.hpp>
 #include <boost/serialization/serialization.hpp>
 #include "utils/serialization_vector.h"
 #include <boost/serialization/utility.hpp>
@@ -98,11 +98,11 @@ struct Edge {
 
 /** Définit le type de graph que l'on va utiliser
  *
- * Les arcs sortants et la liste des nœuds sont représentés par des vecteurs
+ * Les arcs sortants sont rangés nœud après nœud dans un seul tableau (compressed sparse row)
  * les arcs sont orientés
  * les propriétés des nœuds et arcs sont les classes définies précédemment
  */
-typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS, Vertex, Edge> Graph;
+typedef CompressedGraph<Vertex, Edge> Graph;
 
 /// Représentation d'un nœud dans le g,raphe
 typedef boost::graph_traits<Graph>::vertex_descriptor vertex_t;
@@ -247,6 +247,9 @@ struct GeoRef {
 
     /// number of vertex by transportation mode
     nt::idx_t nb_vertex_by_mode = 0;
+
+    /// optional contraction hierarchies for the direct paths, empty for the modes without one
+    flat_enum_map<nt::Mode_e, ContractionHierarchy> contraction_hierarchies;
     navitia::autocomplete::autocomplete_map synonyms;
     std::set<std::string> ghostwords;
 
@@ -257,22 +260,35 @@ struct GeoRef {
     template <class Archive>
     void save(Archive& ar, const unsigned int) const {
         ar& ways& way_map& graph& offsets& fl_admin& fl_way& pl& projected_stop_points& admins& admin_map& pois& fl_poi&
-            poitypes& poitype_map& poi_map& synonyms& ghostwords& poi_proximity_list& nb_vertex_by_mode;
+            poitypes& poitype_map& poi_map& synonyms& ghostwords& poi_proximity_list& nb_vertex_by_mode&
+            contraction_hierarchies;
     }
 
     template <class Archive>
     void load(Archive& ar, const unsigned int) {
-        // La désérialisation d'une boost adjacency list ne vide pas le graphe
-        // On avait donc une fuite de mémoire
-        graph.clear();
         ar& ways& way_map& graph& offsets& fl_admin& fl_way& pl& projected_stop_points& admins& admin_map& pois& fl_poi&
-            poitypes& poitype_map& poi_map& synonyms& ghostwords& poi_proximity_list& nb_vertex_by_mode;
+            poitypes& poitype_map& poi_map& synonyms& ghostwords& poi_proximity_list& nb_vertex_by_mode&
+            contraction_hierarchies;
     }
     BOOST_SERIALIZATION_SPLIT_MEMBER()
 
     /** Construit l'indexe spatial */
     void build_proximity_list();
 
+    /// build the contraction hierarchies of the car and bike direct paths, long to build on a big graph
+    void build_contraction_hierarchies();
+
+    /**
+     * Renumber the vertices of each transportation mode along a Hilbert curve, so that close intersections are
+     * close in memory and a dijkstra reads a few cache lines instead of the whole graph.
+     * The ways, the projections of the stop points and the proximity list follow,
+     * it must be called before building the contraction hierarchies.
+     */
+    void reorder_vertices();
+
+    /// renumber the walking vertex v as new_index[v], and its copy in each transportation mode the same way
+    void permute_vertices(const std::vector<vertex_t>& new_index);
+
     ///  Construit l'indexe autocomplete à partir des rues
     void build_autocomplete_list();
 
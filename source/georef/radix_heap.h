@@ -0,0 +1,137 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include "georef.h"
+#include "type/time_duration.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <vector>
+
+namespace navitia {
+namespace georef {
+
+/**
+ * Monotone priority queue of the vertices ordered by their distance, for the dijkstra
+ *
+ * The distances are read as their integer number of ticks (a tenth of second), and a pushed distance
+ * must never be lower than the last popped one, which always holds in a dijkstra.
+ * The vertices are stored in the buckets of the highest bit differing from the last popped distance, so
+ * each vertex is moved at most 32 times, whatever the number of vertices in the queue.
+ *
+ * The queue can be used as the boost queue of breadth_first_visit: a decreased distance is pushed again,
+ * and the entries that no longer match the distance of their vertex are dropped when they are reached.
+ **/
+class RadixHeap {
+public:
+    /// empty the queue, keeping its memory, for a dijkstra on the given distances
+    void clear(const navitia::time_duration* distances) {
+        this->distances = distances;
+        for (auto& bucket : buckets) {
+            bucket.clear();
+        }
+        last = 0;
+    }
+
+    void push(const vertex_t v) {
+        const auto k = key(v);
+        assert(k >= last);
+        buckets[bucket_index(k)].push_back({k, v});
+    }
+
+    void update(const vertex_t v) { push(v); }
+
+    bool empty() { return !settle(); }
+
+    vertex_t top() {
+        settle();
+        return buckets[0].back().second;
+    }
+
+    void pop() {
+        settle();
+        buckets[0].pop_back();
+    }
+
+private:
+    using key_t = uint32_t;
+    using entry_t = std::pair<key_t, vertex_t>;
+
+    const navitia::time_duration* distances = nullptr;
+    std::array<std::vector<entry_t>, 33> buckets;
+    key_t last = 0;
+
+    key_t key(const vertex_t v) const { return key_t(distances[v].ticks()); }
+
+    size_t bucket_index(const key_t k) const { return k == last ? 0 : 32 - __builtin_clz(k ^ last); }
+
+    bool is_valid(const entry_t& e) const { return e.first == key(e.second); }
+
+    // drop the stale entries until the back of the first bucket is the valid minimum, false if there is none
+    bool settle() {
+        while (true) {
+            auto& first = buckets[0];
+            while (!first.empty()) {
+                if (is_valid(first.back())) {
+                    return true;
+                }
+                first.pop_back();
+            }
+            auto it = std::find_if(buckets.begin() + 1, buckets.end(),
+                                   [](const std::vector<entry_t>& b) { return !b.empty(); });
+            if (it == buckets.end()) {
+                return false;
+            }
+            // the new minimum splits the bucket in lower buckets
+            auto& bucket = *it;
+            bool found = false;
+            for (const auto& e : bucket) {
+                if (is_valid(e) && (!found || e.first < last)) {
+                    last = e.first;
+                    found = true;
+                }
+            }
+            if (found) {
+                for (const auto& e : bucket) {
+                    if (is_valid(e)) {
+                        buckets[bucket_index(e.first)].push_back(e);
+                    }
+                }
+            }
+            bucket.clear();
+        }
+    }
+};
+
+}  // namespace georef
+}  // namespace navitia
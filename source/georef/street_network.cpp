@@ -31,13 +31,19 @@ www.navitia.io
 #include "street_network.h"
 #include "type/data.h"
 #include "georef.h"
+#include <atomic>
 #include <chrono>
+#include <future>
 
 namespace navitia {
 namespace georef {
 
 StreetNetwork::StreetNetwork(const GeoRef& geo_ref)
-    : geo_ref(geo_ref), departure_path_finder(geo_ref), arrival_path_finder(geo_ref), direct_path_finder(geo_ref) {}
+    : geo_ref(geo_ref),
+      departure_path_finder(geo_ref),
+      arrival_path_finder(geo_ref),
+      direct_path_finder(geo_ref),
+      ch_direct_path_finder(geo_ref) {}
 
 void StreetNetwork::init(const type::EntryPoint& start, boost::optional<const type::EntryPoint&> end) {
     departure_path_finder.init(start.coordinates, start.streetnetwork_params.mode,
@@ -132,6 +138,17 @@ Path StreetNetwork::get_direct_path(const type::EntryPoint& origin, const type::
         return Path();
     }
     const auto max_dur = origin.streetnetwork_params.max_duration + destination.streetnetwork_params.max_duration;
+    const auto& ch = geo_ref.contraction_hierarchies[origin.streetnetwork_params.mode];
+    if (!ch.empty() && ch.rank.size() == boost::num_vertices(geo_ref.graph)) {
+        ch_direct_path_finder.init(origin.coordinates, origin.streetnetwork_params.mode,
+                                   origin.streetnetwork_params.speed_factor);
+        const auto res = ch_direct_path_finder.get_direct_path(ch, dest_edge, max_dur);
+        if (res.duration > max_dur) {
+            return Path();
+        }
+        return res;
+    }
+
     direct_path_finder.init(origin.coordinates, dest_edge.projected, origin.streetnetwork_params.mode,
                             origin.streetnetwork_params.speed_factor);
 
@@ -144,5 +161,58 @@ Path StreetNetwork::get_direct_path(const type::EntryPoint& origin, const type::
     }
     return res;
 }
+void StreetNetwork::use_radix_heap(const nt::Mode_e mode) {
+    departure_path_finder.radix_heap_by_mode[mode] = true;
+    arrival_path_finder.radix_heap_by_mode[mode] = true;
+    for (auto& path_finder : matrix_path_finders) {
+        path_finder->radix_heap_by_mode[mode] = true;
+    }
+}
+
+DijkstraPathFinder& StreetNetwork::get_matrix_path_finder(const size_t i) {
+    if (i == 0) {
+        return departure_path_finder;
+    }
+    while (matrix_path_finders.size() < i) {
+        matrix_path_finders.push_back(std::make_unique<DijkstraPathFinder>(geo_ref));
+        matrix_path_finders.back()->radix_heap_by_mode = departure_path_finder.radix_heap_by_mode;
+    }
+    return *matrix_path_finders[i - 1];
+}
+
+std::vector<std::vector<RoutingElement>> StreetNetwork::get_duration_matrix(
+    const std::vector<type::EntryPoint>& origins,
+    const std::vector<type::GeographicalCoord>& destinations,
+    const navitia::time_duration& max_duration) {
+    std::vector<std::vector<RoutingElement>> matrix(origins.size());
+    if (origins.empty() || destinations.empty()) {
+        return matrix;
+    }
+    const auto projections = DijkstraPathFinder::project_destinations(
+        geo_ref, origins.front().streetnetwork_params.mode, destinations);
+
+    // each thread takes the next origin not computed yet
+    std::atomic<size_t> next_origin{0};
+    auto compute_rows = [&](DijkstraPathFinder& path_finder) {
+        for (size_t i = next_origin++; i < origins.size(); i = next_origin++) {
+            const auto& params = origins[i].streetnetwork_params;
+            path_finder.init(origins[i].coordinates, params.mode, params.speed_factor);
+            matrix[i] = path_finder.get_duration_with_dijkstra(max_duration, projections);
+        }
+    };
+
+    const size_t nb_threads = std::max(size_t(1), std::min(nb_matrix_threads, origins.size()));
+    std::vector<std::future<void>> futures;
+    for (size_t thread = 1; thread < nb_threads; ++thread) {
+        futures.push_back(std::async(std::launch::async, compute_rows, std::ref(get_matrix_path_finder(thread))));
+    }
+    compute_rows(departure_path_finder);
+    for (auto& future : futures) {
+        // rethrow the exceptions of the other threads
+        future.get();
+    }
+    return matrix;
+}
+
 }  // namespace georef
 }  // namespace navitia
@@ -32,6 +32,7 @@ www.navitia.io
 #include "georef.h"
 #include "dijkstra_path_finder.h"
 #include "astar_path_finder.h"
+#include "contraction_hierarchy_path_finder.h"
 #include "routing/raptor_utils.h"
 #include "type/type.h"  //TODO: Remove
 #include "type/time_duration.h"
@@ -58,13 +59,36 @@ struct StreetNetwork {
 
     /**
      * Build the direct path between the start and the end
+     * with the contraction hierarchy of the mode if there is one, with an A* otherwise
      **/
     Path get_direct_path(const type::EntryPoint& origin, const type::EntryPoint& destination);
 
+    /**
+     * Compute the durations from each origin to each destination, matrix[origin][destination]
+     *
+     * All the origins have the same mode. The destinations are projected once, and the origins are
+     * shared between nb_matrix_threads threads, each with its own path finder.
+     **/
+    std::vector<std::vector<RoutingElement>> get_duration_matrix(
+        const std::vector<type::EntryPoint>& origins,
+        const std::vector<type::GeographicalCoord>& destinations,
+        const navitia::time_duration& max_duration);
+
+    /// use the radix heap in the dijkstras of the mode, the d-ary heap being the default
+    void use_radix_heap(nt::Mode_e mode);
+
     const GeoRef& geo_ref;
     DijkstraPathFinder departure_path_finder;
     DijkstraPathFinder arrival_path_finder;
     AstarPathFinder direct_path_finder;
+    ContractionHierarchyPathFinder ch_direct_path_finder;
+
+    size_t nb_matrix_threads = 1;
+
+private:
+    // the path finders of the other threads of the matrix, the first one being the departure path finder
+    std::vector<std::unique_ptr<DijkstraPathFinder>> matrix_path_finders;
+    DijkstraPathFinder& get_matrix_path_finder(size_t i);
 };
 
 }  // namespace georef
@@ -42,6 +42,7 @@ www.navitia.io
 #include "ed/build_helper.h"
 #include "georef/street_network.h"
 #include <boost/graph/detail/adjacency_list.hpp>
+#include <boost/range/iterator_range_core.hpp>
 
 struct logger_initialized {
     logger_initialized() { navitia::init_logger(); }
@@ -182,6 +183,132 @@ BOOST_AUTO_TEST_CASE(outil_de_graph) {
     BOOST_CHECK_EQUAL(num_edges(g), 3);
 }
 
+/*
+ * Once compressed, the graph has the same out edges, in the same order, and can still be built
+ */
+BOOST_AUTO_TEST_CASE(compressed_graph) {
+    GraphBuilder builder;
+    builder("a", 0, 0)("b", 1, 2)("c", 3, 1)("d", 5, 5);
+    builder("a", "b", 10_s)("c", "a", 5_s)("a", "c", 7_s)("d", "b", 2_s)("a", "b", 3_s);
+    Graph& g = builder.geo_ref.graph;
+
+    const auto out_edges_of = [&](const Graph& graph, const std::string& name) {
+        std::vector<std::pair<vertex_t, navitia::time_duration>> res;
+        BOOST_FOREACH (const auto e, out_edges(builder.get(name), graph)) {
+            BOOST_CHECK_EQUAL(source(e, graph), builder.get(name));
+            res.emplace_back(target(e, graph), graph[e].duration);
+        }
+        return res;
+    };
+    const Graph expanded = g;
+    g.compress();
+    BOOST_CHECK(g.is_compressed());
+    BOOST_CHECK(!expanded.is_compressed());
+    BOOST_CHECK_EQUAL(num_vertices(g), 4);
+    BOOST_CHECK_EQUAL(num_edges(g), 5);
+    for (const auto& name : {"a", "b", "c", "d"}) {
+        BOOST_CHECK(out_edges_of(g, name) == out_edges_of(expanded, name));
+    }
+    BOOST_CHECK_EQUAL(out_degree(builder.get("a"), g), 3);
+    BOOST_CHECK_EQUAL(out_degree(builder.get("b"), g), 0);
+    BOOST_CHECK_EQUAL(g[edge(builder.get("d"), builder.get("b"), g).first].duration, 2_s);
+    BOOST_CHECK(!edge(builder.get("b"), builder.get("d"), g).second);
+    size_t nb_edges = 0;
+    for (const auto e : make_iterator_range(edges(g))) {
+        BOOST_CHECK(edge(source(e, g), target(e, g), g).second);
+        ++nb_edges;
+    }
+    BOOST_CHECK_EQUAL(nb_edges, 5);
+
+    // adding an edge expands the graph again
+    builder("b", "d", 4_s);
+    BOOST_CHECK(!g.is_compressed());
+    BOOST_CHECK_EQUAL(num_edges(g), 6);
+    BOOST_CHECK_EQUAL(g[builder.get("b", "d")].duration, 4_s);
+    BOOST_CHECK(out_edges_of(g, "a") == out_edges_of(expanded, "a"));
+}
+
+/*
+ * The vertices of a 4x4 grid, added in a scrambled order, are renumbered along a hilbert curve:
+ * each vertex is next to the previous one, for each transportation mode.
+ * The edges, the ways and the projections stay on the same coordinates.
+ */
+BOOST_AUTO_TEST_CASE(reorder_vertices) {
+    using navitia::type::Mode_e;
+    GraphBuilder b;
+    std::map<navitia::type::GeographicalCoord, std::pair<int, int>> cells;
+    for (const int i : {5, 12, 0, 15, 9, 3, 6, 10, 1, 14, 7, 2, 13, 8, 11, 4}) {
+        b("v" + std::to_string(i), (i % 4) * 100, (i / 4) * 100);
+        cells[b.geo_ref.graph[b.get("v" + std::to_string(i))].coord] = {i % 4, i / 4};
+    }
+    for (int i = 0; i < 16; ++i) {
+        if (i % 4 < 3) {
+            b("v" + std::to_string(i), "v" + std::to_string(i + 1), navitia::seconds(i), true);
+        }
+        if (i < 12) {
+            b("v" + std::to_string(i), "v" + std::to_string(i + 4), navitia::seconds(20 + i), true);
+        }
+    }
+    auto& geo_ref = b.geo_ref;
+    geo_ref.init();
+    const auto bike_offset = geo_ref.offsets[Mode_e::Bike];
+    boost::add_edge(b.get("v6") + bike_offset, b.get("v7") + bike_offset, Edge(), geo_ref.graph);
+    geo_ref.graph.compress();
+
+    Way* way = geo_ref.ways.front();
+    way->edges = {{b.get("v6"), b.get("v7")}};
+    const auto v6 = geo_ref.graph[b.get("v6")].coord, v7 = geo_ref.graph[b.get("v7")].coord;
+    const navitia::type::GeographicalCoord coord(250, 110, false);
+    GeoRef::ProjectionByMode projections;
+    projections[Mode_e::Walking] = ProjectionData(coord, geo_ref, geo_ref.pl);
+    projections[Mode_e::Bike] = ProjectionData(coord, geo_ref, bike_offset, geo_ref.pl);
+    BOOST_REQUIRE(projections[Mode_e::Walking].found && projections[Mode_e::Bike].found);
+    geo_ref.projected_stop_points.push_back(projections);
+
+    // the edges by layer, with the coordinates of their ends
+    using edge_ends = std::tuple<size_t, navitia::type::GeographicalCoord, navitia::type::GeographicalCoord, int>;
+    const auto edges_by_coord = [&]() {
+        std::vector<edge_ends> res;
+        for (const auto e : make_iterator_range(edges(geo_ref.graph))) {
+            const auto u = source(e, geo_ref.graph), v = target(e, geo_ref.graph);
+            BOOST_CHECK_EQUAL(u / geo_ref.nb_vertex_by_mode, v / geo_ref.nb_vertex_by_mode);
+            res.emplace_back(u / geo_ref.nb_vertex_by_mode, geo_ref.graph[u].coord, geo_ref.graph[v].coord,
+                             geo_ref.graph[e].duration.total_seconds());
+        }
+        std::sort(res.begin(), res.end());
+        return res;
+    };
+    const auto projected_coords = [&](const Mode_e mode) {
+        const auto& projection = geo_ref.projected_stop_points.front()[mode];
+        return std::make_pair(geo_ref.graph[projection[ProjectionData::Direction::Source]].coord,
+                              geo_ref.graph[projection[ProjectionData::Direction::Target]].coord);
+    };
+    const auto edges_before = edges_by_coord();
+    const auto walking_projection = projected_coords(Mode_e::Walking);
+    const auto bike_projection = projected_coords(Mode_e::Bike);
+
+    geo_ref.reorder_vertices();
+
+    BOOST_CHECK(geo_ref.graph.is_compressed());
+    BOOST_REQUIRE_EQUAL(num_vertices(geo_ref.graph), 48);
+    BOOST_CHECK(edges_by_coord() == edges_before);
+    BOOST_CHECK(projected_coords(Mode_e::Walking) == walking_projection);
+    BOOST_CHECK(projected_coords(Mode_e::Bike) == bike_projection);
+    BOOST_CHECK_EQUAL(geo_ref.graph[way->edges.front().first].coord, v6);
+    BOOST_CHECK_EQUAL(geo_ref.graph[way->edges.front().second].coord, v7);
+    BOOST_CHECK_EQUAL(geo_ref.graph[geo_ref.nearest_vertex(v7, geo_ref.pl)].coord, v7);
+
+    BOOST_CHECK(cells[geo_ref.graph[0].coord] == std::make_pair(0, 0));
+    for (vertex_t v = 1; v < num_vertices(geo_ref.graph); ++v) {
+        BOOST_CHECK_EQUAL(geo_ref.graph[v].coord, geo_ref.graph[v % 16].coord);
+        if (v % 16 == 0) {
+            continue;
+        }
+        const auto previous = cells[geo_ref.graph[v - 1].coord], current = cells[geo_ref.graph[v].coord];
+        BOOST_CHECK_EQUAL(std::abs(previous.first - current.first) + std::abs(previous.second - current.second), 1);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(nearest_segment) {
     GraphBuilder b;
 
@@ -215,3 +215,192 @@ BOOST_AUTO_TEST_CASE(astar_init) {
     BOOST_CHECK_EQUAL(worker.costs[worker.starting_edge[dir::Source]], navitia::seconds(6));
     BOOST_CHECK_EQUAL(worker.costs[worker.starting_edge[dir::Target]], bt::pos_infin);
 }
+
+/*
+ * The direct paths computed with the contraction hierarchies have the same duration
+ * as the ones computed with a full dijkstra
+ */
+BOOST_AUTO_TEST_CASE(contraction_hierarchy_direct_path) {
+    using type::Mode_e;
+    GraphBuilder b;
+    const size_t square_size = 10;
+    for (size_t i = 0; i < square_size; ++i) {
+        for (size_t j = 0; j < square_size; ++j) {
+            b(get_name(i, j), i * 100, j * 100);
+        }
+    }
+    // durations pseudo randomly distributed, different in each direction
+    std::vector<std::tuple<vertex_t, vertex_t, int>> streets;
+    int dur = 0;
+    for (size_t i = 0; i < square_size; ++i) {
+        for (size_t j = 0; j < square_size; ++j) {
+            for (const auto& next : {std::make_pair(i + 1, j), std::make_pair(i, j + 1)}) {
+                if (next.first == square_size || next.second == square_size) {
+                    continue;
+                }
+                const auto u = b.get(get_name(i, j));
+                const auto v = b.get(get_name(next.first, next.second));
+                streets.emplace_back(u, v, 10 + (dur = (dur * 7 + 13) % 90));
+                streets.emplace_back(v, u, 10 + (dur = (dur * 7 + 13) % 90));
+            }
+        }
+    }
+    for (const auto& street : streets) {
+        b.add_edge(get_name(std::get<0>(street) / square_size, std::get<0>(street) % square_size),
+                   get_name(std::get<1>(street) / square_size, std::get<1>(street) % square_size),
+                   navitia::seconds(std::get<2>(street)));
+    }
+    b.geo_ref.init();
+    // the same streets for the bike and the car, faster, and parkings on the diagonal
+    for (const auto mode : {Mode_e::Bike, Mode_e::Car}) {
+        const auto offset = b.geo_ref.offsets[mode];
+        for (const auto& street : streets) {
+            boost::add_edge(std::get<0>(street) + offset, std::get<1>(street) + offset,
+                            Edge(type::invalid_idx, navitia::seconds(std::get<2>(street) / 2)), b.geo_ref.graph);
+        }
+    }
+    for (size_t i = 0; i < square_size; ++i) {
+        const auto v = b.get(get_name(i, i));
+        boost::add_edge(v, v + b.geo_ref.offsets[Mode_e::Car], Edge(type::invalid_idx, 30_s), b.geo_ref.graph);
+        boost::add_edge(v + b.geo_ref.offsets[Mode_e::Car], v, Edge(type::invalid_idx, 30_s), b.geo_ref.graph);
+    }
+    b.geo_ref.build_proximity_list();
+    b.geo_ref.build_contraction_hierarchies();
+
+    BOOST_REQUIRE(!b.geo_ref.contraction_hierarchies[Mode_e::Car].empty());
+    BOOST_REQUIRE(!b.geo_ref.contraction_hierarchies[Mode_e::Bike].empty());
+    BOOST_CHECK(b.geo_ref.contraction_hierarchies[Mode_e::Walking].empty());
+
+    StreetNetwork worker(b.geo_ref);
+    DijkstraPathFinder dijkstra(b.geo_ref);
+    size_t nb_paths = 0;
+    for (const auto mode : {Mode_e::Bike, Mode_e::Car}) {
+        for (const float speed_factor : {1.f, 2.f}) {
+            for (int k = 0; k < 20; ++k) {
+                type::EntryPoint origin, destination;
+                origin.coordinates.set_xy((k * 137) % 900 + 10, (k * 291) % 900 + 20);
+                destination.coordinates.set_xy((k * 353) % 900 + 30, (k * 71) % 900 + 40);
+                origin.streetnetwork_params.mode = mode;
+                origin.streetnetwork_params.speed_factor = speed_factor;
+                origin.streetnetwork_params.max_duration = 2_h;
+                destination.streetnetwork_params.max_duration = 2_h;
+
+                const auto path = worker.get_direct_path(origin, destination);
+
+                const auto dest_mode = mode == Mode_e::Car ? Mode_e::Walking : mode;
+                const ProjectionData dest(destination.coordinates, b.geo_ref, b.geo_ref.offsets[dest_mode],
+                                          b.geo_ref.pl);
+                dijkstra.init(origin.coordinates, mode, speed_factor);
+                dijkstra.start_distance_dijkstra(2_h);
+                const auto expected = dijkstra.get_path(dest, dijkstra.update_path(dest));
+
+                BOOST_REQUIRE(!expected.path_items.empty());
+                BOOST_REQUIRE(!path.path_items.empty());
+                BOOST_CHECK_EQUAL(path.duration, expected.duration);
+                ++nb_paths;
+            }
+        }
+    }
+    BOOST_CHECK_EQUAL(nb_paths, 80);
+}
+
+/*
+ * The durations of the matrix, computed in several threads, are the ones of a dijkstra from each origin,
+ * in the order of the destinations
+ */
+BOOST_AUTO_TEST_CASE(duration_matrix) {
+    GraphBuilder b;
+    type::Data data;
+    build_data(b, data);
+
+    std::vector<type::EntryPoint> origins;
+    for (const auto& xy : {std::make_pair(2., 2.), std::make_pair(5., 1.), std::make_pair(0., 7.),
+                           std::make_pair(8., 8.), std::make_pair(3., 6.)}) {
+        type::EntryPoint origin;
+        origin.coordinates.set_xy(xy.first, xy.second);
+        origin.streetnetwork_params.mode = type::Mode_e::Walking;
+        origin.streetnetwork_params.speed_factor = 1;
+        origins.push_back(origin);
+    }
+    std::vector<type::GeographicalCoord> destinations(4);
+    destinations[0].set_xy(8., 8.);
+    destinations[1].set_xy(1., 4.);
+    destinations[2].set_xy(100000., 100000.);  // too far to be projected
+    destinations[3].set_xy(8., 8.);
+
+    StreetNetwork worker(b.geo_ref);
+    worker.nb_matrix_threads = 3;
+    const auto matrix = worker.get_duration_matrix(origins, destinations, 2_h);
+
+    BOOST_REQUIRE_EQUAL(matrix.size(), origins.size());
+    DijkstraPathFinder dijkstra(b.geo_ref);
+    const auto projections = DijkstraPathFinder::project_destinations(b.geo_ref, type::Mode_e::Walking, destinations);
+    for (size_t i = 0; i < origins.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(matrix[i].size(), destinations.size());
+        dijkstra.init(origins[i].coordinates, type::Mode_e::Walking, 1);
+        const auto expected = dijkstra.get_duration_with_dijkstra(2_h, projections);
+        for (const size_t j : {0, 1, 3}) {
+            BOOST_CHECK(matrix[i][j].routing_status == RoutingStatus_e::reached);
+            BOOST_CHECK_EQUAL(matrix[i][j].time_duration, expected[j].time_duration);
+        }
+        BOOST_CHECK(matrix[i][2].routing_status == RoutingStatus_e::unknown);
+        BOOST_CHECK_EQUAL(matrix[i][0].time_duration, matrix[i][3].time_duration);
+    }
+}
+
+/*
+ * The radix heap gives the same durations as the d-ary heap, for all the vertices within the radius
+ */
+BOOST_AUTO_TEST_CASE(radix_heap_dijkstra) {
+    using type::Mode_e;
+    GraphBuilder b;
+    const size_t square_size = 20;
+    for (size_t i = 0; i < square_size; ++i) {
+        for (size_t j = 0; j < square_size; ++j) {
+            b(get_name(i, j), i * 100, j * 100);
+        }
+    }
+    // durations pseudo randomly distributed, different in each direction, with some equal paths
+    int dur = 0;
+    for (size_t i = 0; i < square_size; ++i) {
+        for (size_t j = 0; j < square_size; ++j) {
+            for (const auto& next : {std::make_pair(i + 1, j), std::make_pair(i, j + 1)}) {
+                if (next.first == square_size || next.second == square_size) {
+                    continue;
+                }
+                b.add_edge(get_name(i, j), get_name(next.first, next.second),
+                           navitia::seconds(10 + (dur = (dur * 7 + 13) % 90) % 30));
+                b.add_edge(get_name(next.first, next.second), get_name(i, j),
+                           navitia::seconds(10 + (dur = (dur * 7 + 13) % 90) % 30));
+            }
+        }
+    }
+    b.geo_ref.init();
+    b.geo_ref.build_proximity_list();
+
+    DijkstraPathFinder heap_dijkstra(b.geo_ref);
+    DijkstraPathFinder radix_dijkstra(b.geo_ref);
+    radix_dijkstra.radix_heap_by_mode[Mode_e::Walking] = true;
+    size_t nb_reached = 0;
+    for (const float speed_factor : {1.f, 1.3f}) {
+        for (const auto radius : {navitia::seconds(150), 2_h}) {
+            for (int k = 0; k < 10; ++k) {
+                type::GeographicalCoord start;
+                start.set_xy((k * 137) % 1900 + 10, (k * 291) % 1900 + 20);
+                heap_dijkstra.init(start, Mode_e::Walking, speed_factor);
+                heap_dijkstra.start_distance_dijkstra(radius);
+                radix_dijkstra.init(start, Mode_e::Walking, speed_factor);
+                radix_dijkstra.start_distance_dijkstra(radius);
+
+                BOOST_REQUIRE_EQUAL(heap_dijkstra.distances.size(), radix_dijkstra.distances.size());
+                for (size_t v = 0; v < heap_dijkstra.distances.size(); ++v) {
+                    if (heap_dijkstra.distances[v] <= radius || radix_dijkstra.distances[v] <= radius) {
+                        BOOST_CHECK_EQUAL(heap_dijkstra.distances[v], radix_dijkstra.distances[v]);
+                        ++nb_reached;
+                    }
+                }
+            }
+        }
+    }
+    BOOST_CHECK_GT(nb_reached, 8000);
+}
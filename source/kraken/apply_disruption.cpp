@@ -622,12 +622,14 @@ struct delete_impacts_visitor : public apply_impacts_visitor {
             // We re-activate base vj for every realtime level by reseting base vj's vp to base
             vj->validity_patterns[type::RTLevel::RealTime] = vj->validity_patterns[type::RTLevel::Adapted] =
                 vj->validity_patterns[type::RTLevel::Base];
+            pt_data.vj_delta.modified.insert(vj->uri);
         }
         auto* empty_vp_ptr = pt_data.get_or_create_validity_pattern({meta.production_date.begin()});
 
-        auto set_empty_vp = [empty_vp_ptr](const std::unique_ptr<type::VehicleJourney>& vj) {
+        auto set_empty_vp = [&](const std::unique_ptr<type::VehicleJourney>& vj) {
             vj->validity_patterns[type::RTLevel::RealTime] = vj->validity_patterns[type::RTLevel::Adapted] =
                 vj->validity_patterns[type::RTLevel::Base] = empty_vp_ptr;
+            pt_data.vj_delta.modified.insert(vj->uri);
         };
         // We deactivate adapted/realtime vj by setting vp to empty vp
         boost::for_each(mvj->get_adapted_vj(), set_empty_vp);
@@ -739,10 +741,13 @@ void delete_disruption(const std::string& disruption_id, nt::PT_Data& pt_data, c
     LOG4CPLUS_DEBUG(log, "Deleting disruption: " << disruption_id);
 
     nt::disruption::DisruptionHolder& holder = pt_data.disruption_holder;
+    // the messages of the objects change, their cached protobuf with them
+    pt_data.pb_fragment_cache.clear();
 
     // the disruption is deleted by RAII
     if (auto disruption = holder.pop_disruption(disruption_id)) {
         for (const auto& impact : disruption->get_impacts()) {
+            pt_data.impact_index.remove(impact);
             delete_impact(impact, pt_data, meta);
         }
     }
@@ -754,7 +759,9 @@ void apply_disruption(const type::disruption::Disruption& disruption,
                       nt::PT_Data& pt_data,
                       const navitia::type::MetaData& meta) {
     LOG4CPLUS_DEBUG(log4cplus::Logger::getInstance("log"), "applying disruption: " << disruption.uri);
+    pt_data.pb_fragment_cache.clear();
     for (const auto& impact : disruption.get_impacts()) {
+        pt_data.impact_index.add(impact);
         apply_impact(impact, pt_data, meta);
     }
 }
@@ -75,6 +75,16 @@ po::options_description get_options_description(const boost::optional<std::strin
              po::value<bool>()->default_value(*display_contributors) : po::value<bool>()->default_value(false),
          "display all contributors in feed publishers")
         ("GENERAL.raptor_cache_size", po::value<int>()->default_value(10), "maximum number of stored raptor caches")
+        ("GENERAL.nb_range_raptor_threads", po::value<int>()->default_value(1),
+                                  "number of threads splitting the departure time window of a journeys request with a timeframe_duration")
+        ("GENERAL.nb_matrix_threads", po::value<int>()->default_value(1),
+                                  "number of threads sharing the origins of a street network routing matrix")
+        ("GENERAL.nb_isochrone_threads", po::value<int>()->default_value(1),
+                                  "number of threads rasterizing graphical isochrones")
+        ("GENERAL.nb_heat_map_threads", po::value<int>()->default_value(1),
+                                  "number of threads filling the cells of a heat map")
+        ("GENERAL.radix_heap_modes", po::value<std::vector<std::string>>(),
+                                  "list of the street network modes (walking, bike, car...) whose dijkstra uses a radix heap")
         ("GENERAL.log_level", po::value<std::string>(), "log level of kraken")
         ("GENERAL.log_format", po::value<std::string>()->default_value("[%D{%y-%m-%d %H:%M:%S,%q}] [%p] [%x] - %m %b:%L  %n"), "log format")
 
@@ -256,6 +266,57 @@ size_t Configuration::raptor_cache_size() const {
     return size_t(raptor_cache_size);
 }
 
+size_t Configuration::nb_range_raptor_threads() const {
+    if (!vm.count("GENERAL.nb_range_raptor_threads")) {
+        return 1;
+    }
+    int nb_range_raptor_threads = vm["GENERAL.nb_range_raptor_threads"].as<int>();
+    if (nb_range_raptor_threads < 1) {
+        throw std::invalid_argument("nb_range_raptor_threads must be strictly positive");
+    }
+    return size_t(nb_range_raptor_threads);
+}
+
+size_t Configuration::nb_matrix_threads() const {
+    if (!vm.count("GENERAL.nb_matrix_threads")) {
+        return 1;
+    }
+    int nb_matrix_threads = vm["GENERAL.nb_matrix_threads"].as<int>();
+    if (nb_matrix_threads < 1) {
+        throw std::invalid_argument("nb_matrix_threads must be strictly positive");
+    }
+    return size_t(nb_matrix_threads);
+}
+
+size_t Configuration::nb_isochrone_threads() const {
+    if (!vm.count("GENERAL.nb_isochrone_threads")) {
+        return 1;
+    }
+    int nb_isochrone_threads = vm["GENERAL.nb_isochrone_threads"].as<int>();
+    if (nb_isochrone_threads < 1) {
+        throw std::invalid_argument("nb_isochrone_threads must be strictly positive");
+    }
+    return size_t(nb_isochrone_threads);
+}
+
+size_t Configuration::nb_heat_map_threads() const {
+    if (!vm.count("GENERAL.nb_heat_map_threads")) {
+        return 1;
+    }
+    int nb_heat_map_threads = vm["GENERAL.nb_heat_map_threads"].as<int>();
+    if (nb_heat_map_threads < 1) {
+        throw std::invalid_argument("nb_heat_map_threads must be strictly positive");
+    }
+    return size_t(nb_heat_map_threads);
+}
+
+std::vector<std::string> Configuration::radix_heap_modes() const {
+    if (!this->vm.count("GENERAL.radix_heap_modes")) {
+        return std::vector<std::string>();
+    }
+    return this->vm["GENERAL.radix_heap_modes"].as<std::vector<std::string>>();
+}
+
 boost::optional<std::string> Configuration::log_level() const {
     boost::optional<std::string> result;
     if (this->vm.count("GENERAL.log_level") > 0) {
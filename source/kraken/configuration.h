@@ -67,6 +67,11 @@ public:
     int kirin_retry_timeout() const;
     bool display_contributors() const;
     size_t raptor_cache_size() const;
+    size_t nb_range_raptor_threads() const;
+    size_t nb_matrix_threads() const;
+    size_t nb_isochrone_threads() const;
+    size_t nb_heat_map_threads() const;
+    std::vector<std::string> radix_heap_modes() const;
     int slow_request_duration() const;
     boost::optional<std::string> log_level() const;
     boost::optional<std::string> log_format() const;
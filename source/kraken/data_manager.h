@@ -137,6 +137,7 @@ public:
 
         // Build Raptor Data
         data->build_raptor(raptor_cache_size);
+        data->load_next_st_snapshots(filename);
         data->loading = false;
 
         // Set data
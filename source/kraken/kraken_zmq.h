@@ -39,23 +39,30 @@ www.navitia.io
 #include "type/meta_data.h"
 #include <log4cplus/ndc.h>
 #include "metrics.h"
+#include "response_buffer_pool.h"
 
 #include "utils/deadline.h"
 #include <boost/optional/optional_io.hpp>
 
-static void respond(zmq::socket_t& socket, const std::string& address, const pbnavitia::Response& response) {
-    zmq::message_t reply(response.ByteSize());
+static void respond(zmq::socket_t& socket,
+                    const std::string& address,
+                    const pbnavitia::Response& response,
+                    navitia::ResponseBufferPool& buffer_pool,
+                    const navitia::Metrics& metrics) {
+    const auto start = boost::posix_time::microsec_clock::universal_time();
+    zmq::message_t reply;
     try {
-        response.SerializeToArray(reply.data(), response.ByteSize());
+        reply = buffer_pool.serialize(response);
     } catch (const google::protobuf::FatalException& e) {
         auto logger = log4cplus::Logger::getInstance("worker");
         LOG4CPLUS_ERROR(logger, "failure during serialization: " << e.what());
         pbnavitia::Response error_response;
         error_response.mutable_error()->set_id(pbnavitia::Error::internal_error);
         error_response.mutable_error()->set_message(e.what());
-        reply.rebuild(error_response.ByteSize());
-        error_response.SerializeToArray(reply.data(), error_response.ByteSize());
+        reply = buffer_pool.serialize(error_response);
     }
+    const auto duration = boost::posix_time::microsec_clock::universal_time() - start;
+    metrics.observe_serialization(duration.total_microseconds() / 1000000.0);
     z_send(socket, address, ZMQ_SNDMORE);
     z_send(socket, "", ZMQ_SNDMORE);
     socket.send(reply);
@@ -74,6 +81,7 @@ inline void doWork(zmq::context_t& context,
     auto enable_deadline = conf.enable_request_deadline();
     // Here we create the worker
     navitia::Worker w(conf);
+    auto buffer_pool = std::make_shared<navitia::ResponseBufferPool>(metrics);
     z_send(socket, "READY");
     auto slow_request_duration = pt::milliseconds(conf.slow_request_duration());
     while (run) {
@@ -100,7 +108,7 @@ inline void doWork(zmq::context_t& context,
             auto* error = response.mutable_error();
             error->set_id(pbnavitia::Error::invalid_protobuf_request);
             error->set_message("receive invalid protobuf");
-            respond(socket, address, response);
+            respond(socket, address, response, *buffer_pool, metrics);
             continue;
         }
 
@@ -143,7 +151,7 @@ inline void doWork(zmq::context_t& context,
         } else {
             w.pb_creator.set_publication_date(data->meta->publication_date);
         }
-        respond(socket, address, w.pb_creator.get_response());
+        respond(socket, address, w.pb_creator.get_response(), *buffer_pool, metrics);
         auto duration = pt::microsec_clock::universal_time() - start;
         metrics.observe_api(api, duration.total_milliseconds() / 1000.0);
         if (duration >= slow_request_duration) {
@@ -196,13 +196,15 @@ void MaintenanceWorker::handle_rt_in_batch(const std::vector<AmqpClient::Envelop
         }
     }
     if (data) {
-        LOG4CPLUS_INFO(logger, "rebuilding autocomplete");
-        data->build_autocomplete();
+        LOG4CPLUS_INFO(logger, "updating autocomplete");
+        // the georef is shared with the current data, only the pt objects may have been added
+        data->update_pt_autocomplete();
         LOG4CPLUS_INFO(logger, "cleaning weak impacts");
         data->pt_data->clean_weak_impacts();
         LOG4CPLUS_INFO(logger, "rebuilding data raptor");
-        data->build_raptor(conf.raptor_cache_size());
-        data->warmup(*data_manager.get_data());
+        const auto current_data = data_manager.get_data();
+        data->update_raptor(*current_data, conf.raptor_cache_size());
+        data->warmup(*current_data);
         data->set_last_rt_data_loaded(pt::microsec_clock::universal_time());
         data_manager.set_data(std::move(data));
         auto duration = pt::microsec_clock::universal_time() - begin;
@@ -126,6 +126,20 @@ Metrics::Metrics(const boost::optional<std::string>& endpoint, const std::string
                                      .Labels({{"coverage", coverage}})
                                      .Register(*registry)
                                      .Add({}, create_exponential_buckets(1, 2, 10));
+
+    this->serialization_histogram = &prometheus::BuildHistogram()
+                                         .Name("kraken_response_serialization_duration_seconds")
+                                         .Help("duration of the serialization of the response")
+                                         .Labels({{"coverage", coverage}})
+                                         .Register(*registry)
+                                         .Add({}, create_exponential_buckets(0.0001, 2, 14));
+
+    this->response_buffer_allocations = &prometheus::BuildCounter()
+                                             .Name("kraken_response_buffer_allocations_total")
+                                             .Help("number of buffers allocated to serialize the responses")
+                                             .Labels({{"coverage", coverage}})
+                                             .Register(*registry)
+                                             .Add({});
 }
 
 InFlightGuard Metrics::start_in_flight() const {
@@ -169,4 +183,18 @@ void Metrics::observe_handle_rt(double duration) const {
     this->handle_rt_histogram->Observe(duration);
 }
 
+void Metrics::observe_serialization(double duration) const {
+    if (!registry) {
+        return;
+    }
+    this->serialization_histogram->Observe(duration);
+}
+
+void Metrics::add_response_buffer_allocation() const {
+    if (!registry) {
+        return;
+    }
+    this->response_buffer_allocations->Increment();
+}
+
 }  // namespace navitia
@@ -72,6 +72,8 @@ protected:
     prometheus::Histogram* data_loading_histogram;
     prometheus::Histogram* data_cloning_histogram;
     prometheus::Histogram* handle_rt_histogram;
+    prometheus::Histogram* serialization_histogram;
+    prometheus::Counter* response_buffer_allocations;
 
 public:
     Metrics(const boost::optional<std::string>& endpoint, const std::string& coverage);
@@ -81,6 +83,8 @@ public:
     void observe_data_loading(double duration) const;
     void observe_data_cloning(double duration) const;
     void observe_handle_rt(double duration) const;
+    void observe_serialization(double duration) const;
+    void add_response_buffer_allocation() const;
 };
 
 }  // namespace navitia
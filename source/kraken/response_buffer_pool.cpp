@@ -0,0 +1,104 @@
+/* Copyright © 2001-2018, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "response_buffer_pool.h"
+
+#include <algorithm>
+
+namespace navitia {
+
+ResponseBufferPool::ResponseBufferPool(const Metrics& metrics, size_t max_free_buffers)
+    : metrics(metrics), max_free_buffers(max_free_buffers) {}
+
+zmq::message_t ResponseBufferPool::serialize(const google::protobuf::MessageLite& message) {
+    const size_t size = message.ByteSizeLong();
+    auto buffer = acquire(size);
+    message.SerializeWithCachedSizesToArray(reinterpret_cast<uint8_t*>(buffer->data.get()));
+    zmq::message_t reply(buffer->data.get(), size, &ResponseBufferPool::release, buffer.get());
+    // from now on zmq owns the buffer, until it calls release
+    buffer.release();
+    return reply;
+}
+
+size_t ResponseBufferPool::nb_free_buffers() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return free_buffers.size();
+}
+
+std::unique_ptr<ResponseBufferPool::Buffer> ResponseBufferPool::acquire(size_t size) {
+    std::unique_ptr<Buffer> buffer;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = std::find_if(free_buffers.begin(), free_buffers.end(),
+                               [&](const std::unique_ptr<Buffer>& b) { return b->capacity >= size; });
+        if (it == free_buffers.end() && !free_buffers.empty()) {
+            // none is big enough, the biggest one will be grown
+            it = std::max_element(free_buffers.begin(), free_buffers.end(),
+                                  [](const std::unique_ptr<Buffer>& a, const std::unique_ptr<Buffer>& b) {
+                                      return a->capacity < b->capacity;
+                                  });
+        }
+        if (it != free_buffers.end()) {
+            buffer = std::move(*it);
+            free_buffers.erase(it);
+        }
+    }
+    if (!buffer) {
+        buffer = std::make_unique<Buffer>();
+        buffer->pool = shared_from_this();
+    }
+    if (buffer->capacity < size) {
+        // we round to the next power of 2 so that a slightly bigger response can reuse the buffer
+        size_t capacity = 4096;
+        while (capacity < size) {
+            capacity *= 2;
+        }
+        buffer->data.reset(new char[capacity]);
+        buffer->capacity = capacity;
+        metrics.add_response_buffer_allocation();
+    }
+    return buffer;
+}
+
+void ResponseBufferPool::give_back(std::unique_ptr<Buffer> buffer) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (free_buffers.size() < max_free_buffers) {
+        free_buffers.push_back(std::move(buffer));
+    }
+}
+
+void ResponseBufferPool::release(void*, void* hint) {
+    std::unique_ptr<Buffer> buffer(static_cast<Buffer*>(hint));
+    if (auto pool = buffer->pool.lock()) {
+        pool->give_back(std::move(buffer));
+    }
+}
+
+}  // namespace navitia
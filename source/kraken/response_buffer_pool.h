@@ -0,0 +1,78 @@
+/* Copyright © 2001-2018, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include "metrics.h"
+
+#include <google/protobuf/message_lite.h>
+#include <zmq.hpp>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace navitia {
+
+/*
+ * Recycles the buffers in which the responses are serialized.
+ *
+ * The buffer is handed to zmq without copy, zmq gives it back through a callback once the
+ * message is sent, possibly from one of its own threads.
+ * The buffers still in flight when the pool is destroyed are simply freed.
+ * The pool must be owned by a std::shared_ptr.
+ */
+class ResponseBufferPool : public std::enable_shared_from_this<ResponseBufferPool> {
+public:
+    explicit ResponseBufferPool(const Metrics& metrics, size_t max_free_buffers = 4);
+
+    // the size of the message is computed only once
+    zmq::message_t serialize(const google::protobuf::MessageLite& message);
+
+    size_t nb_free_buffers() const;
+
+private:
+    struct Buffer {
+        std::unique_ptr<char[]> data;
+        size_t capacity = 0;
+        std::weak_ptr<ResponseBufferPool> pool;
+    };
+
+    std::unique_ptr<Buffer> acquire(size_t size);
+    void give_back(std::unique_ptr<Buffer> buffer);
+    static void release(void* data, void* hint);
+
+    const Metrics& metrics;
+    const size_t max_free_buffers;
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Buffer>> free_buffers;
+};
+
+}  // namespace navitia
@@ -44,6 +44,7 @@ public:
     void load_nav(const std::string&) {}
     void load_disruptions(const std::string&, const std::vector<std::string>& = {}) {}
     void build_raptor(size_t) {}
+    void load_next_st_snapshots(const std::string&) {}
     void build_autocomplete() {}
     mutable std::atomic<bool> loading;
     mutable std::atomic<bool> is_connected_to_rabbitmq;
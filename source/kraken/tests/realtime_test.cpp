@@ -3493,3 +3493,112 @@ BOOST_FIXTURE_TEST_CASE(cannot_add_new_trip_if_id_corresponds_to_a_base_VJ_the_s
     BOOST_CHECK_EQUAL(res.response_type(), pbnavitia::NO_SOLUTION);
     BOOST_CHECK_EQUAL(res.impacts_size(), 0);
 }
+
+// The journey patterns can be numbered differently, thus they are compared through their vehicle journeys
+static void check_same_data_raptor(const nt::PT_Data& pt_data,
+                                   const navitia::routing::dataRAPTOR& incremental,
+                                   const navitia::routing::dataRAPTOR& full) {
+    namespace nr = navitia::routing;
+    auto vj_uris = [](const nr::JourneyPattern& jp) {
+        std::set<std::string> uris;
+        jp.for_each_vehicle_journey([&](const nt::VehicleJourney& vj) {
+            uris.insert(vj.uri);
+            return true;
+        });
+        return uris;
+    };
+    auto stop_times = [](const nr::NextStopTimeData::StopTimeIter& range) {
+        return std::vector<const nt::StopTime*>(range.begin(), range.end());
+    };
+
+    for (const auto* vj : pt_data.vehicle_journeys) {
+        const auto inc_jp_idx = incremental.jp_container.get_jp_from_vj()[nr::VjIdx(*vj)];
+        const auto full_jp_idx = full.jp_container.get_jp_from_vj()[nr::VjIdx(*vj)];
+        const auto& inc_jp = incremental.jp_container.get(inc_jp_idx);
+        const auto& full_jp = full.jp_container.get(full_jp_idx);
+        BOOST_CHECK_EQUAL_RANGE(vj_uris(inc_jp), vj_uris(full_jp));
+
+        BOOST_REQUIRE_EQUAL(inc_jp.jpps.size(), full_jp.jpps.size());
+        BOOST_REQUIRE_EQUAL(incremental.jpps_from_jp[inc_jp_idx].size(), full.jpps_from_jp[full_jp_idx].size());
+        for (size_t i = 0; i < inc_jp.jpps.size(); ++i) {
+            BOOST_CHECK_EQUAL(incremental.jpps_from_jp[inc_jp_idx][i].sp_idx, full.jpps_from_jp[full_jp_idx][i].sp_idx);
+            for (const auto stop_event : {nr::StopEvent::pick_up, nr::StopEvent::drop_off}) {
+                BOOST_CHECK_EQUAL_RANGE(
+                    stop_times(incremental.next_stop_time_data.stop_time_range_forward(inc_jp.jpps[i], stop_event)),
+                    stop_times(full.next_stop_time_data.stop_time_range_forward(full_jp.jpps[i], stop_event)));
+            }
+        }
+
+        for (const auto& st : vj->stop_time_list) {
+            const auto inc_pos = incremental.jp_timetables.st_pos(st);
+            const auto full_pos = full.jp_timetables.st_pos(st);
+            for (const bool clockwise : {true, false}) {
+                BOOST_CHECK_EQUAL(incremental.jp_timetables.section_end(inc_pos, 0, clockwise),
+                                  full.jp_timetables.section_end(full_pos, 0, clockwise));
+            }
+        }
+
+        for (const auto level : navitia::enum_range<nt::RTLevel>()) {
+            for (size_t day = 0; day < 366; ++day) {
+                BOOST_CHECK_EQUAL(incremental.jp_validity_patterns[level][day][inc_jp_idx.val],
+                                  full.jp_validity_patterns[level][day][full_jp_idx.val]);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(incremental_data_raptor_equals_full_load) {
+    ed::builder b("20150928");
+    b.vj("A", "000111", "", true, "vj:1")("stop1", "08:01"_t)("stop2", "09:01"_t)("stop3", "10:01"_t);
+    b.vj("A", "000111", "", true, "vj:2")("stop1", "09:01"_t)("stop2", "10:01"_t)("stop3", "11:01"_t);
+    b.vj("B", "000111", "", true, "vj:3")("stop4", "08:01"_t)("stop2", "08:31"_t);
+    b.vj("C", "000111", "", true, "vj:4")("stop3", "12:01"_t)("stop4", "13:01"_t);
+    b.data->build_uri();
+    b.finalize_disruption_batch();
+
+    // first batch on a clone: a delay and a cancellation
+    nt::Data first;
+    first.clone_from(*b.data);
+    BOOST_CHECK(first.pt_data->vj_delta.empty());
+    navitia::handle_realtime(
+        "delay", timestamp,
+        ntest::make_trip_update_message("vj:1", "20150928",
+                                        {RTStopTime("stop1", "20150928T0810"_pts).delay(9_min),
+                                         RTStopTime("stop2", "20150928T0910"_pts).delay(9_min),
+                                         RTStopTime("stop3", "20150928T1010"_pts).delay(9_min)}),
+        first, true, true);
+    navitia::handle_realtime("cancel", timestamp, make_cancellation_message("vj:3", "20150929"), first, true, true);
+    BOOST_CHECK_EQUAL(first.pt_data->vj_delta.added.size(), 1);
+    BOOST_CHECK(first.pt_data->vj_delta.modified.count("vj:1"));
+    BOOST_CHECK(first.pt_data->vj_delta.modified.count("vj:3"));
+
+    first.update_raptor(*b.data, 1);
+    BOOST_CHECK(first.pt_data->vj_delta.empty());
+    navitia::routing::dataRAPTOR full;
+    full.load(*first.pt_data, 1);
+    check_same_data_raptor(*first.pt_data, *first.dataRaptor, full);
+
+    // second batch, from the first one: the delay changes, the previous
+    // realtime vj is thus removed and replaced
+    nt::Data second;
+    second.clone_from(first);
+    navitia::handle_realtime(
+        "delay", timestamp,
+        ntest::make_trip_update_message("vj:1", "20150928",
+                                        {RTStopTime("stop1", "20150928T0830"_pts).delay(29_min),
+                                         RTStopTime("stop2", "20150928T0930"_pts).delay(29_min),
+                                         RTStopTime("stop3", "20150928T1030"_pts).delay(29_min)}),
+        second, true, true);
+    BOOST_CHECK_EQUAL(second.pt_data->vj_delta.removed.size(), 1);
+    BOOST_CHECK_EQUAL(second.pt_data->vj_delta.added.size(), 1);
+
+    second.update_raptor(first, 1);
+    full.load(*second.pt_data, 1);
+    check_same_data_raptor(*second.pt_data, *second.dataRaptor, full);
+
+    navitia::routing::RAPTOR raptor(second);
+    auto res = raptor.compute(second.pt_data->stop_areas_map.at("stop1"), second.pt_data->stop_areas_map.at("stop3"),
+                              "08:00"_t, 0, navitia::DateTimeUtils::inf, nt::RTLevel::RealTime, 2_min, true);
+    BOOST_REQUIRE_EQUAL(res.size(), 1);
+    BOOST_CHECK_EQUAL(res[0].items[0].arrival, "20150928T1030"_dt);
+}
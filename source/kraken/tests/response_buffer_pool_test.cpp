@@ -0,0 +1,94 @@
+/* Copyright © 2001-2018, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE response_buffer_pool_test
+
+#include "kraken/response_buffer_pool.h"
+#include "type/response.pb.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(serialize_round_trip) {
+    const navitia::Metrics metrics(boost::none, "test");
+    auto pool = std::make_shared<navitia::ResponseBufferPool>(metrics);
+
+    pbnavitia::Response response;
+    response.mutable_error()->set_id(pbnavitia::Error::internal_error);
+    response.mutable_error()->set_message("some error");
+
+    zmq::message_t reply = pool->serialize(response);
+    pbnavitia::Response parsed;
+    BOOST_REQUIRE(parsed.ParseFromArray(reply.data(), reply.size()));
+    BOOST_CHECK_EQUAL(parsed.error().id(), pbnavitia::Error::internal_error);
+    BOOST_CHECK_EQUAL(parsed.error().message(), "some error");
+}
+
+BOOST_AUTO_TEST_CASE(buffers_are_recycled) {
+    const navitia::Metrics metrics(boost::none, "test");
+    auto pool = std::make_shared<navitia::ResponseBufferPool>(metrics, 2);
+    pbnavitia::Response response;
+    response.mutable_error()->set_message(std::string(10000, 'a'));
+
+    const void* first_data = nullptr;
+    {
+        zmq::message_t reply = pool->serialize(response);
+        first_data = reply.data();
+        BOOST_CHECK_EQUAL(pool->nb_free_buffers(), 0);
+    }
+    // zmq released the buffer with the message
+    BOOST_CHECK_EQUAL(pool->nb_free_buffers(), 1);
+    {
+        response.mutable_error()->set_message(std::string(100, 'a'));
+        zmq::message_t reply = pool->serialize(response);
+        BOOST_CHECK_EQUAL(reply.data(), first_data);
+        BOOST_CHECK_EQUAL(pool->nb_free_buffers(), 0);
+    }
+
+    // no more than max_free_buffers are kept
+    {
+        zmq::message_t r1 = pool->serialize(response);
+        zmq::message_t r2 = pool->serialize(response);
+        zmq::message_t r3 = pool->serialize(response);
+    }
+    BOOST_CHECK_EQUAL(pool->nb_free_buffers(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(message_outlives_pool) {
+    const navitia::Metrics metrics(boost::none, "test");
+    auto pool = std::make_shared<navitia::ResponseBufferPool>(metrics);
+    pbnavitia::Response response;
+    response.mutable_error()->set_message("some error");
+
+    zmq::message_t reply = pool->serialize(response);
+    pool.reset();
+    pbnavitia::Response parsed;
+    BOOST_REQUIRE(parsed.ParseFromArray(reply.data(), reply.size()));
+    BOOST_CHECK_EQUAL(parsed.error().message(), "some error");
+}
@@ -371,7 +371,14 @@ void Worker::init_worker_data(const navitia::type::Data* data,
     //@TODO should be done in data_manager
     if (data->data_identifier != this->last_data_identifier || !planner) {
         planner = std::make_unique<routing::RAPTOR>(*data);
+        planner->nb_range_threads = conf.nb_range_raptor_threads();
+        planner->nb_isochrone_threads = conf.nb_isochrone_threads();
+        planner->nb_heat_map_threads = conf.nb_heat_map_threads();
         street_network_worker = std::make_unique<georef::StreetNetwork>(*data->geo_ref);
+        street_network_worker->nb_matrix_threads = conf.nb_matrix_threads();
+        for (const auto& mode : conf.radix_heap_modes()) {
+            street_network_worker->use_radix_heap(type::static_data::get()->modeByCaption(mode));
+        }
         this->last_data_identifier = data->data_identifier;
         LOG4CPLUS_INFO(logger, "Instanciate planner");
     }
@@ -937,32 +944,26 @@ void Worker::street_network_routing_matrix(const pbnavitia::StreetNetworkRouting
         }
     }
 
+    std::vector<type::EntryPoint> origins;
     for (const auto& origin : request.origins()) {
-        type::EntryPoint entry_point;
         try {
-            entry_point =
-                make_sn_entry_point(origin.place(), request.mode(), request.speed(), request.max_duration(), *data);
+            origins.push_back(
+                make_sn_entry_point(origin.place(), request.mode(), request.speed(), request.max_duration(), *data));
         } catch (const navitia::coord_conversion_exception& e) {
             this->pb_creator.fill_pb_error(pbnavitia::Error::bad_format, e.what());
             return;
         }
+    }
 
-        street_network_worker->departure_path_finder.init(entry_point.coordinates,
-                                                          entry_point.streetnetwork_params.mode,
-                                                          entry_point.streetnetwork_params.speed_factor);
-        auto nearest = street_network_worker->departure_path_finder.get_duration_with_dijkstra(
-            navitia::time_duration::from_boost_duration(boost::posix_time::seconds(request.max_duration())),
-            dest_coords);
+    const auto matrix = street_network_worker->get_duration_matrix(
+        origins, dest_coords, navitia::seconds(request.max_duration()));
 
+    for (const auto& durations : matrix) {
         auto* row = this->pb_creator.mutable_sn_routing_matrix()->add_rows();
-        for (auto coord : dest_coords) {
+        for (const auto& duration : durations) {
             auto* k = row->add_routing_response();
-            auto it = nearest.find(coord.uri());
-            if (it == nearest.end()) {
-                throw navitia::recoverable_exception("Cannot find object: " + coord.uri());
-            }
-            k->set_duration(it->second.time_duration.total_seconds());
-            switch (it->second.routing_status) {
+            k->set_duration(duration.time_duration.total_seconds());
+            switch (duration.routing_status) {
                 case georef::RoutingStatus_e::reached:
                     k->set_routing_status(pbnavitia::RoutingStatus::reached);
                     break;
@@ -37,8 +37,81 @@ www.navitia.io
 #include <boost/iostreams/write.hpp>
 #include <boost/iostreams/read.hpp>
 #include <boost/cstdint.hpp>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
-typedef std::exception LZ4Exception;
+struct LZ4Exception : public std::runtime_error {
+    LZ4Exception() : std::runtime_error("lz4 error") {}
+    explicit LZ4Exception(const std::string& msg) : std::runtime_error("lz4 error: " + msg) {}
+};
+
+/*
+ * Chunked lz4 container
+ *
+ * The legacy stream is a serie of chunks prefixed by their compressed size. The chunked container
+ * allows to compress and decompress the chunks in parallel:
+ *
+ *   header:  magic (8 bytes) | version (uint32) | chunk_size (uint32)
+ *   chunks:  compressed_size (uint32) | raw_size (uint32) | compressed data
+ *   end:     0 (uint32)
+ *   index:   for each chunk, offset of the chunk from the beginning of the file (uint64) | compressed_size (uint32)
+ *            | raw_size (uint32)
+ *   footer:  index offset (uint64) | nb chunks (uint64) | magic (8 bytes)
+ *
+ * Read as a legacy chunk size, the magic would be a chunk of more than 1GB, which the legacy
+ * compressor never wrote, so both formats can be told apart by their first bytes.
+ */
+namespace lz4_chunked {
+const char magic[8] = {'N', 'A', 'V', 'L', 'Z', '4', 'C', 'I'};
+const uint32_t version = 2;
+const uint32_t default_chunk_size = 4 * 1024 * 1024;
+const size_t header_size = sizeof(magic) + 2 * sizeof(uint32_t);
+const size_t footer_size = 2 * sizeof(uint64_t) + sizeof(magic);
+
+struct ChunkIndex {
+    uint64_t offset;
+    uint32_t compressed_size;
+    uint32_t raw_size;
+};
+
+inline bool is_chunked(const char* begin, size_t size) {
+    return size >= sizeof(magic) && std::equal(magic, magic + sizeof(magic), begin);
+}
+
+inline size_t default_nb_threads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+inline std::string compress_chunk(const std::string& raw) {
+    std::string compressed(LZ4_compressBound(raw.size()), '\0');
+    const int compressed_size = LZ4_compress_default(raw.data(), &compressed[0], raw.size(), compressed.size());
+    if (compressed_size <= 0) {
+        throw LZ4Exception("unable to compress a chunk");
+    }
+    compressed.resize(compressed_size);
+    return compressed;
+}
+
+inline std::vector<char> decompress_chunk(const char* compressed, uint32_t compressed_size, uint32_t raw_size) {
+    std::vector<char> raw(raw_size);
+    const int size = LZ4_decompress_safe(compressed, raw.data(), compressed_size, raw_size);
+    if (size < 0 || uint32_t(size) != raw_size) {
+        throw LZ4Exception("corrupted chunk");
+    }
+    return raw;
+}
+
+template <typename T>
+void read_pod(const char* src, T& value) {
+    memcpy(&value, src, sizeof(T));
+}
+}  // namespace lz4_chunked
 
 /**
  * Filtre de compression utilisant l'algorithme de compression LZ4 pour boost::iostreams
@@ -82,15 +155,162 @@ public:
     }
 };
 
+/**
+ * Compression filter writing the chunked lz4 container
+ *
+ * The input is cut in chunks of chunk_size bytes, each chunk is compressed in its own thread,
+ * at most nb_threads chunks are compressed at the same time.
+ * The index and the footer are written when the filter is closed.
+ */
+class LZ4ChunkedCompressor : public boost::iostreams::multichar_output_filter {
+    uint32_t chunk_size;
+    size_t nb_threads;
+
+    std::string current_chunk;
+    std::deque<std::future<std::string>> pending_chunks;
+    std::deque<uint32_t> pending_raw_sizes;
+    std::vector<lz4_chunked::ChunkIndex> index;
+    uint64_t offset = 0;
+
+    template <typename Sink>
+    void write_raw(Sink& dest, const char* src, size_t size) {
+        boost::iostreams::write(dest, src, size);
+        offset += size;
+    }
+
+    template <typename Sink, typename T>
+    void write_pod(Sink& dest, const T& value) {
+        write_raw(dest, reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename Sink>
+    void write_header(Sink& dest) {
+        write_raw(dest, lz4_chunked::magic, sizeof(lz4_chunked::magic));
+        write_pod(dest, lz4_chunked::version);
+        write_pod(dest, chunk_size);
+    }
+
+    void push_current_chunk() {
+        pending_raw_sizes.push_back(current_chunk.size());
+        pending_chunks.push_back(std::async(std::launch::async, lz4_chunked::compress_chunk, std::move(current_chunk)));
+        current_chunk.clear();
+        current_chunk.reserve(chunk_size);
+    }
+
+    // the chunks are written in order, the compression of the next ones goes on meanwhile
+    template <typename Sink>
+    void write_pending_chunks(Sink& dest, size_t nb_max_pending) {
+        while (pending_chunks.size() > nb_max_pending) {
+            const std::string compressed = pending_chunks.front().get();
+            const lz4_chunked::ChunkIndex chunk{offset, uint32_t(compressed.size()), pending_raw_sizes.front()};
+            pending_chunks.pop_front();
+            pending_raw_sizes.pop_front();
+            write_pod(dest, chunk.compressed_size);
+            write_pod(dest, chunk.raw_size);
+            write_raw(dest, compressed.data(), compressed.size());
+            index.push_back(chunk);
+        }
+    }
+
+public:
+    LZ4ChunkedCompressor(uint32_t chunk_size = lz4_chunked::default_chunk_size,
+                         size_t nb_threads = lz4_chunked::default_nb_threads())
+        : chunk_size(std::max(chunk_size, 1u)), nb_threads(std::max(nb_threads, size_t(1))) {}
+
+    LZ4ChunkedCompressor(const LZ4ChunkedCompressor& other)
+        : chunk_size(other.chunk_size), nb_threads(other.nb_threads) {}
+
+    template <typename Sink>
+    std::streamsize write(Sink& dest, const char* src, std::streamsize size) {
+        if (offset == 0) {
+            write_header(dest);
+            current_chunk.reserve(chunk_size);
+        }
+        std::streamsize written = 0;
+        while (written < size) {
+            const size_t nb = std::min(size_t(size - written), size_t(chunk_size - current_chunk.size()));
+            current_chunk.append(src + written, nb);
+            written += nb;
+            if (current_chunk.size() == chunk_size) {
+                push_current_chunk();
+                write_pending_chunks(dest, nb_threads);
+            }
+        }
+        return written;
+    }
+
+    template <typename Sink>
+    void close(Sink& dest) {
+        if (offset == 0) {
+            write_header(dest);
+        }
+        if (!current_chunk.empty()) {
+            push_current_chunk();
+        }
+        write_pending_chunks(dest, 0);
+        write_pod(dest, uint32_t(0));
+
+        const uint64_t index_offset = offset;
+        for (const auto& chunk : index) {
+            write_pod(dest, chunk.offset);
+            write_pod(dest, chunk.compressed_size);
+            write_pod(dest, chunk.raw_size);
+        }
+        write_pod(dest, index_offset);
+        write_pod(dest, uint64_t(index.size()));
+        write_raw(dest, lz4_chunked::magic, sizeof(lz4_chunked::magic));
+
+        // the filter can be reused for another stream
+        index.clear();
+        offset = 0;
+    }
+};
+
 /**
  * Filtre de décompression utilisant l'algorithme de compression LZ4 pour boost::iostreams
  *
  * le buffer de sortie doit etre dimensionné afin de pouvoir contenir un chunk décompréssé complet
+ *
+ * Le conteneur chunké est aussi lu, séquentiellement et sans utiliser l'index.
  */
 class LZ4Decompressor : public boost::iostreams::multichar_input_filter {
     std::streamsize buffer_size;
     char* input_buffer;
 
+    // state of the reading of a chunked container
+    bool first_read = true;
+    bool chunked = false;
+    std::vector<char> compressed_chunk;
+    std::vector<char> raw_chunk;
+    size_t raw_chunk_pos = 0;
+
+    template <typename Source>
+    void read_exactly(Source& src, char* dest, std::streamsize size) {
+        if (size > 0 && boost::iostreams::read(src, dest, size) != size) {
+            throw LZ4Exception("truncated stream");
+        }
+    }
+
+    template <typename Source>
+    std::streamsize read_chunked(Source& src, char* dest, std::streamsize size) {
+        if (raw_chunk_pos == raw_chunk.size()) {
+            uint32_t compressed_size = 0, raw_size = 0;
+            read_exactly(src, reinterpret_cast<char*>(&compressed_size), sizeof(uint32_t));
+            if (compressed_size == 0) {
+                return -1;  // end of the chunks, the index is not needed
+            }
+            read_exactly(src, reinterpret_cast<char*>(&raw_size), sizeof(uint32_t));
+            compressed_chunk.resize(compressed_size);
+            read_exactly(src, compressed_chunk.data(), compressed_size);
+            raw_chunk = lz4_chunked::decompress_chunk(compressed_chunk.data(), compressed_size, raw_size);
+            raw_chunk_pos = 0;
+        }
+        const size_t nb = std::min(size_t(size), raw_chunk.size() - raw_chunk_pos);
+        memcpy(dest, raw_chunk.data() + raw_chunk_pos, nb);
+        raw_chunk_pos += nb;
+        return nb;
+    }
+
 public:
     /**
      * @param buffer_size correspond au buffer de travail pour la décompression, il doit etre suffisament grand pour
@@ -109,10 +329,28 @@ public:
 
     template <typename Source>
     std::streamsize read(Source& src, char* dest, std::streamsize size) {
+        if (chunked) {
+            return read_chunked(src, dest, size);
+        }
         std::streamsize output_size = 0, read_size = 0;
         uint32_t chunk_size = 0;
 
-        boost::iostreams::read(src, reinterpret_cast<char*>(&chunk_size), sizeof(uint32_t));
+        read_size = boost::iostreams::read(src, reinterpret_cast<char*>(&chunk_size), sizeof(uint32_t));
+        if (first_read && read_size == sizeof(uint32_t)) {
+            first_read = false;
+            if (memcmp(&chunk_size, lz4_chunked::magic, sizeof(uint32_t)) == 0) {
+                char header[lz4_chunked::header_size];
+                memcpy(header, &chunk_size, sizeof(uint32_t));
+                read_exactly(src, header + sizeof(uint32_t), sizeof(header) - sizeof(uint32_t));
+                uint32_t file_version;
+                lz4_chunked::read_pod(header + sizeof(lz4_chunked::magic), file_version);
+                if (!lz4_chunked::is_chunked(header, sizeof(header)) || file_version != lz4_chunked::version) {
+                    throw LZ4Exception("unknown chunked lz4 container");
+                }
+                chunked = true;
+                return read_chunked(src, dest, size);
+            }
+        }
         read_size = boost::iostreams::read(src, input_buffer, chunk_size);
         if (read_size == chunk_size) {
             output_size = LZ4_decompress_safe(input_buffer, dest, chunk_size, size);
@@ -126,3 +364,102 @@ public:
         return output_size;
     }
 };
+
+/**
+ * Source reading a chunked lz4 container in memory (typically a mapped file)
+ *
+ * The index in the footer gives the position of all the chunks, so the next nb_threads chunks
+ * are decompressed in parallel while the previous one is consumed by the reader.
+ * Once a chunk is decompressed, consumed is called with the end of its compressed data, so the
+ * owner of the memory can release what is before.
+ */
+class LZ4ChunkedSource : public boost::iostreams::source {
+    const char* begin;
+    size_t size;
+    size_t nb_threads;
+    std::function<void(const char*)> consumed;
+
+    bool initialized = false;
+    std::vector<lz4_chunked::ChunkIndex> index;
+    size_t next_chunk = 0;
+    std::deque<std::future<std::vector<char>>> pending_chunks;
+    std::vector<char> raw_chunk;
+    size_t raw_chunk_pos = 0;
+
+    void read_index() {
+        using namespace lz4_chunked;
+        if (size < header_size + footer_size || !is_chunked(begin, size)
+            || !is_chunked(begin + size - sizeof(magic), sizeof(magic))) {
+            throw LZ4Exception("not a chunked lz4 container");
+        }
+        uint32_t file_version;
+        read_pod(begin + sizeof(magic), file_version);
+        if (file_version != version) {
+            throw LZ4Exception("unknown chunked lz4 container version " + std::to_string(file_version));
+        }
+        uint64_t index_offset, nb_chunks;
+        const char* footer = begin + size - footer_size;
+        read_pod(footer, index_offset);
+        read_pod(footer + sizeof(uint64_t), nb_chunks);
+        if (index_offset > size - footer_size || nb_chunks > size
+            || nb_chunks * (sizeof(uint64_t) + 2 * sizeof(uint32_t)) != size - footer_size - index_offset) {
+            throw LZ4Exception("corrupted index");
+        }
+        index.resize(nb_chunks);
+        const char* cur = begin + index_offset;
+        for (auto& chunk : index) {
+            read_pod(cur, chunk.offset);
+            read_pod(cur + sizeof(uint64_t), chunk.compressed_size);
+            read_pod(cur + sizeof(uint64_t) + sizeof(uint32_t), chunk.raw_size);
+            cur += sizeof(uint64_t) + 2 * sizeof(uint32_t);
+            if (chunk.offset < header_size
+                || chunk.offset + 2 * sizeof(uint32_t) + chunk.compressed_size > index_offset) {
+                throw LZ4Exception("corrupted index");
+            }
+        }
+        initialized = true;
+    }
+
+    void launch_decompressions() {
+        while (next_chunk < index.size() && pending_chunks.size() < nb_threads) {
+            const auto& chunk = index[next_chunk++];
+            pending_chunks.push_back(std::async(std::launch::async, lz4_chunked::decompress_chunk,
+                                                begin + chunk.offset + 2 * sizeof(uint32_t), chunk.compressed_size,
+                                                chunk.raw_size));
+        }
+    }
+
+public:
+    LZ4ChunkedSource(const char* begin,
+                     size_t size,
+                     size_t nb_threads = lz4_chunked::default_nb_threads(),
+                     std::function<void(const char*)> consumed = nullptr)
+        : begin(begin), size(size), nb_threads(std::max(nb_threads, size_t(1))), consumed(std::move(consumed)) {}
+
+    LZ4ChunkedSource(const LZ4ChunkedSource& other)
+        : begin(other.begin), size(other.size), nb_threads(other.nb_threads), consumed(other.consumed) {}
+
+    std::streamsize read(char* dest, std::streamsize n) {
+        if (!initialized) {
+            read_index();
+        }
+        while (raw_chunk_pos == raw_chunk.size()) {
+            launch_decompressions();
+            if (pending_chunks.empty()) {
+                return -1;
+            }
+            raw_chunk = pending_chunks.front().get();
+            const auto& chunk = index[next_chunk - pending_chunks.size()];
+            pending_chunks.pop_front();
+            raw_chunk_pos = 0;
+            if (consumed) {
+                consumed(begin + chunk.offset + 2 * sizeof(uint32_t) + chunk.compressed_size);
+            }
+            launch_decompressions();
+        }
+        const size_t nb = std::min(size_t(n), raw_chunk.size() - raw_chunk_pos);
+        memcpy(dest, raw_chunk.data() + raw_chunk_pos, nb);
+        raw_chunk_pos += nb;
+        return nb;
+    }
+};
@@ -0,0 +1,167 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+
+#include "lz4_filter/filter.h"
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace po = boost::program_options;
+
+/*
+ * Throughput of the lz4 compression and decompression, with the legacy stream
+ * and with the chunked container
+ */
+
+// half random, half repeated data, to be compressed like a data.nav.lz4
+static std::string generate_data(size_t size) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::string data;
+    data.reserve(size);
+    while (data.size() < size) {
+        for (int i = 0; i < 16 && data.size() < size; ++i) {
+            data.push_back(char(dist(gen)));
+        }
+        data.append(std::min(size_t(48), size - data.size()), char(data.size() % 7));
+    }
+    return data;
+}
+
+template <typename F>
+static double bench(const std::string& name, size_t raw_size, F f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << duration.count() * 1000 << "ms, " << raw_size / duration.count() / 1024 / 1024
+              << "MB/s" << std::endl;
+    return duration.count();
+}
+
+static void read_all(std::istream& in, std::string& result) {
+    result.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+int main(int argc, char** argv) {
+    po::options_description desc("Options of the lz4 benchmark");
+    size_t size_mb, nb_threads;
+    uint32_t chunk_size_kb;
+    std::string file;
+    // clang-format off
+    desc.add_options()
+        ("help", "Show this message")
+        ("file,f", po::value<std::string>(&file), "Uncompressed file to use instead of generated data")
+        ("size,s", po::value<size_t>(&size_mb)->default_value(512), "Size of the generated data in MB")
+        ("threads,t", po::value<size_t>(&nb_threads)->default_value(lz4_chunked::default_nb_threads()),
+            "Number of threads of the chunked container")
+        ("chunk_size,c", po::value<uint32_t>(&chunk_size_kb)->default_value(lz4_chunked::default_chunk_size / 1024),
+            "Size of the chunks of the chunked container in KB");
+    // clang-format on
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+    if (vm.count("help")) {
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    std::string data;
+    if (vm.count("file")) {
+        std::ifstream ifs(file, std::ios::binary);
+        read_all(ifs, data);
+    } else {
+        data = generate_data(size_mb * 1024 * 1024);
+    }
+    std::cout << "data size: " << data.size() / 1024 / 1024 << "MB, " << nb_threads << " threads, chunks of "
+              << chunk_size_kb << "KB" << std::endl;
+
+    // same buffers as Data::save and Data::load_nav
+    std::string legacy, chunked, result;
+    bench("legacy compression", data.size(), [&]() {
+        std::stringstream ss;
+        {
+            boost::iostreams::filtering_ostream out;
+            out.push(LZ4Compressor(2048 * 500), 1024 * 500, 1024 * 500);
+            out.push(ss);
+            out.write(data.data(), data.size());
+        }
+        legacy = ss.str();
+    });
+    bench("chunked compression", data.size(), [&]() {
+        std::stringstream ss;
+        {
+            boost::iostreams::filtering_ostream out;
+            out.push(LZ4ChunkedCompressor(chunk_size_kb * 1024, nb_threads), 1024 * 500, 1024 * 500);
+            out.push(ss);
+            out.write(data.data(), data.size());
+        }
+        chunked = ss.str();
+    });
+    std::cout << "compressed size: legacy " << legacy.size() / 1024 / 1024 << "MB, chunked "
+              << chunked.size() / 1024 / 1024 << "MB" << std::endl;
+
+    bench("legacy decompression", data.size(), [&]() {
+        boost::iostreams::filtering_istream in;
+        in.push(LZ4Decompressor(2048 * 500), 8192 * 500, 8192 * 500);
+        in.push(boost::iostreams::array_source(legacy.data(), legacy.size()));
+        read_all(in, result);
+    });
+    if (result != data) {
+        std::cerr << "legacy decompression failed" << std::endl;
+        return 1;
+    }
+    bench("chunked sequential decompression", data.size(), [&]() {
+        boost::iostreams::filtering_istream in;
+        in.push(LZ4Decompressor(2048 * 500), 8192 * 500, 8192 * 500);
+        in.push(boost::iostreams::array_source(chunked.data(), chunked.size()));
+        read_all(in, result);
+    });
+    if (result != data) {
+        std::cerr << "chunked sequential decompression failed" << std::endl;
+        return 1;
+    }
+    bench("chunked parallel decompression", data.size(), [&]() {
+        boost::iostreams::filtering_istream in;
+        in.push(LZ4ChunkedSource(chunked.data(), chunked.size(), nb_threads), 8192 * 500, 8192 * 500);
+        read_all(in, result);
+    });
+    if (result != data) {
+        std::cerr << "chunked parallel decompression failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
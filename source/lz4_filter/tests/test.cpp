@@ -36,7 +36,11 @@ www.navitia.io
 #include <boost/iostreams/device/file_descriptor.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <algorithm>
 #include <string>
+#include <sstream>
+#include <vector>
 
 BOOST_AUTO_TEST_CASE(tiny_string_compression) {
     std::string str = "foo";
@@ -95,3 +99,109 @@ BOOST_AUTO_TEST_CASE(big_string_compression) {
     }
     BOOST_CHECK_EQUAL(str, result);
 }
+
+static std::string big_string() {
+    std::string str;
+    for (int i = 0; i < 100000; i++) {
+        str += "foobariozafiozehfuiozefuigaezgfuzegfpuzheuerfhzeupgf" + std::to_string(i);
+    }
+    return str;
+}
+
+static std::string compress_chunked(const std::string& str, uint32_t chunk_size, size_t nb_threads) {
+    std::stringstream ss;
+    {
+        boost::iostreams::filtering_ostream out;
+        out.push(LZ4ChunkedCompressor(chunk_size, nb_threads));
+        out.push(ss);
+        out << str;
+    }
+    return ss.str();
+}
+
+static std::string read_all(std::istream& in) {
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+BOOST_AUTO_TEST_CASE(chunked_compression) {
+    const std::string str = big_string();
+    const std::string compressed = compress_chunked(str, 100000, 3);
+    BOOST_REQUIRE(lz4_chunked::is_chunked(compressed.data(), compressed.size()));
+    BOOST_CHECK_LT(compressed.size(), str.size());
+
+    // parallel reading with the index, the compressed chunks being consumed in order up to the end marker
+    uint64_t index_offset;
+    lz4_chunked::read_pod(compressed.data() + compressed.size() - lz4_chunked::footer_size, index_offset);
+    for (size_t nb_threads : {1, 4}) {
+        std::vector<const char*> consumed;
+        boost::iostreams::filtering_istream in;
+        in.push(LZ4ChunkedSource(compressed.data(), compressed.size(), nb_threads,
+                                 [&](const char* until) { consumed.push_back(until); }));
+        BOOST_CHECK(read_all(in) == str);
+        BOOST_REQUIRE(!consumed.empty());
+        BOOST_CHECK(std::is_sorted(consumed.begin(), consumed.end()));
+        BOOST_CHECK(consumed.back() == compressed.data() + index_offset - sizeof(uint32_t));
+    }
+
+    // sequential reading of the stream
+    boost::iostreams::filtering_istream in;
+    in.push(LZ4Decompressor(2048));
+    in.push(boost::iostreams::array_source(compressed.data(), compressed.size()));
+    BOOST_CHECK(read_all(in) == str);
+}
+
+BOOST_AUTO_TEST_CASE(chunked_tiny_and_empty_string_compression) {
+    for (const std::string str : {"", "foo"}) {
+        const std::string compressed = compress_chunked(str, lz4_chunked::default_chunk_size, 2);
+        BOOST_REQUIRE(lz4_chunked::is_chunked(compressed.data(), compressed.size()));
+        {
+            boost::iostreams::filtering_istream in;
+            in.push(LZ4ChunkedSource(compressed.data(), compressed.size()));
+            BOOST_CHECK_EQUAL(read_all(in), str);
+        }
+        {
+            boost::iostreams::filtering_istream in;
+            in.push(LZ4Decompressor());
+            in.push(boost::iostreams::array_source(compressed.data(), compressed.size()));
+            BOOST_CHECK_EQUAL(read_all(in), str);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(chunked_corrupted_container) {
+    const std::string str = big_string();
+    const std::string compressed = compress_chunked(str, 100000, 2);
+
+    // a legacy stream is not a chunked container
+    {
+        std::stringstream ss;
+        {
+            boost::iostreams::filtering_ostream out;
+            out.push(LZ4Compressor(2048));
+            out.push(ss);
+            out << "foo";
+        }
+        const std::string legacy = ss.str();
+        BOOST_CHECK(!lz4_chunked::is_chunked(legacy.data(), legacy.size()));
+        boost::iostreams::filtering_istream in;
+        in.push(LZ4ChunkedSource(legacy.data(), legacy.size()));
+        BOOST_CHECK_THROW(read_all(in), LZ4Exception);
+    }
+    // truncated file, the footer is missing
+    {
+        boost::iostreams::filtering_istream in;
+        in.push(LZ4ChunkedSource(compressed.data(), compressed.size() / 2));
+        BOOST_CHECK_THROW(read_all(in), LZ4Exception);
+    }
+    // corrupted index
+    {
+        std::string corrupted = compressed;
+        uint64_t index_offset;
+        lz4_chunked::read_pod(corrupted.data() + corrupted.size() - lz4_chunked::footer_size, index_offset);
+        const uint64_t bad_offset = corrupted.size();
+        memcpy(&corrupted[index_offset], &bad_offset, sizeof(uint64_t));
+        boost::iostreams::filtering_istream in;
+        in.push(LZ4ChunkedSource(corrupted.data(), corrupted.size()));
+        BOOST_CHECK_THROW(read_all(in), LZ4Exception);
+    }
+}
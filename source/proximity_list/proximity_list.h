@@ -33,7 +33,9 @@ www.navitia.io
 #include "type/geographical_coord.h"
 #include "utils/exception.h"
 #include <vector>
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 
 namespace navitia {
 namespace proximitylist {
@@ -50,8 +52,11 @@ struct NotFound : public recoverable_exception {
  *
  * Le template T est le type que l'on souhaite indexer (typiquement un Idx). L'élément sera copié.
  * On rajoute des élements itérativements et on appelle build pour construire l'indexe.
- * L'implémentation est un bête tableau trié par X.
- * On cherche les bornes inf/sup selon X, puis on itère sur les données et on garde les bonnes
+ *
+ * The index is a uniform grid of square cells of a few hundred meters: the items are sorted by cell, row by row, and
+ * only the non empty cells are stored, with the beginning of their items. The cells of a row in a range of columns
+ * are thus a contiguous range of items, found by binary search, and a search only reads the items of the cells
+ * around the coordinate.
  */
 
 template <class T>
@@ -68,40 +73,182 @@ struct ProximityList {
         }
     };
 
-    /// Contient toutes les coordonnées de manière à trouver rapidement
+    /// meters by degree, with the approximation of approx_sqr_distance
+    static constexpr double M_BY_DEG = GeographicalCoord::EARTH_RADIUS_IN_METERS * GeographicalCoord::N_DEG_TO_RAD;
+
+    /// Contient toutes les coordonnées, triées par cellule
     std::vector<Item> items;
 
+    /// the grid: its south west corner and the size of its cells, in degrees
+    double min_lon = 0;
+    double min_lat = 0;
+    double cell_lon = 1;
+    double cell_lat = 1;
+    uint64_t nb_lon = 0;
+    uint64_t nb_lat = 0;
+    /// the non empty cells, identified by row * nb_lon + column, and the beginning of their items
+    std::vector<uint64_t> cell_keys;
+    std::vector<uint32_t> cell_begins;
+
     /// Rajoute un nouvel élément. Attention, il faut appeler build avant de pouvoir utiliser la structure
     void add(GeographicalCoord coord, T element) { items.push_back(Item(coord, element)); }
-    void clear() { items.clear(); }
+    void clear() {
+        items.clear();
+        nb_lon = nb_lat = 0;
+        cell_keys.clear();
+        cell_begins.clear();
+    }
+
+    /// Construit l'indexe, with cells of cell_size meters
+    void build(double cell_size = 200) {
+        cell_keys.clear();
+        cell_begins.clear();
+        if (items.empty()) {
+            nb_lon = nb_lat = 0;
+            return;
+        }
+        auto lon = std::minmax_element(items.begin(), items.end(),
+                                       [](const Item& a, const Item& b) { return a.coord.lon() < b.coord.lon(); });
+        auto lat = std::minmax_element(items.begin(), items.end(),
+                                       [](const Item& a, const Item& b) { return a.coord.lat() < b.coord.lat(); });
+        min_lon = lon.first->coord.lon();
+        min_lat = lat.first->coord.lat();
+        const double max_lon = lon.second->coord.lon();
+        const double max_lat = lat.second->coord.lat();
+
+        // the cells are square at the middle of the grid
+        const double coslat = ::cos((min_lat + max_lat) / 2 * GeographicalCoord::N_DEG_TO_RAD);
+        cell_lat = cell_size / M_BY_DEG;
+        cell_lon = cell_lat / std::max(coslat, 0.01);
+        nb_lon = uint64_t((max_lon - min_lon) / cell_lon) + 1;
+        nb_lat = uint64_t((max_lat - min_lat) / cell_lat) + 1;
+
+        std::sort(items.begin(), items.end(), [&](const Item& a, const Item& b) {
+            const auto key_a = key(a.coord), key_b = key(b.coord);
+            return key_a < key_b || (key_a == key_b && a.coord < b.coord);
+        });
+        for (size_t i = 0; i < items.size(); ++i) {
+            const auto k = key(items[i].coord);
+            if (cell_keys.empty() || cell_keys.back() != k) {
+                cell_keys.push_back(k);
+                cell_begins.push_back(i);
+            }
+        }
+        cell_begins.push_back(items.size());
+        cell_keys.shrink_to_fit();
+        cell_begins.shrink_to_fit();
+    }
 
-    /// Construit l'indexe
-    void build() {
-        std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) { return a.coord < b.coord; });
+    /** Calls f on the items of all the cells intersecting the box, and maybe on a few others
+     *
+     * The items outside the box are not filtered.
+     */
+    template <class F>
+    void for_each_in_box(const GeographicalCoord& min, const GeographicalCoord& max, const F& f) const {
+        if (cell_keys.empty()) {
+            return;
+        }
+        const int64_t col_begin = std::max(col(min.lon()), int64_t(0));
+        const int64_t col_end = std::min(col(max.lon()), int64_t(nb_lon) - 1);
+        const int64_t row_begin = std::max(row(min.lat()), int64_t(0));
+        const int64_t row_end = std::min(row(max.lat()), int64_t(nb_lat) - 1);
+        for (int64_t r = row_begin; r <= row_end; ++r) {
+            for_each_in_row(r, col_begin, col_end, f);
+        }
     }
 
     /// Retourne tous les éléments dans un rayon de x mètres
     std::vector<std::pair<T, GeographicalCoord> > find_within(GeographicalCoord coord, double distance = 500) const {
-        double distance_degree = distance / 111320;
+        double distance_degree = distance / M_BY_DEG;
 
         double coslat = ::cos(coord.lat() * type::GeographicalCoord::N_DEG_TO_RAD);
+        const double lon_degree = coslat > 0 ? distance_degree / coslat : 360;
 
-        auto begin = std::lower_bound(items.begin(), items.end(), coord.lon() - distance_degree / coslat,
-                                      [](const Item& i, double min) { return i.coord.lon() < min; });
-        auto end = std::upper_bound(begin, items.end(), coord.lon() + distance_degree / coslat,
-                                    [](double max, const Item& i) { return max < i.coord.lon(); });
-        std::vector<std::pair<T, GeographicalCoord> > result;
+        // the distances are computed once, and not at each comparison of the sort
+        std::vector<std::pair<double, const Item*> > found;
         double max_dist = distance * distance;
-        for (; begin != end; ++begin) {
-            if (begin->coord.approx_sqr_distance(coord, coslat) <= max_dist)
-                result.push_back(std::make_pair(begin->element, begin->coord));
+        for_each_in_box(GeographicalCoord(coord.lon() - lon_degree, coord.lat() - distance_degree),
+                        GeographicalCoord(coord.lon() + lon_degree, coord.lat() + distance_degree),
+                        [&](const Item& item) {
+                            const double dist = item.coord.approx_sqr_distance(coord, coslat);
+                            if (dist <= max_dist) {
+                                found.emplace_back(dist, &item);
+                            }
+                        });
+        std::sort(found.begin(), found.end(),
+                  [](const std::pair<double, const Item*>& a, const std::pair<double, const Item*>& b) {
+                      return a.first < b.first;
+                  });
+        return to_result(found);
+    }
+
+    /** Retourne les k éléments les plus proches, à moins de max_dist mètres, triés par distance
+     *
+     * The cells are searched ring by ring around the coordinate, until the items not searched yet are farther than
+     * the k-th nearest found.
+     */
+    std::vector<std::pair<T, GeographicalCoord> > find_k_nearest(GeographicalCoord coord,
+                                                                  size_t k,
+                                                                  double max_dist = 500) const {
+        if (cell_keys.empty() || k == 0) {
+            return {};
         }
-        std::sort(
-            result.begin(), result.end(),
-            [&coord, &coslat](const std::pair<T, GeographicalCoord>& a, const std::pair<T, GeographicalCoord>& b) {
-                return a.second.approx_sqr_distance(coord, coslat) < b.second.approx_sqr_distance(coord, coslat);
-            });
-        return result;
+        const double coslat = ::cos(coord.lat() * type::GeographicalCoord::N_DEG_TO_RAD);
+        const double max_sqr_dist = max_dist * max_dist;
+        // the k nearest found, as a max heap on the distance
+        std::vector<std::pair<double, const Item*> > heap;
+        const auto farther = [](const std::pair<double, const Item*>& a, const std::pair<double, const Item*>& b) {
+            return a.first < b.first;
+        };
+        const auto visit = [&](const Item& item) {
+            const double dist = item.coord.approx_sqr_distance(coord, coslat);
+            if (dist > max_sqr_dist || (heap.size() == k && dist >= heap.front().first)) {
+                return;
+            }
+            heap.emplace_back(dist, &item);
+            std::push_heap(heap.begin(), heap.end(), farther);
+            if (heap.size() > k) {
+                std::pop_heap(heap.begin(), heap.end(), farther);
+                heap.pop_back();
+            }
+        };
+
+        const int64_t c = col(coord.lon()), r = row(coord.lat());
+        for (int64_t ring = 0;; ++ring) {
+            const int64_t col_begin = std::max(c - ring, int64_t(0));
+            const int64_t col_end = std::min(c + ring, int64_t(nb_lon) - 1);
+            if (r - ring >= 0 && r - ring < int64_t(nb_lat)) {
+                for_each_in_row(r - ring, col_begin, col_end, visit);
+            }
+            if (ring > 0 && r + ring >= 0 && r + ring < int64_t(nb_lat)) {
+                for_each_in_row(r + ring, col_begin, col_end, visit);
+            }
+            const int64_t middle_end = std::min(r + ring - 1, int64_t(nb_lat) - 1);
+            for (int64_t middle = std::max(r - ring + 1, int64_t(0)); middle <= middle_end; ++middle) {
+                if (c - ring >= 0 && c - ring < int64_t(nb_lon)) {
+                    for_each_in_row(middle, c - ring, c - ring, visit);
+                }
+                if (ring > 0 && c + ring >= 0 && c + ring < int64_t(nb_lon)) {
+                    for_each_in_row(middle, c + ring, c + ring, visit);
+                }
+            }
+
+            // the items not searched yet are out of the square of the rings searched
+            const double lon_margin = std::min(coord.lon() - (min_lon + (c - ring) * cell_lon),
+                                               min_lon + (c + ring + 1) * cell_lon - coord.lon());
+            const double lat_margin = std::min(coord.lat() - (min_lat + (r - ring) * cell_lat),
+                                               min_lat + (r + ring + 1) * cell_lat - coord.lat());
+            const double margin = std::min(lon_margin * coslat, lat_margin) * M_BY_DEG;
+            const bool all_searched =
+                c - ring <= 0 && r - ring <= 0 && c + ring >= int64_t(nb_lon) - 1 && r + ring >= int64_t(nb_lat) - 1;
+            if (all_searched || margin * margin > max_sqr_dist
+                || (heap.size() == k && margin * margin >= heap.front().first)) {
+                break;
+            }
+        }
+
+        std::sort_heap(heap.begin(), heap.end(), farther);
+        return to_result(heap);
     }
 
     /// Fonction de confort pour retrouver l'élément le plus proche dans l'indexe
@@ -109,7 +256,7 @@ struct ProximityList {
 
     /// Retourne l'élément le plus proche dans tout l'indexe
     T find_nearest(GeographicalCoord coord, double max_dist = 500) const {
-        auto temp = find_within(coord, max_dist);
+        auto temp = find_k_nearest(coord, 1, max_dist);
         if (temp.empty())
             throw NotFound();
         else
@@ -123,7 +270,43 @@ struct ProximityList {
      */
     template <class Archive>
     void serialize(Archive& ar, const unsigned int) {
-        ar& items;
+        ar& items& min_lon& min_lat& cell_lon& cell_lat& nb_lon& nb_lat& cell_keys& cell_begins;
+    }
+
+private:
+    /// the cells can be out of the grid, the coordinate being far from the items
+    static int64_t cell(double pos) {
+        // clamped before the conversion, not to overflow
+        return int64_t(std::floor(std::max(std::min(pos, 1e12), -1e12)));
+    }
+    int64_t col(double lon) const { return cell((lon - min_lon) / cell_lon); }
+    int64_t row(double lat) const { return cell((lat - min_lat) / cell_lat); }
+    uint64_t key(const GeographicalCoord& coord) const {
+        return uint64_t(row(coord.lat())) * nb_lon + col(coord.lon());
+    }
+
+    /// calls f on the items of the cells of the row between the columns col_begin and col_end, included
+    template <class F>
+    void for_each_in_row(int64_t r, int64_t col_begin, int64_t col_end, const F& f) const {
+        if (col_begin > col_end) {
+            return;
+        }
+        const auto begin = std::lower_bound(cell_keys.begin(), cell_keys.end(), uint64_t(r) * nb_lon + col_begin);
+        const auto end = std::upper_bound(begin, cell_keys.end(), uint64_t(r) * nb_lon + col_end);
+        const auto items_end = items.begin() + cell_begins[end - cell_keys.begin()];
+        for (auto it = items.begin() + cell_begins[begin - cell_keys.begin()]; it != items_end; ++it) {
+            f(*it);
+        }
+    }
+
+    static std::vector<std::pair<T, GeographicalCoord> > to_result(
+        const std::vector<std::pair<double, const Item*> >& found) {
+        std::vector<std::pair<T, GeographicalCoord> > result;
+        result.reserve(found.size());
+        for (const auto& dist_item : found) {
+            result.push_back(std::make_pair(dist_item.second->element, dist_item.second->coord));
+        }
+        return result;
     }
 };
 
@@ -201,6 +201,59 @@ BOOST_AUTO_TEST_CASE(find_nearest) {
     BOOST_CHECK_EQUAL_COLLECTIONS(tmp.begin(), tmp.end(), expected.begin(), expected.end());
 }
 
+// the grid must give the same results as a scan of all the items, even for coordinates far from the items
+BOOST_AUTO_TEST_CASE(find_within_and_k_nearest_as_full_scan) {
+    ProximityList<unsigned int> pl;
+    std::vector<GeographicalCoord> coords;
+    // a dense center and a few items far away, on a pseudo random spiral
+    for (unsigned int i = 0; i < 500; ++i) {
+        const double radius = i < 450 ? 0.00002 * i : 0.01 * i;
+        coords.push_back(GeographicalCoord(2.35 + radius * ::cos(i), 48.85 + radius * ::sin(i)));
+        pl.add(coords.back(), i);
+    }
+    pl.build();
+
+    const std::vector<GeographicalCoord> searched = {
+        {2.35, 48.85}, {2.352, 48.849}, {2.37, 48.86}, {5.0, 48.85}, {2.35, 52.0}, {-50., 10.}};
+    for (const auto& coord : searched) {
+        const double coslat = ::cos(coord.lat() * GeographicalCoord::N_DEG_TO_RAD);
+        std::vector<std::pair<double, unsigned int>> sorted;
+        for (unsigned int i = 0; i < coords.size(); ++i) {
+            sorted.push_back({coords[i].approx_sqr_distance(coord, coslat), i});
+        }
+        std::sort(sorted.begin(), sorted.end());
+
+        for (const double distance : {50., 500., 5000., 1e7}) {
+            std::vector<unsigned int> expected;
+            for (const auto& dist_idx : sorted) {
+                if (dist_idx.first <= distance * distance) {
+                    expected.push_back(dist_idx.second);
+                }
+            }
+            std::vector<unsigned int> within;
+            for (const auto& elt : pl.find_within(coord, distance)) {
+                within.push_back(elt.first);
+            }
+            BOOST_CHECK_EQUAL_COLLECTIONS(within.begin(), within.end(), expected.begin(), expected.end());
+
+            for (const size_t k : {1, 3, 50}) {
+                std::vector<unsigned int> nearest;
+                for (const auto& elt : pl.find_k_nearest(coord, k, distance)) {
+                    nearest.push_back(elt.first);
+                }
+                const auto end = expected.begin() + std::min(k, expected.size());
+                BOOST_CHECK_EQUAL_COLLECTIONS(nearest.begin(), nearest.end(), expected.begin(), end);
+            }
+        }
+    }
+    BOOST_CHECK_THROW(pl.find_nearest(GeographicalCoord(-50., 10.)), NotFound);
+
+    pl.clear();
+    pl.build();
+    BOOST_CHECK(pl.find_within(GeographicalCoord(2.35, 48.85)).empty());
+    BOOST_CHECK(pl.find_k_nearest(GeographicalCoord(2.35, 48.85), 2).empty());
+}
+
 BOOST_AUTO_TEST_CASE(test_api) {
     navitia::type::Data data;
     // Everything in the range
@@ -29,6 +29,7 @@ www.navitia.io
 */
 
 #include "raptor.h"
+#include "time_search.h"
 #include "type/data.h"
 #include "utils/timer.h"
 #include <boost/program_options.hpp>
@@ -41,6 +42,10 @@ www.navitia.io
 #ifdef __BENCH_WITH_CALGRIND__
 #include "valgrind/callgrind.h"
 #endif
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 using namespace navitia;
 using namespace routing;
@@ -66,11 +71,67 @@ struct Result {
     }
 };
 
+/*
+ * Hardware cache miss counters of the current thread, to measure the
+ * memory locality of the raptor loop (L1 data cache and last level
+ * cache read misses).
+ */
+struct CacheMissCounters {
+    CacheMissCounters() {
+        add("L1 data cache read misses", PERF_COUNT_HW_CACHE_L1D);
+        add("LLC read misses", PERF_COUNT_HW_CACHE_LL);
+    }
+    ~CacheMissCounters() {
+        for (const auto& counter : counters) {
+            close(counter.second);
+        }
+    }
+
+    void start() {
+        for (const auto& counter : counters) {
+            ioctl(counter.second, PERF_EVENT_IOC_RESET, 0);
+            ioctl(counter.second, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    void stop_and_print(std::ostream& os) {
+        for (const auto& counter : counters) {
+            ioctl(counter.second, PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t value = 0;
+            if (read(counter.second, &value, sizeof(value)) != sizeof(value)) {
+                os << counter.first << ": unavailable" << std::endl;
+                continue;
+            }
+            os << counter.first << ": " << value << std::endl;
+        }
+    }
+
+private:
+    // name and file descriptor of the counters
+    std::vector<std::pair<std::string, int>> counters;
+
+    void add(const std::string& name, uint64_t cache) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        const int fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fd < 0) {
+            std::cerr << "impossible to open the " << name << " counter (check perf_event_paranoid)" << std::endl;
+            return;
+        }
+        counters.emplace_back(name, fd);
+    }
+};
+
 int main(int argc, char** argv) {
     navitia::init_app();
     po::options_description desc("Options de l'outil de benchmark");
     std::string file, output, stop_input_file;
-    int iterations, start, target, date, hour;
+    int iterations, start, target, date, hour, nb_clears, nb_searches;
 
     // clang-format off
     desc.add_options()
@@ -88,6 +149,12 @@ int main(int argc, char** argv) {
             ("hour,h", po::value<int>(&hour)->default_value(-1),
                     "Begginning hour of a particular journey")
             ("verbose,v", "Verbose debugging output")
+            ("scan_stats", "Print the number of journey patterns scanned per round")
+            ("cache_misses", "Print the L1 data and last level cache misses of the computation")
+            ("clear_bench", po::value<int>(&nb_clears)->default_value(0),
+                    "Number of RAPTOR::clear to time, compared with a full copy of the labels")
+            ("search_bench", po::value<int>(&nb_searches)->default_value(0),
+                    "Number of next departure searches to time for each search implementation")
             ("stop_files", po::value<std::string>(&stop_input_file), "File with list of start and target")
             ("output,o", po::value<std::string>(&output)->default_value("benchmark.csv"),
                      "Output file");
@@ -97,6 +164,8 @@ int main(int argc, char** argv) {
     po::store(po::parse_command_line(argc, argv, desc), vm);
     po::notify(vm);
     bool verbose = vm.count("verbose");
+    bool scan_stats = vm.count("scan_stats");
+    bool cache_misses = vm.count("cache_misses");
 
     if (vm.count("help")) {
         std::cout << "This is used to benchmark journey computation" << std::endl;
@@ -186,6 +255,74 @@ int main(int argc, char** argv) {
     data.build_raptor();
     RAPTOR router(data);
 
+    if (nb_clears > 0) {
+        // Before the epoch stamped labels, each clear was copying the
+        // 2 clean label maps into every round
+        IdxMap<type::StopPoint, DateTime> clean_labels;
+        clean_labels.assign(data.pt_data->stop_points, DateTimeUtils::inf);
+        std::vector<IdxMap<type::StopPoint, DateTime>> copied_labels(2 * router.labels.size(), clean_labels);
+        Timer copy_timer;
+        for (int i = 0; i < nb_clears; ++i) {
+            for (auto& l : copied_labels) {
+                l = clean_labels;
+            }
+        }
+        const auto copy_ms = copy_timer.ms();
+
+        Timer clear_timer;
+        for (int i = 0; i < nb_clears; ++i) {
+            router.clear(true, DateTimeUtils::inf);
+        }
+        const auto clear_ms = clear_timer.ms();
+        std::cout << nb_clears << " clears of " << router.labels.size() << " rounds of labels on "
+                  << data.pt_data->stop_points.size() << " stop points: copy of the labels " << copy_ms
+                  << " ms, RAPTOR::clear " << clear_ms << " ms" << std::endl;
+    }
+
+    if (nb_searches > 0) {
+        // the departure times of every jpp, as searched by the next stop time
+        std::vector<std::vector<DateTime>> jpp_times;
+        for (const auto& jpp : data.dataRaptor->jp_container.get_jpps()) {
+            std::vector<DateTime> times;
+            for (const auto* st : data.dataRaptor->next_stop_time_data.stop_time_range_forward(
+                     jpp.first, StopEvent::pick_up)) {
+                times.push_back(DateTimeUtils::hour(st->boarding_time));
+            }
+            if (!times.empty()) {
+                jpp_times.push_back(std::move(times));
+            }
+        }
+        std::mt19937 rng(31442);
+        std::uniform_int_distribution<size_t> gen_jpp(0, jpp_times.size() - 1);
+        std::uniform_int_distribution<DateTime> gen_hour(0, DateTimeUtils::SECONDS_PER_DAY - 1);
+        std::vector<std::pair<size_t, DateTime>> searches;
+        for (int i = 0; !jpp_times.empty() && i < nb_searches; ++i) {
+            searches.emplace_back(gen_jpp(rng), gen_hour(rng));
+        }
+
+        size_t checksum = 0;
+        Timer std_timer;
+        for (const auto& s : searches) {
+            const auto& times = jpp_times[s.first];
+            checksum += std::lower_bound(times.begin(), times.end(), s.second) - times.begin();
+        }
+        std::cout << searches.size() << " searches on " << jpp_times.size() << " jpps: std::lower_bound "
+                  << std_timer.ms() << " ms (" << checksum << ")";
+        for (const auto impl : {TimeSearchImpl::Scalar, TimeSearchImpl::SSE2, TimeSearchImpl::AVX2}) {
+            if (impl > best_time_search_impl()) {
+                continue;
+            }
+            checksum = 0;
+            Timer impl_timer;
+            for (const auto& s : searches) {
+                const auto& times = jpp_times[s.first];
+                checksum += lower_bound_time(impl, times.data(), times.size(), s.second);
+            }
+            std::cout << ", " << to_string(impl) << " " << impl_timer.ms() << " ms (" << checksum << ")";
+        }
+        std::cout << std::endl;
+    }
+
     std::cout << "On lance le benchmark de l'algo " << std::endl;
     boost::progress_display show_progress(demands.size());
     Timer t("Calcul avec l'algorithme ");
@@ -194,6 +331,11 @@ int main(int argc, char** argv) {
 #ifdef __BENCH_WITH_CALGRIND__
     CALLGRIND_START_INSTRUMENTATION;
 #endif
+    std::unique_ptr<CacheMissCounters> cache_miss_counters;
+    if (cache_misses) {
+        cache_miss_counters = std::make_unique<CacheMissCounters>();
+        cache_miss_counters->start();
+    }
     for (auto demand : demands) {
         ++show_progress;
         Timer t2;
@@ -220,6 +362,9 @@ int main(int argc, char** argv) {
 #ifdef __BENCH_WITH_CALGRIND__
     CALLGRIND_STOP_INSTRUMENTATION;
 #endif
+    if (cache_miss_counters) {
+        cache_miss_counters->stop_and_print(std::cout);
+    }
 
     Timer ecriture("Writing results");
     std::fstream out_file(output, std::ios::out);
@@ -247,4 +392,18 @@ int main(int argc, char** argv) {
 
     std::cout << "Number of requests: " << demands.size() << std::endl;
     std::cout << "Number of results with solution: " << nb_reponses << std::endl;
+
+    if (scan_stats) {
+        // Before the marked journey patterns work-list, every round was
+        // scanning the whole Q, i.e. every journey pattern.
+        const size_t nb_jps = data.dataRaptor->jp_container.nb_jps();
+        const double avg_scanned = router.nb_rounds ? double(router.nb_scanned_jps) / router.nb_rounds : 0.;
+        std::cout << "Number of rounds: " << router.nb_rounds << std::endl;
+        std::cout << "Number of journey patterns: " << nb_jps << std::endl;
+        std::cout << "Average number of journey patterns scanned per round: " << avg_scanned;
+        if (nb_jps) {
+            std::cout << " (" << 100. * avg_scanned / nb_jps << "% of a full scan)";
+        }
+        std::cout << std::endl;
+    }
 }
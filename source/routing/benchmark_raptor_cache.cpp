@@ -84,6 +84,7 @@ int main(int argc, char** argv) {
             ("days,d", po::value<int>(&nb_days)->default_value(30), "number of day to build")
             ("size,s", po::value<int>(&size)->default_value(10), "raptor cache size")
             ("threads,t", po::value<int>(&nb_threads)->default_value(1), "number of threads to run")
+            ("snapshots", "load the next stop time snapshots saved by ed2nav next to the data file")
             ("profile,p", po::value<std::string>(&profile)->default_value(""), "profile file");
     // clang-format on
 
@@ -103,6 +104,10 @@ int main(int argc, char** argv) {
         data.load_nav(file);
         data.build_raptor(size);
     }
+    if (vm.count("snapshots")) {
+        Timer t("Snapshots loading");
+        data.load_next_st_snapshots(file);
+    }
     std::vector<Demand> demands;
     std::vector<nt::RTLevel> levels{nt::RTLevel::Base, nt::RTLevel::Adapted, nt::RTLevel::RealTime};
     for (int day = 1; day < nb_days; ++day) {
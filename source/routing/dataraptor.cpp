@@ -31,7 +31,9 @@ www.navitia.io
 #include "dataraptor.h"
 #include "routing.h"
 #include "routing/raptor_utils.h"
+#include "utils/logger.h"
 
+#include <boost/range/algorithm/sort.hpp>
 #include <boost/range/algorithm_ext.hpp>
 
 namespace navitia {
@@ -65,6 +67,19 @@ void dataRAPTOR::JppsFromSp::load(const type::PT_Data& data, const JourneyPatter
     }
 }
 
+void dataRAPTOR::JppsFromSp::update(const JourneyPatternContainer& jp_container,
+                                    const JppsFromSp& previous,
+                                    size_t nb_previous_jps) {
+    jpps_from_sp = previous.jpps_from_sp;
+    for (idx_t idx = nb_previous_jps; idx < jp_container.nb_jps(); ++idx) {
+        const auto jp_idx = JpIdx(idx);
+        for (const auto& jpp_idx : jp_container.get(jp_idx).jpps) {
+            const auto& jpp = jp_container.get(jpp_idx);
+            jpps_from_sp[jpp.sp_idx].push_back({jpp_idx, jp_idx, jpp.order});
+        }
+    }
+}
+
 void dataRAPTOR::JppsFromSp::filter_jpps(const boost::dynamic_bitset<>& valid_jpps) {
     for (auto& jpps : jpps_from_sp.values()) {
         boost::remove_erase_if(jpps, [&](const Jpp& jpp) { return !valid_jpps[jpp.idx.val]; });
@@ -74,14 +89,90 @@ void dataRAPTOR::JppsFromSp::filter_jpps(const boost::dynamic_bitset<>& valid_jp
 void dataRAPTOR::JppsFromJp::load(const JourneyPatternContainer& jp_container) {
     jpps_from_jp.assign(jp_container.get_jps_values());
     for (const auto jp : jp_container.get_jps()) {
-        const bool has_freq = !jp.second.freq_vjs.empty();
-        for (const auto& jpp_idx : jp.second.jpps) {
-            const auto& jpp = jp_container.get(jpp_idx);
-            jpps_from_jp[jp.first].push_back({jpp_idx, jpp.sp_idx, has_freq});
+        load_jp(jp_container, jp.first, jp.second);
+    }
+}
+
+void dataRAPTOR::JppsFromJp::update(const JourneyPatternContainer& jp_container, const JppsFromJp& previous) {
+    jpps_from_jp.assign(jp_container.get_jps_values());
+    for (const auto jp : jp_container.get_jps()) {
+        if (jp.first.val < previous.jpps_from_jp.size()) {
+            jpps_from_jp[jp.first] = previous.jpps_from_jp[jp.first];
+        } else {
+            load_jp(jp_container, jp.first, jp.second);
         }
     }
-    for (auto& jpps : jpps_from_jp.values()) {
-        jpps.shrink_to_fit();
+}
+
+void dataRAPTOR::JppsFromJp::load_jp(const JourneyPatternContainer& jp_container,
+                                     const JpIdx& jp_idx,
+                                     const JourneyPattern& jp) {
+    const bool has_freq = !jp.freq_vjs.empty();
+    // every vj of a jp shares the same stop time properties, we
+    // take them from the first one
+    const type::VehicleJourney* vj = nullptr;
+    jp.for_each_vehicle_journey([&](const type::VehicleJourney& first_vj) {
+        vj = &first_vj;
+        return false;
+    });
+    auto& jpps = jpps_from_jp[jp_idx];
+    for (const auto& jpp_idx : jp.jpps) {
+        const auto& jpp = jp_container.get(jpp_idx);
+        const auto& st = vj->stop_time_list.at(jpp.order);
+        jpps.push_back(
+            {jpp_idx, jpp.sp_idx, st.local_traffic_zone, has_freq, st.pick_up_allowed(), st.drop_off_allowed()});
+    }
+    jpps.shrink_to_fit();
+}
+
+void dataRAPTOR::JpTimetables::load(const type::PT_Data& data, const JourneyPatternContainer& jp_container) {
+    boarding_times.clear();
+    alighting_times.clear();
+    first_st_pos.assign(data.vehicle_journeys);
+    for (const auto jp : jp_container.get_jps()) {
+        jp.second.for_each_vehicle_journey([&](const type::VehicleJourney& vj) {
+            push_back(vj);
+            return true;
+        });
+    }
+    boarding_times.shrink_to_fit();
+    alighting_times.shrink_to_fit();
+}
+
+void dataRAPTOR::JpTimetables::update(const type::PT_Data& data,
+                                      const JourneyPatternContainer& jp_container,
+                                      const JpTimetables& previous,
+                                      const std::vector<const type::VehicleJourney*>& translation,
+                                      const std::vector<const type::VehicleJourney*>& touched_vjs) {
+    boarding_times = previous.boarding_times;
+    alighting_times = previous.alighting_times;
+    first_st_pos.assign(data.vehicle_journeys);
+    for (idx_t idx = 0; idx < translation.size(); ++idx) {
+        if (const auto* vj = translation[idx]) {
+            first_st_pos[VjIdx(*vj)] = previous.first_st_pos[VjIdx(idx)];
+        }
+    }
+    for (const auto* vj : touched_vjs) {
+        push_back(*vj);
+    }
+
+    size_t nb_used_times = 0;
+    for (const auto& jp : jp_container.get_jps_values()) {
+        jp.for_each_vehicle_journey([&](const type::VehicleJourney& vj) {
+            nb_used_times += vj.stop_time_list.size();
+            return true;
+        });
+    }
+    if (2 * nb_used_times < boarding_times.size()) {
+        load(data, jp_container);
+    }
+}
+
+void dataRAPTOR::JpTimetables::push_back(const type::VehicleJourney& vj) {
+    first_st_pos[VjIdx(vj)] = boarding_times.size();
+    for (const auto& st : vj.stop_time_list) {
+        boarding_times.push_back(st.boarding_time);
+        alighting_times.push_back(st.alighting_time);
     }
 }
 
@@ -93,25 +184,112 @@ void dataRAPTOR::load(const type::PT_Data& data, size_t cache_size) {
     connections.load(data);
     jpps_from_sp.load(data, jp_container);
     jpps_from_jp.load(jp_container);
+    jp_timetables.load(data, jp_container);
     next_stop_time_data.load(jp_container);
 
     for (auto level_cont : jp_validity_patterns) {
-        const auto rt_level = level_cont.first;
         auto& jp_vp = level_cont.second;
         jp_vp.assign(366, boost::dynamic_bitset<>(jp_container.nb_jps()));
         for (const auto jp : jp_container.get_jps()) {
-            for (int i = 0; i <= 365; ++i) {
-                jp.second.for_each_vehicle_journey([&](const nt::VehicleJourney& vj) {
-                    if (vj.validity_patterns[rt_level]->check2(i)) {
-                        jp_vp[i].set(jp.first.val);
-                        return false;
-                    }
-                    return true;
-                });
+            load_jp_validity_patterns(level_cont.first, jp.first, jp.second);
+        }
+    }
+
+    finish_load(cache_size);
+}
+
+void dataRAPTOR::load(const type::PT_Data& data, const dataRAPTOR& previous, size_t cache_size) {
+    auto logger = log4cplus::Logger::getInstance("logger");
+
+    // the structures are indexed by stop point, route and physical
+    // mode, that must not have been added
+    if (data.stop_points.size() != previous.connections.forward_connections.size()
+        || data.routes.size() != previous.jp_container.get_jps_from_route().size()
+        || data.physical_modes.size() != previous.jp_container.get_jps_from_phy_mode().size()) {
+        LOG4CPLUS_INFO(logger, "pt objects have been added, full load of data raptor");
+        return load(data, cache_size);
+    }
+
+    // for each vj of previous, by idx, the same vj in data, if not touched
+    std::vector<const type::VehicleJourney*> translation(previous.jp_container.get_jp_from_vj().size(), nullptr);
+    bool is_consistent = true;
+    for (const auto& jp : previous.jp_container.get_jps_values()) {
+        jp.for_each_vehicle_journey([&](const type::VehicleJourney& vj) {
+            if (data.vj_delta.contains(vj.uri)) {
+                return true;
             }
+            const auto it = data.vehicle_journeys_map.find(vj.uri);
+            if (it == data.vehicle_journeys_map.end()) {
+                is_consistent = false;
+                return false;
+            }
+            translation[vj.idx] = it->second;
+            return true;
+        });
+        if (!is_consistent) {
+            LOG4CPLUS_WARN(logger, "vehicle journeys are missing from the realtime delta, full load of data raptor");
+            return load(data, cache_size);
+        }
+    }
+
+    // the touched vjs still in data, in the order of data
+    std::vector<const type::VehicleJourney*> touched_vjs;
+    for (const auto* uris : {&data.vj_delta.added, &data.vj_delta.modified, &data.vj_delta.removed}) {
+        for (const auto& uri : *uris) {
+            const auto it = data.vehicle_journeys_map.find(uri);
+            if (it != data.vehicle_journeys_map.end() && it->second->route) {
+                touched_vjs.push_back(it->second);
+            }
+        }
+    }
+    boost::sort(touched_vjs, [](const type::VehicleJourney* vj1, const type::VehicleJourney* vj2) {
+        return vj1->idx < vj2->idx;
+    });
+    touched_vjs.erase(std::unique(touched_vjs.begin(), touched_vjs.end()), touched_vjs.end());
+
+    const auto nb_previous_jps = previous.jp_container.nb_jps();
+    const auto touched_jps = jp_container.update(data, previous.jp_container, translation, touched_vjs);
+    labels_const.init_inf(data.stop_points);
+    labels_const_reverse.init_min(data.stop_points);
+
+    connections.load(data);
+    jpps_from_sp.update(jp_container, previous.jpps_from_sp, nb_previous_jps);
+    jpps_from_jp.update(jp_container, previous.jpps_from_jp);
+    jp_timetables.update(data, jp_container, previous.jp_timetables, translation, touched_vjs);
+    next_stop_time_data.update(jp_container, previous.next_stop_time_data, touched_jps, translation);
+
+    for (auto level_cont : jp_validity_patterns) {
+        auto& jp_vp = level_cont.second;
+        jp_vp = previous.jp_validity_patterns[level_cont.first];
+        for (auto& day_vp : jp_vp) {
+            day_vp.resize(jp_container.nb_jps());
+        }
+        for (auto idx = touched_jps.find_first(); idx != touched_jps.npos; idx = touched_jps.find_next(idx)) {
+            const auto jp_idx = JpIdx(idx);
+            load_jp_validity_patterns(level_cont.first, jp_idx, jp_container.get(jp_idx));
         }
     }
 
+    finish_load(cache_size);
+    LOG4CPLUS_DEBUG(logger, touched_vjs.size() << " vehicle journeys and " << touched_jps.count()
+                                               << " journey patterns updated in data raptor");
+}
+
+void dataRAPTOR::load_jp_validity_patterns(type::RTLevel rt_level, const JpIdx& jp_idx, const JourneyPattern& jp) {
+    auto& jp_vp = jp_validity_patterns[rt_level];
+    for (int i = 0; i <= 365; ++i) {
+        jp_vp[i].reset(jp_idx.val);
+        jp.for_each_vehicle_journey([&](const nt::VehicleJourney& vj) {
+            if (vj.validity_patterns[rt_level]->check2(i)) {
+                jp_vp[i].set(jp_idx.val);
+                return false;
+            }
+            return true;
+        });
+    }
+}
+
+void dataRAPTOR::finish_load(size_t cache_size) {
     min_connection_time = std::numeric_limits<uint32_t>::max();
     for (const auto conns : connections.forward_connections) {
         for (const auto& conn : conns.second) {
@@ -70,6 +70,8 @@ struct dataRAPTOR {
         };
         inline const std::vector<Jpp>& operator[](const SpIdx& sp) const { return jpps_from_sp[sp]; }
         void load(const type::PT_Data&, const JourneyPatternContainer&);
+        // as load, the jpps of the first nb_previous_jps jps being the previous ones
+        void update(const JourneyPatternContainer&, const JppsFromSp& previous, size_t nb_previous_jps);
         void filter_jpps(const boost::dynamic_bitset<>& valid_jpps);
 
         inline IdxMap<type::StopPoint, std::vector<Jpp>>::const_iterator begin() const { return jpps_from_sp.begin(); }
@@ -83,19 +85,77 @@ struct dataRAPTOR {
     // cache friendly access to in order JourneyPatternPoints from a JourneyPattern
     struct JppsFromJp {
         // compressed JourneyPatternPoint
+        //
+        // The local traffic zone and the pick up/drop off properties
+        // are part of the journey pattern key, thus they are the same
+        // for every stop time of a journey pattern point.
         struct Jpp {
             JppIdx idx;
             SpIdx sp_idx;
+            uint16_t local_traffic_zone;
             bool has_freq;
+            bool pick_up_allowed;
+            bool drop_off_allowed;
+
+            /// can we finish with this jpp (according to clockwise), as StopTime::valid_end
+            bool valid_end(bool clockwise) const { return clockwise ? drop_off_allowed : pick_up_allowed; }
         };
         inline const std::vector<Jpp>& operator[](const JpIdx& jp) const { return jpps_from_jp[jp]; }
         void load(const JourneyPatternContainer&);
+        // as load, the jpps of the jps already in previous being the same
+        void update(const JourneyPatternContainer&, const JppsFromJp& previous);
 
     private:
+        void load_jp(const JourneyPatternContainer&, const JpIdx&, const JourneyPattern&);
+
         IdxMap<JourneyPattern, std::vector<Jpp>> jpps_from_jp;
     };
     JppsFromJp jpps_from_jp;
 
+    // Compact read only timetable of every JourneyPattern, as a
+    // struct of arrays.
+    //
+    // The times of the stop times of a vj are contiguous, and the vjs
+    // of a journey pattern are contiguous, in the
+    // JourneyPattern::for_each_vehicle_journey order, i.e. for a
+    // journey pattern, the times are indexed [vj][order].  A stop time
+    // is thus addressed by a position, the next stop time of its vj
+    // being at position + 1.
+    struct JpTimetables {
+        void load(const type::PT_Data&, const JourneyPatternContainer&);
+        // Keeps the times of the previous timetables, translated to the
+        // vjs of data, and appends the touched vjs. The times of the
+        // removed vjs are left unused, until they are the majority.
+        void update(const type::PT_Data&,
+                    const JourneyPatternContainer&,
+                    const JpTimetables& previous,
+                    const std::vector<const type::VehicleJourney*>& translation,
+                    const std::vector<const type::VehicleJourney*>& touched_vjs);
+
+        // position of the given stop time in the timetables
+        inline uint32_t st_pos(const type::StopTime& st) const {
+            return first_st_pos[VjIdx(*st.vehicle_journey)] + st.order();
+        }
+
+        // as StopTime::section_end
+        inline DateTime section_end(uint32_t pos, DateTime base_dt, bool clockwise) const {
+            return base_dt + (clockwise ? alighting_times[pos] : boarding_times[pos]);
+        }
+        // as StopTime::base_dt
+        inline DateTime base_dt(uint32_t pos, DateTime dt, bool clockwise) const {
+            return dt - (clockwise ? boarding_times[pos] : alighting_times[pos]);
+        }
+
+    private:
+        void push_back(const type::VehicleJourney&);
+
+        std::vector<uint32_t> boarding_times;
+        std::vector<uint32_t> alighting_times;
+        // position of the first stop time of each vj
+        IdxMap<type::VehicleJourney, uint32_t> first_st_pos;
+    };
+    JpTimetables jp_timetables;
+
     NextStopTimeData next_stop_time_data;
     std::unique_ptr<CachedNextStopTimeManager> cached_next_st_manager;
 
@@ -110,8 +170,17 @@ struct dataRAPTOR {
 
     dataRAPTOR() {}
     void load(const navitia::type::PT_Data&, size_t cache_size = 10);
+    // Same result as load, for a data cloned from the one of previous
+    // and modified by a realtime batch: only the jps of the vjs of
+    // data.vj_delta are rebuilt, the rest being taken from previous.
+    // previous must stay untouched during the update.
+    void load(const navitia::type::PT_Data& data, const dataRAPTOR& previous, size_t cache_size = 10);
 
     void warmup(const dataRAPTOR& other);
+
+private:
+    void load_jp_validity_patterns(type::RTLevel, const JpIdx&, const JourneyPattern&);
+    void finish_load(size_t cache_size);
 };
 
 }  // namespace routing
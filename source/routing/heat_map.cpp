@@ -34,6 +34,9 @@ www.navitia.io
 #include "isochrone.h"
 #include "raptor_api.h"
 
+#include <atomic>
+#include <cstring>
+#include <future>
 #include <vector>
 
 namespace navitia {
@@ -59,20 +62,21 @@ static void print_lat(std::stringstream& ss, const SingleCoord lat) {
     ss << "}";
 }
 
-static void print_datetime(std::stringstream& ss, navitia::time_duration duration) {
-    if (duration.is_pos_infinity()) {
-        ss << R"(null)";
-    } else {
-        ss << duration.total_seconds();
+static void append_duration(std::string& out, const uint16_t duration) {
+    if (duration == HEAT_MAP_UNREACHED) {
+        out += "null";
+        return;
+    }
+    char digits[5];
+    size_t nb_digits = 0;
+    uint16_t value = duration;
+    do {
+        digits[nb_digits++] = char('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (nb_digits) {
+        out += digits[--nb_digits];
     }
-}
-
-static void print_body(std::stringstream& ss, std::pair<SingleCoord, std::vector<navitia::time_duration>> pair) {
-    ss << "{";
-    ss << print_single_coord(pair.first, "lon");
-    ss << R"(,"duration":[)";
-    separated_by_coma(ss, print_datetime, pair.second);
-    ss << R"(]})";
 }
 
 std::string print_grid(const HeatMap& heat_map) {
@@ -80,9 +84,66 @@ std::string print_grid(const HeatMap& heat_map) {
     ss << R"({"line_headers":[)";
     separated_by_coma(ss, print_lat, heat_map.header);
     ss << R"(],"lines":[)";
-    separated_by_coma(ss, print_body, heat_map.body);
-    ss << "]}";
-    return ss.str();
+    std::string grid = ss.str();
+    // the durations are appended without any stream, they are most of the grid
+    grid.reserve(grid.size() + heat_map.lines.size() * (100 + heat_map.header.size() * 6));
+    const size_t nb_columns = heat_map.header.size();
+    for (size_t i = 0; i < heat_map.lines.size(); i++) {
+        if (i > 0) {
+            grid += ",";
+        }
+        grid += "{";
+        grid += print_single_coord(heat_map.lines[i], "lon");
+        grid += R"(,"duration":[)";
+        for (size_t j = 0; j < nb_columns; j++) {
+            if (j > 0) {
+                grid += ",";
+            }
+            append_duration(grid, heat_map.durations[i * nb_columns + j]);
+        }
+        grid += "]}";
+    }
+    grid += "]}";
+    return grid;
+}
+
+static void append_varint(std::string& out, uint32_t value) {
+    while (value >= 0x80) {
+        out += char((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += char(value);
+}
+
+static void append_double(std::string& out, const double value) {
+    static_assert(sizeof(double) == 8, "doubles are encoded on 8 bytes");
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (size_t i = 0; i < 8; i++) {
+        out += char((bits >> (8 * i)) & 0xff);
+    }
+}
+
+static void append_single_coord(std::string& out, const std::vector<SingleCoord>& coords) {
+    append_double(out, coords.empty() ? 0. : coords.front().min_coord);
+    append_double(out, coords.empty() ? 0. : coords.front().step);
+}
+
+std::string encode_grid(const HeatMap& heat_map) {
+    std::string grid;
+    grid.reserve(2 * 5 + 4 * 8 + heat_map.durations.size() * 2);
+    append_varint(grid, uint32_t(heat_map.lines.size()));
+    append_varint(grid, uint32_t(heat_map.header.size()));
+    append_single_coord(grid, heat_map.lines);
+    append_single_coord(grid, heat_map.header);
+    int32_t previous = 0;
+    for (const auto duration : heat_map.durations) {
+        const int32_t cell = duration == HEAT_MAP_UNREACHED ? 0 : int32_t(duration) + 1;
+        const int32_t delta = cell - previous;
+        append_varint(grid, (uint32_t(delta) << 1) ^ uint32_t(delta >> 31));
+        previous = cell;
+    }
+    return grid;
 }
 
 static std::pair<int, int> find_rank(const BoundBox& box,
@@ -131,58 +192,45 @@ static Boundary find_boundary(const std::pair<int, int>& rank_source,
     return Boundary(end_lon_box, end_lat_box, begin_lon_box, begin_lat_box);
 }
 
-static std::vector<std::vector<Projection>> find_projection(BoundBox box,
-                                                            const double height_step,
-                                                            const double width_step,
-                                                            const georef::GeoRef& worker,
-                                                            const double min_dist,
-                                                            const HeatMap& heat_map,
-                                                            const size_t step) {
-    std::vector<std::vector<Projection>> dist_pixel = {step, {step, Projection()}};
+// Street segment of the box, with the ranks of the cells closer than min_dist to it
+struct HeatMapSegment {
+    type::GeographicalCoord source_coord;
+    type::GeographicalCoord target_coord;
+    georef::vertex_t source;
+    georef::vertex_t target;
+    Boundary boundary;
+    HeatMapSegment(const type::GeographicalCoord& source_coord,
+                   const type::GeographicalCoord& target_coord,
+                   georef::vertex_t source,
+                   georef::vertex_t target,
+                   const Boundary& boundary)
+        : source_coord(source_coord), target_coord(target_coord), source(source), target(target), boundary(boundary) {}
+};
+
+static std::vector<HeatMapSegment> find_segments(const BoundBox& box,
+                                                 const double height_step,
+                                                 const double width_step,
+                                                 const georef::GeoRef& worker,
+                                                 const double min_dist,
+                                                 const size_t step) {
+    std::vector<HeatMapSegment> segments;
     const size_t offset_lon = floor(min_dist / (width_step * N_DEG_TO_DISTANCE)) + 1;
     const size_t offset_lat = floor(min_dist / (height_step * N_DEG_TO_DISTANCE)) + 1;
-    auto begin = std::lower_bound(
-        worker.pl.items.begin(), worker.pl.items.end(), box.min.lon(),
-        [](const proximitylist::ProximityList<georef::vertex_t>::Item& i, double min) { return i.coord.lon() < min; });
-
-    if (begin == worker.pl.items.end()) {
-        return dist_pixel;
-    }
-
-    auto end = std::upper_bound(
-        begin, worker.pl.items.end(), box.max.lon(),
-        [](double max, const proximitylist::ProximityList<georef::vertex_t>::Item& i) { return max <= i.coord.lon(); });
-
-    const auto coslat = cos(begin->coord.lat() * type::GeographicalCoord::N_DEG_TO_RAD);
-    for (auto it = begin; it != end; ++it) {
-        const auto& source = it->coord;
+    worker.pl.for_each_in_box(box.min, box.max, [&](const proximitylist::ProximityList<georef::vertex_t>::Item& item) {
+        const auto& source = item.coord;
         if (!box.contains(source)) {
-            continue;
+            return;
         }
         const auto rank_source = find_rank(box, source, height_step, width_step);
-        BOOST_FOREACH (georef::edge_t e, boost::out_edges(it->element, worker.graph)) {
+        BOOST_FOREACH (georef::edge_t e, boost::out_edges(item.element, worker.graph)) {
             const auto v = target(e, worker.graph);
             const auto& target = worker.graph[v].coord;
             const auto rank_target = find_rank(box, target, height_step, width_step);
             const auto boundary = find_boundary(rank_source, rank_target, offset_lon, offset_lat, step);
-            for (uint lon_rank = boundary.min_lon; lon_rank <= boundary.max_lon; lon_rank++) {
-                for (uint lat_rank = boundary.min_lat; lat_rank <= boundary.max_lat; lat_rank++) {
-                    auto center = type::GeographicalCoord(heat_map.body[lon_rank].first.min_coord + width_step / 2,
-                                                          heat_map.header[lat_rank].min_coord + height_step / 2);
-                    auto proj = center.approx_project(source, target, coslat);
-                    auto length = double(proj.second);
-                    if (length < min_dist
-                        && (!dist_pixel[lon_rank][lat_rank].distance
-                            || length < *dist_pixel[lon_rank][lat_rank].distance)) {
-                        dist_pixel[lon_rank][lat_rank].distance = length;
-                        dist_pixel[lon_rank][lat_rank].source = it->element;
-                        dist_pixel[lon_rank][lat_rank].target = v;
-                    }
-                }
-            }
+            segments.emplace_back(source, target, item.element, v, boundary);
         }
-    }
-    return dist_pixel;
+    });
+    return segments;
 }
 
 HeatMap fill_heat_map(const BoundBox& box,
@@ -193,51 +241,91 @@ HeatMap fill_heat_map(const BoundBox& box,
                       const double max_duration,
                       const double speed,
                       const std::vector<navitia::time_duration>& distances,
-                      const size_t step) {
+                      const size_t step,
+                      const size_t nb_threads) {
     auto heat_map = HeatMap(step, box, height_step, width_step);
-    auto projection = find_projection(box, height_step, width_step, worker, min_dist, heat_map, step);
-    for (size_t i = 0; i < step; i++) {
-        for (size_t j = 0; j < step; j++) {
-            auto& duration = heat_map.body[i].second[j];
-            if (projection[i][j].distance) {
-                auto center = type::GeographicalCoord(heat_map.body[i].first.min_coord + width_step / 2,
-                                                      heat_map.header[j].min_coord + height_step / 2);
-                const auto source = worker.graph[projection[i][j].source].coord;
-                const auto target = worker.graph[projection[i][j].target].coord;
-                const auto coslat = cos(center.lat() * type::GeographicalCoord::N_DEG_TO_RAD);
-                const auto duration_to_source =
-                    distances[projection[i][j].source]
-                    + navitia::milliseconds(sqrt(center.approx_sqr_distance(source, coslat)) / speed * 1e3);
-                const auto duration_to_target =
-                    distances[projection[i][j].target]
-                    + navitia::milliseconds(sqrt(center.approx_sqr_distance(target, coslat)) / speed * 1e3);
-                const auto new_duration = std::min(duration_to_source, duration_to_target);
-                if (new_duration.total_seconds() < max_duration) {
-                    duration = new_duration;
-                } else {
-                    duration = bt::pos_infin;
+    const auto segments = find_segments(box, height_step, width_step, worker, min_dist, step);
+    const auto box_coslat = cos((box.min.lat() + box.max.lat()) / 2 * type::GeographicalCoord::N_DEG_TO_RAD);
+
+    // each thread takes the next stripe of lines not filled yet, projects the
+    // segments on its cells then computes their durations
+    const size_t nb_stripes = (step + RASTER_STRIPE_HEIGHT - 1) / RASTER_STRIPE_HEIGHT;
+    std::atomic<size_t> next_stripe{0};
+    auto fill_stripes = [&]() {
+        std::vector<Projection> projection;
+        for (size_t stripe = next_stripe++; stripe < nb_stripes; stripe = next_stripe++) {
+            const size_t begin_lon = stripe * RASTER_STRIPE_HEIGHT;
+            const size_t end_lon = std::min(step, begin_lon + RASTER_STRIPE_HEIGHT);
+            projection.assign((end_lon - begin_lon) * step, Projection());
+            for (const auto& segment : segments) {
+                const auto& boundary = segment.boundary;
+                const auto min_lon = std::max(boundary.min_lon, begin_lon);
+                const auto max_lon = std::min(boundary.max_lon, end_lon - 1);
+                for (size_t lon_rank = min_lon; lon_rank <= max_lon; lon_rank++) {
+                    for (size_t lat_rank = boundary.min_lat; lat_rank <= boundary.max_lat; lat_rank++) {
+                        auto center = type::GeographicalCoord(heat_map.lines[lon_rank].min_coord + width_step / 2,
+                                                              heat_map.header[lat_rank].min_coord + height_step / 2);
+                        auto proj = center.approx_project(segment.source_coord, segment.target_coord, box_coslat);
+                        auto length = double(proj.second);
+                        auto& pixel = projection[(lon_rank - begin_lon) * step + lat_rank];
+                        if (length < min_dist && (!pixel.distance || length < *pixel.distance)) {
+                            pixel = Projection(length, segment.source, segment.target);
+                        }
+                    }
+                }
+            }
+            for (size_t i = begin_lon; i < end_lon; i++) {
+                for (size_t j = 0; j < step; j++) {
+                    const auto& pixel = projection[(i - begin_lon) * step + j];
+                    if (!pixel.distance) {
+                        continue;
+                    }
+                    auto center = type::GeographicalCoord(heat_map.lines[i].min_coord + width_step / 2,
+                                                          heat_map.header[j].min_coord + height_step / 2);
+                    const auto source = worker.graph[pixel.source].coord;
+                    const auto target = worker.graph[pixel.target].coord;
+                    const auto coslat = cos(center.lat() * type::GeographicalCoord::N_DEG_TO_RAD);
+                    const auto duration_to_source =
+                        distances[pixel.source]
+                        + navitia::milliseconds(sqrt(center.approx_sqr_distance(source, coslat)) / speed * 1e3);
+                    const auto duration_to_target =
+                        distances[pixel.target]
+                        + navitia::milliseconds(sqrt(center.approx_sqr_distance(target, coslat)) / speed * 1e3);
+                    const auto new_duration = std::min(duration_to_source, duration_to_target);
+                    if (new_duration.total_seconds() < max_duration) {
+                        heat_map.set_duration(i, j, new_duration);
+                    }
                 }
-            } else {
-                duration = bt::pos_infin;
             }
         }
+    };
+
+    const size_t nb_fill_threads = std::max(size_t(1), std::min(nb_threads, nb_stripes));
+    std::vector<std::future<void>> futures;
+    for (size_t thread = 1; thread < nb_fill_threads; ++thread) {
+        futures.push_back(std::async(std::launch::async, fill_stripes));
+    }
+    fill_stripes();
+    for (auto& future : futures) {
+        // rethrow the exceptions of the other threads
+        future.get();
     }
     return heat_map;
 }
 
-static std::string build_grid(const georef::GeoRef& worker,
-                              const BoundBox& box,
-                              const std::vector<navitia::time_duration>& distances,
-                              const double speed,
-                              const double max_duration,
-                              const uint resolution) {
+static HeatMap build_grid(const georef::GeoRef& worker,
+                          const BoundBox& box,
+                          const std::vector<navitia::time_duration>& distances,
+                          const double speed,
+                          const double max_duration,
+                          const uint resolution,
+                          const size_t nb_threads) {
     double width_step = (box.max.lon() - box.min.lon()) / resolution;
     double height_step = (box.max.lat() - box.min.lat()) / resolution;
     auto min_dist = std::max(500., width_step * N_DEG_TO_DISTANCE);
     min_dist = std::max(min_dist, height_step * N_DEG_TO_DISTANCE);
-    auto heat_map =
-        fill_heat_map(box, height_step, width_step, worker, min_dist, max_duration, speed, distances, resolution);
-    return print_grid(heat_map);
+    return fill_heat_map(box, height_step, width_step, worker, min_dist, max_duration, speed, distances, resolution,
+                         nb_threads);
 }
 
 static double walking_distance(const DateTime& max_duration, const DateTime& duration, const double speed) {
@@ -343,16 +431,16 @@ static BoundBox find_boundary_box(const georef::GeoRef& worker,
     return box;
 }
 
-std::string build_raster_isochrone(const georef::GeoRef& worker,
-                                   const double& speed,
-                                   const type::Mode_e& mode,
-                                   const DateTime init_dt,
-                                   RAPTOR& raptor,
-                                   const type::GeographicalCoord& coord_origin,
-                                   const DateTime duration,
-                                   const bool clockwise,
-                                   const DateTime bound,
-                                   const uint resolution) {
+HeatMap build_raster_isochrone(const georef::GeoRef& worker,
+                               const double& speed,
+                               const type::Mode_e& mode,
+                               const DateTime init_dt,
+                               RAPTOR& raptor,
+                               const type::GeographicalCoord& coord_origin,
+                               const DateTime duration,
+                               const bool clockwise,
+                               const DateTime bound,
+                               const uint resolution) {
     const auto& stop_points = raptor.data.pt_data->stop_points;
     std::vector<georef::vertex_t> predecessors;
     size_t n = boost::num_vertices(worker.graph);
@@ -375,7 +463,7 @@ std::string build_raster_isochrone(const georef::GeoRef& worker,
             visitor);
     } catch (georef::DestinationFound) {
     }
-    return build_grid(worker, box, distances, speed, duration, resolution);
+    return build_grid(worker, box, distances, speed, duration, resolution, raptor.nb_heat_map_threads);
 }
 
 }  // namespace routing
@@ -33,6 +33,8 @@ www.navitia.io
 #include "isochrone.h"
 #include "raptor.h"
 
+#include <limits>
+
 namespace navitia {
 namespace routing {
 
@@ -69,28 +71,49 @@ struct BoundBox {
         this->min = type::GeographicalCoord(lon_min, lat_min);
     }
 
-    bool contains(const type::GeographicalCoord& coord) {
+    bool contains(const type::GeographicalCoord& coord) const {
         return this->max.lon() >= coord.lon() && this->max.lat() >= coord.lat() && this->min.lon() <= coord.lon()
                && this->min.lat() <= coord.lat();
     }
 };
 
+constexpr static uint16_t HEAT_MAP_UNREACHED = std::numeric_limits<uint16_t>::max();
+
+/*
+ * Durations of a grid of cells, line by line, a line being a longitude and a
+ * column a latitude. The durations are stored in seconds on 16 bits, the
+ * cells not reached (or reached after HEAT_MAP_UNREACHED seconds) are HEAT_MAP_UNREACHED.
+ */
 struct HeatMap {
     std::vector<SingleCoord> header;
-    std::vector<std::pair<SingleCoord, std::vector<navitia::time_duration>>> body;
-    HeatMap(const std::vector<SingleCoord>& header,
-            const std::vector<std::pair<SingleCoord, std::vector<navitia::time_duration>>>& body)
-        : header(header), body(body) {}
+    std::vector<SingleCoord> lines;
+    std::vector<uint16_t> durations;
+
+    HeatMap(const std::vector<SingleCoord>& header, const std::vector<SingleCoord>& lines)
+        : header(header), lines(lines), durations(header.size() * lines.size(), HEAT_MAP_UNREACHED) {}
 
     HeatMap(const uint step, const BoundBox& box, const double height_step, const double width_step) {
         for (uint i = 0; i < step; i++) {
-            auto lon = SingleCoord(box.min.lon() + i * width_step, width_step);
-            for (uint j = 0; j < step; j++) {
-                if (i == 0) {
-                    header.push_back(SingleCoord((box.min.lat() + j * height_step), height_step));
-                }
-            }
-            body.push_back({lon, std::vector<navitia::time_duration>{step, bt::pos_infin}});
+            lines.push_back(SingleCoord(box.min.lon() + i * width_step, width_step));
+            header.push_back(SingleCoord(box.min.lat() + i * height_step, height_step));
+        }
+        durations.assign(size_t(step) * step, HEAT_MAP_UNREACHED);
+    }
+
+    navitia::time_duration get_duration(const size_t line, const size_t column) const {
+        const auto duration = durations[line * header.size() + column];
+        if (duration == HEAT_MAP_UNREACHED) {
+            return bt::pos_infin;
+        }
+        return navitia::seconds(duration);
+    }
+
+    void set_duration(const size_t line, const size_t column, const navitia::time_duration& duration) {
+        auto& cell = durations[line * header.size() + column];
+        if (duration.is_pos_infinity() || duration.total_seconds() >= HEAT_MAP_UNREACHED) {
+            cell = HEAT_MAP_UNREACHED;
+        } else {
+            cell = uint16_t(duration.total_seconds());
         }
     }
 };
@@ -116,20 +139,33 @@ HeatMap fill_heat_map(const BoundBox& box,
                       const double max_duration,
                       const double speed,
                       const std::vector<navitia::time_duration>& distances,
-                      const size_t step);
+                      const size_t step,
+                      const size_t nb_threads = 1);
 
 std::string print_grid(const HeatMap& heat_map);
 
-std::string build_raster_isochrone(const georef::GeoRef& worker,
-                                   const double& speed,
-                                   const type::Mode_e& mode,
-                                   const DateTime init_dt,
-                                   RAPTOR& raptor,
-                                   const type::GeographicalCoord& coord_origin,
-                                   const DateTime duration,
-                                   const bool clockwise,
-                                   const DateTime bound,
-                                   const uint resolution);
+/*
+ * Compact binary encoding of the heat map:
+ *  - the number of lines and of columns, as varints,
+ *  - the min and step of the longitudes then of the latitudes, as little
+ *    endian doubles,
+ *  - the cells line by line, as zigzag varints of the difference with the
+ *    previous cell, a cell being 0 if not reached, or its duration + 1.
+ * Neighbouring cells having close durations, most of them fit in one or
+ * two bytes.
+ */
+std::string encode_grid(const HeatMap& heat_map);
+
+HeatMap build_raster_isochrone(const georef::GeoRef& worker,
+                               const double& speed,
+                               const type::Mode_e& mode,
+                               const DateTime init_dt,
+                               RAPTOR& raptor,
+                               const type::GeographicalCoord& coord_origin,
+                               const DateTime duration,
+                               const bool clockwise,
+                               const DateTime bound,
+                               const uint resolution);
 
 }  // namespace routing
 }  // namespace navitia
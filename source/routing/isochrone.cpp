@@ -37,6 +37,10 @@ www.navitia.io
 
 #include <set>
 #include <assert.h>
+#include <atomic>
+#include <future>
+#include <limits>
+#include <unordered_map>
 #include <vector>
 #include <boost/geometry.hpp>
 #include <boost/geometry/geometries/polygon.hpp>
@@ -139,94 +143,367 @@ type::Polygon circle(const type::GeographicalCoord& center, const double& radius
     return points;
 }
 
-static type::MultiPolygon merge_poly(const type::MultiPolygon& multi_poly, const type::Polygon& poly) {
-    type::MultiPolygon poly_union;
-    try {
-        boost::geometry::union_(poly, multi_poly, poly_union);
-    } catch (const boost::geometry::exception& e) {
-        // We don't merge the polygons
-        log4cplus::Logger logger = log4cplus::Logger::getInstance("logger");
-        LOG4CPLUS_WARN(logger, "impossible to merge polygon: " << e.what());
-    }
-    return poly_union;
+DateTime build_bound(const bool clockwise, const DateTime duration, const DateTime init_dt) {
+    return clockwise ? init_dt + duration : init_dt - duration;
 }
 
-struct InfoCircle {
+// A point reached `duration` seconds after the origin, from which one keeps on walking
+struct IsochroneSource {
     type::GeographicalCoord center;
-    int duration_left;
-    InfoCircle(const type::GeographicalCoord& center, const int& duration_left)
-        : center(center), duration_left(duration_left) {}
+    int duration;
+    IsochroneSource(const type::GeographicalCoord& center, const int duration) : center(center), duration(duration) {}
 };
 
-static bool within_info_circle(const InfoCircle& circle,
-                               const std::vector<InfoCircle>& multi_poly,
-                               const double speed) {
-    auto begin = multi_poly.begin();
-    const auto end = multi_poly.end();
-    double circle_radius = circle.duration_left * speed;
-    double coslat = cos(circle.center.lat() * type::GeographicalCoord::N_DEG_TO_RAD);
-    return any_of(begin, end, [&](const InfoCircle& it) {
-        double it_radius = it.duration_left * speed;
-        return sqrt(circle.center.approx_sqr_distance(it.center, coslat)) + circle_radius < it_radius;
-    });
+static std::vector<IsochroneSource> get_isochrone_sources(RAPTOR& raptor,
+                                                          const std::vector<type::StopPoint*>& stop_points,
+                                                          const bool clockwise,
+                                                          const type::GeographicalCoord& coord_origin,
+                                                          const DateTime& bound,
+                                                          const map_stop_point_duration& origin,
+                                                          const int duration) {
+    std::vector<IsochroneSource> sources;
+    sources.emplace_back(coord_origin, 0);
+    const auto& data_departure = raptor.data.pt_data->stop_points;
+    for (const auto& sp_duration : origin) {
+        const int departure_duration = int(sp_duration.second.total_seconds());
+        if (departure_duration < duration) {
+            sources.emplace_back(data_departure[sp_duration.first.val]->coord, departure_duration);
+        }
+    }
+    for (const type::StopPoint* sp : stop_points) {
+        const auto best_lbl = raptor.best_labels_pts[SpIdx(*sp)];
+        if (in_bound(best_lbl, bound, clockwise)) {
+            sources.emplace_back(sp->coord, duration - abs(int(best_lbl) - int(bound)));
+        }
+    }
+    return sources;
 }
 
-static std::vector<InfoCircle> delete_useless_circle(std::vector<InfoCircle> circles, const double speed) {
-    std::vector<InfoCircle> useful_circles;
-    boost::sort(circles, [](const InfoCircle& a, const InfoCircle& b) { return a.duration_left > b.duration_left; });
-    for (auto& circle : circles) {
-        if (!within_info_circle(circle, useful_circles, speed)) {
-            useful_circles.push_back(std::move(circle));
+/*
+ * Minimal duration needed to reach each node of a regular grid of
+ * cell_size meters.
+ *
+ * The grid is an equirectangular projection anchored on the origin of the
+ * isochrone: the node (i, j) is at i * cell_size meters east and
+ * j * cell_size meters north of the anchor, whatever the extent of the
+ * raster. Two rasters with the same cell size thus share the nodes they
+ * have in common.
+ */
+struct DurationRaster {
+    type::GeographicalCoord anchor;
+    double cell_size = 0;
+    double lon_step = 0;  // degrees between two columns
+    double lat_step = 0;  // degrees between two rows
+    int i_min = 0;        // index of the first column
+    int j_min = 0;        // index of the first row
+    size_t nx = 0;
+    size_t ny = 0;
+    std::vector<float> durations;  // row major, infinity where nothing is reached
+
+    size_t node(const size_t i, const size_t j) const { return j * nx + i; }
+
+    // coordinate of a point given in columns and rows from the first node
+    type::GeographicalCoord coord(const double x, const double y) const {
+        return {anchor.lon() + (i_min + x) * lon_step, anchor.lat() + (j_min + y) * lat_step};
+    }
+};
+
+// Disc walked around a source before the maximum duration, in meters from the anchor
+struct RasterDisc {
+    double x;
+    double y;
+    double radius;
+    double duration;
+};
+
+static DurationRaster rasterize(const std::vector<IsochroneSource>& sources,
+                                const type::GeographicalCoord& anchor,
+                                const double speed,
+                                const int max_duration,
+                                const size_t nb_isochrone_threads) {
+    using type::GeographicalCoord;
+    DurationRaster raster;
+    raster.anchor = anchor;
+    const double meters_per_deg_lat = GeographicalCoord::N_DEG_TO_RAD * GeographicalCoord::EARTH_RADIUS_IN_METERS;
+    const double meters_per_deg_lon = meters_per_deg_lat * cos(anchor.lat() * GeographicalCoord::N_DEG_TO_RAD);
+
+    std::vector<RasterDisc> discs;
+    double x_min = std::numeric_limits<double>::max();
+    double x_max = std::numeric_limits<double>::lowest();
+    double y_min = x_min;
+    double y_max = x_max;
+    for (const auto& source : sources) {
+        const double radius = (max_duration - source.duration) * speed;
+        if (radius <= 0) {
+            continue;
+        }
+        const double x = (source.center.lon() - anchor.lon()) * meters_per_deg_lon;
+        const double y = (source.center.lat() - anchor.lat()) * meters_per_deg_lat;
+        discs.push_back({x, y, radius, double(source.duration)});
+        x_min = std::min(x_min, x - radius);
+        x_max = std::max(x_max, x + radius);
+        y_min = std::min(y_min, y - radius);
+        y_max = std::max(y_max, y + radius);
+    }
+    if (discs.empty()) {
+        return raster;
+    }
+
+    raster.cell_size = std::max(RASTER_MIN_CELL_SIZE, std::max(x_max - x_min, y_max - y_min) / RASTER_MAX_NB_CELLS);
+    raster.lon_step = raster.cell_size / meters_per_deg_lon;
+    raster.lat_step = raster.cell_size / meters_per_deg_lat;
+    // one node of margin, so that the border of the raster is outside of every disc
+    raster.i_min = int(std::floor(x_min / raster.cell_size)) - 1;
+    raster.j_min = int(std::floor(y_min / raster.cell_size)) - 1;
+    raster.nx = size_t(int(std::ceil(x_max / raster.cell_size)) + 1 - raster.i_min + 1);
+    raster.ny = size_t(int(std::ceil(y_max / raster.cell_size)) + 1 - raster.j_min + 1);
+    raster.durations.assign(raster.nx * raster.ny, std::numeric_limits<float>::infinity());
+
+    // each thread takes the next stripe of rows not stamped yet, so that no
+    // node is written by two threads
+    const size_t nb_stripes = (raster.ny + RASTER_STRIPE_HEIGHT - 1) / RASTER_STRIPE_HEIGHT;
+    std::atomic<size_t> next_stripe{0};
+    auto stamp_stripes = [&]() {
+        for (size_t stripe = next_stripe++; stripe < nb_stripes; stripe = next_stripe++) {
+            const int stripe_begin = raster.j_min + int(stripe * RASTER_STRIPE_HEIGHT);
+            const int stripe_end = std::min(stripe_begin + int(RASTER_STRIPE_HEIGHT), raster.j_min + int(raster.ny));
+            for (const auto& disc : discs) {
+                const int j_begin = std::max(stripe_begin, int(std::ceil((disc.y - disc.radius) / raster.cell_size)));
+                const int j_end = std::min(stripe_end, int(std::floor((disc.y + disc.radius) / raster.cell_size)) + 1);
+                const int i_begin = int(std::ceil((disc.x - disc.radius) / raster.cell_size));
+                const int i_end = int(std::floor((disc.x + disc.radius) / raster.cell_size)) + 1;
+                const double sqr_radius = disc.radius * disc.radius;
+                for (int j = j_begin; j < j_end; ++j) {
+                    const double dy = j * raster.cell_size - disc.y;
+                    float* row = &raster.durations[raster.node(0, size_t(j - raster.j_min))];
+                    for (int i = i_begin; i < i_end; ++i) {
+                        const double dx = i * raster.cell_size - disc.x;
+                        const double sqr_distance = dx * dx + dy * dy;
+                        if (sqr_distance >= sqr_radius) {
+                            continue;
+                        }
+                        float& node_duration = row[i - raster.i_min];
+                        node_duration = std::min(node_duration, float(disc.duration + std::sqrt(sqr_distance) / speed));
+                    }
+                }
+            }
         }
+    };
+
+    const size_t nb_threads = std::max(size_t(1), std::min(nb_isochrone_threads, nb_stripes));
+    std::vector<std::future<void>> futures;
+    for (size_t thread = 1; thread < nb_threads; ++thread) {
+        futures.push_back(std::async(std::launch::async, stamp_stripes));
+    }
+    stamp_stripes();
+    for (auto& future : futures) {
+        // rethrow the exceptions of the other threads
+        future.get();
     }
-    return useful_circles;
+    return raster;
 }
 
-DateTime build_bound(const bool clockwise, const DateTime duration, const DateTime init_dt) {
-    return clockwise ? init_dt + duration : init_dt - duration;
+// Ring in columns and rows of the raster, counter-clockwise around the
+// nodes it contains
+using RasterRing = std::vector<std::pair<double, double>>;
+
+static double signed_area(const RasterRing& ring) {
+    double area = 0;
+    for (size_t k = 0, prev = ring.size() - 1; k < ring.size(); prev = k++) {
+        area += ring[prev].first * ring[k].second - ring[k].first * ring[prev].second;
+    }
+    return area / 2;
 }
 
-type::MultiPolygon build_single_isochrone(RAPTOR& raptor,
-                                          const std::vector<type::StopPoint*>& stop_points,
-                                          const bool clockwise,
-                                          const type::GeographicalCoord& coord_origin,
-                                          const DateTime& bound,
-                                          const map_stop_point_duration& origin,
-                                          const double& speed,
-                                          const int& duration) {
-    std::vector<InfoCircle> circles_classed;
-    type::MultiPolygon circles;
-    circles_classed.push_back(InfoCircle(coord_origin, duration));
-    const auto& data_departure = raptor.data.pt_data->stop_points;
-    for (auto it = origin.begin(); it != origin.end(); ++it) {
-        if (it->second.total_seconds() < duration) {
-            int duration_left = duration - int(it->second.total_seconds());
-            if (duration_left * speed < MIN_RADIUS) {
+static bool within_ring(const std::pair<double, double>& point, const RasterRing& ring) {
+    bool within = false;
+    for (size_t k = 0, prev = ring.size() - 1; k < ring.size(); prev = k++) {
+        const auto& a = ring[prev];
+        const auto& b = ring[k];
+        if ((a.second > point.second) != (b.second > point.second)
+            && point.first < a.first + (point.second - a.second) * (b.first - a.first) / (b.second - a.second)) {
+            within = !within;
+        }
+    }
+    return within;
+}
+
+// The rings of the raster are counter-clockwise around their inside, boost
+// polygons are clockwise and closed
+static type::Polygon::ring_type to_ring(const DurationRaster& raster, const RasterRing& raster_ring) {
+    type::Polygon::ring_type ring;
+    ring.reserve(raster_ring.size() + 1);
+    for (auto it = raster_ring.rbegin(); it != raster_ring.rend(); ++it) {
+        ring.push_back(raster.coord(it->first, it->second));
+    }
+    ring.push_back(ring.front());
+    return ring;
+}
+
+static type::MultiPolygon build_polygons(const DurationRaster& raster, const std::vector<RasterRing>& rings) {
+    struct Outer {
+        const RasterRing* ring;
+        double area;
+        std::pair<double, double> min_corner;
+        std::pair<double, double> max_corner;
+        size_t polygon;
+    };
+    type::MultiPolygon polygons;
+    std::vector<Outer> outers;
+    std::vector<const RasterRing*> holes;
+    for (const auto& ring : rings) {
+        const double area = signed_area(ring);
+        if (area < 0) {
+            holes.push_back(&ring);
+            continue;
+        }
+        Outer outer{&ring, area, ring.front(), ring.front(), polygons.size()};
+        for (const auto& point : ring) {
+            outer.min_corner = {std::min(outer.min_corner.first, point.first),
+                                std::min(outer.min_corner.second, point.second)};
+            outer.max_corner = {std::max(outer.max_corner.first, point.first),
+                                std::max(outer.max_corner.second, point.second)};
+        }
+        outers.push_back(outer);
+        polygons.resize(polygons.size() + 1);
+        polygons.back().outer() = to_ring(raster, ring);
+    }
+    // A hole goes into the smallest outer ring containing it. The rings of a
+    // band never share a point, any point of the hole can be tested.
+    for (const auto* hole : holes) {
+        const auto& point = hole->front();
+        const Outer* best = nullptr;
+        for (const auto& outer : outers) {
+            if (point.first < outer.min_corner.first || point.first > outer.max_corner.first
+                || point.second < outer.min_corner.second || point.second > outer.max_corner.second
+                || (best && best->area <= outer.area) || !within_ring(point, *outer.ring)) {
                 continue;
             }
-            const auto& center = data_departure[it->first.val]->coord;
-            circles_classed.push_back(InfoCircle(center, duration_left));
+            best = &outer;
+        }
+        if (best) {
+            polygons[best->polygon].inners().push_back(to_ring(raster, *hole));
         }
     }
-    for (const type::StopPoint* sp : stop_points) {
-        SpIdx sp_idx(*sp);
-        const auto best_lbl = raptor.best_labels_pts[sp_idx];
-        if (in_bound(best_lbl, bound, clockwise)) {
-            uint duration_left = abs(int(best_lbl) - int(bound));
-            if (duration_left * speed < MIN_RADIUS) {
+    return polygons;
+}
+
+/*
+ * Extract the polygons of the bands of the raster with marching squares, in
+ * a single pass over the cells for all the bands.
+ *
+ * The level of a node is the number of thresholds lower or equal to its
+ * duration, a band is a range [first, last) of levels. The contour points
+ * are the middles of the edges between a node of the band and a node outside
+ * of it, so two bands sharing a threshold have exactly the same border.
+ */
+static std::vector<type::MultiPolygon> extract_bands(const DurationRaster& raster,
+                                                     const std::vector<DateTime>& thresholds,
+                                                     const std::vector<std::pair<size_t, size_t>>& bands) {
+    std::vector<type::MultiPolygon> polygons(bands.size());
+    if (raster.nx < 2 || raster.ny < 2) {
+        return polygons;
+    }
+    std::vector<size_t> levels(raster.durations.size());
+    for (size_t n = 0; n < levels.size(); ++n) {
+        levels[n] = size_t(std::upper_bound(thresholds.begin(), thresholds.end(), raster.durations[n],
+                                            [](const float duration, const DateTime threshold) {
+                                                return duration < float(threshold);
+                                            })
+                           - thresholds.begin());
+    }
+
+    // The edge of id 2 * node goes east from the node, 2 * node + 1 goes north.
+    // For each band, each contour segment links the edge it leaves the band by
+    // to the edge it enters by, with the band on its left.
+    std::vector<std::unordered_map<size_t, size_t>> next_edges(bands.size());
+    for (size_t j = 0; j + 1 < raster.ny; ++j) {
+        for (size_t i = 0; i + 1 < raster.nx; ++i) {
+            // corners and edges of the cell, counter-clockwise from the south west,
+            // the edge k going from the corner k to the corner k + 1
+            const size_t corners[4] = {raster.node(i, j), raster.node(i + 1, j), raster.node(i + 1, j + 1),
+                                       raster.node(i, j + 1)};
+            const size_t edges[4] = {2 * corners[0], 2 * corners[1] + 1, 2 * corners[3], 2 * corners[0] + 1};
+            const size_t cell_levels[4] = {levels[corners[0]], levels[corners[1]], levels[corners[2]],
+                                           levels[corners[3]]};
+            if (cell_levels[0] == cell_levels[1] && cell_levels[0] == cell_levels[2]
+                && cell_levels[0] == cell_levels[3]) {
                 continue;
             }
-            const auto& center = sp->coord;
-            circles_classed.push_back(InfoCircle(center, duration_left));
+            for (size_t b = 0; b < bands.size(); ++b) {
+                bool in[4];
+                size_t nb_in = 0;
+                for (size_t k = 0; k < 4; ++k) {
+                    in[k] = bands[b].first <= cell_levels[k] && cell_levels[k] < bands[b].second;
+                    nb_in += in[k];
+                }
+                if (nb_in == 0 || nb_in == 4) {
+                    continue;
+                }
+                // On a saddle, the two corners of the band are joined through
+                // the center of the cell, unless the two other corners are
+                // below the band: they are then joined in the lower band.
+                bool separated = false;
+                if (nb_in == 2 && in[0] == in[2]) {
+                    const size_t out = in[0] ? 1 : 0;
+                    separated = cell_levels[out] < bands[b].first && cell_levels[out + 2] < bands[b].first;
+                }
+                for (size_t k = 0; k < 4; ++k) {
+                    if (!in[k] || in[(k + 1) % 4]) {
+                        continue;
+                    }
+                    for (size_t step = 1; step < 4; ++step) {
+                        const size_t e = separated ? (k + 4 - step) % 4 : (k + step) % 4;
+                        if (!in[e] && in[(e + 1) % 4]) {
+                            next_edges[b][edges[k]] = edges[e];
+                            break;
+                        }
+                    }
+                }
+            }
         }
     }
-    std::vector<InfoCircle> circles_check = delete_useless_circle(std::move(circles_classed), speed);
 
-    for (const auto& c : circles_check) {
-        type::Polygon circle_to_add = circle(c.center, c.duration_left * speed);
-        circles = merge_poly(circles, circle_to_add);
+    for (size_t b = 0; b < bands.size(); ++b) {
+        auto& next_edge = next_edges[b];
+        std::vector<RasterRing> rings;
+        while (!next_edge.empty()) {
+            RasterRing ring;
+            const size_t first_edge = next_edge.begin()->first;
+            size_t edge = first_edge;
+            do {
+                const size_t node = edge / 2;
+                const double x = double(node % raster.nx);
+                const double y = double(node / raster.nx);
+                ring.push_back(edge % 2 ? std::make_pair(x, y + 0.5) : std::make_pair(x + 0.5, y));
+                const auto it = next_edge.find(edge);
+                if (it == next_edge.end()) {
+                    break;
+                }
+                edge = it->second;
+                next_edge.erase(it);
+            } while (edge != first_edge);
+            if (ring.size() >= 3) {
+                rings.push_back(std::move(ring));
+            }
+        }
+        polygons[b] = build_polygons(raster, rings);
     }
-    return circles;
+    return polygons;
+}
+
+type::MultiPolygon build_single_isochrone(RAPTOR& raptor,
+                                          const std::vector<type::StopPoint*>& stop_points,
+                                          const bool clockwise,
+                                          const type::GeographicalCoord& coord_origin,
+                                          const DateTime& bound,
+                                          const map_stop_point_duration& origin,
+                                          const double& speed,
+                                          const int& duration) {
+    const auto sources = get_isochrone_sources(raptor, stop_points, clockwise, coord_origin, bound, origin, duration);
+    const auto raster = rasterize(sources, coord_origin, speed, duration, raptor.nb_isochrone_threads);
+    const std::vector<std::pair<size_t, size_t>> bands = {{0, 1}};
+    return std::move(extract_bands(raster, {DateTime(duration)}, bands).front());
 }
 
 std::vector<Isochrone> build_isochrones(RAPTOR& raptor,
@@ -237,24 +514,35 @@ std::vector<Isochrone> build_isochrones(RAPTOR& raptor,
                                         const std::vector<DateTime>& boundary_duration,
                                         const DateTime init_dt) {
     std::vector<Isochrone> isochrone;
-    if (!boundary_duration.empty()) {
-        type::MultiPolygon max_isochrone = build_single_isochrone(
-            raptor, raptor.data.pt_data->stop_points, clockwise, coord_origin,
-            build_bound(clockwise, boundary_duration[0], init_dt), origin, speed, boundary_duration[0]);
-        for (size_t i = 1; i < boundary_duration.size(); i++) {
-            type::MultiPolygon output;
-            if (boundary_duration[i] > 0) {
-                type::MultiPolygon min_isochrone = build_single_isochrone(
-                    raptor, raptor.data.pt_data->stop_points, clockwise, coord_origin,
-                    build_bound(clockwise, boundary_duration[i], init_dt), origin, speed, boundary_duration[i]);
-                boost::geometry::difference(max_isochrone, min_isochrone, output);
-                max_isochrone = std::move(min_isochrone);
-            } else {
-                output = max_isochrone;
-            }
-            isochrone.push_back(Isochrone(std::move(output), boundary_duration[i], boundary_duration[i - 1]));
+    if (boundary_duration.size() < 2) {
+        return isochrone;
+    }
+    const DateTime max_duration = *boost::max_element(boundary_duration);
+    const auto sources =
+        get_isochrone_sources(raptor, raptor.data.pt_data->stop_points, clockwise, coord_origin,
+                              build_bound(clockwise, max_duration, init_dt), origin, int(max_duration));
+    const auto raster = rasterize(sources, coord_origin, speed, int(max_duration), raptor.nb_isochrone_threads);
+
+    std::vector<DateTime> thresholds;
+    for (const auto duration : boundary_duration) {
+        if (duration > 0) {
+            thresholds.push_back(duration);
         }
     }
+    boost::sort(thresholds);
+    thresholds.erase(std::unique(thresholds.begin(), thresholds.end()), thresholds.end());
+    const auto level = [&](const DateTime duration) {
+        return size_t(std::upper_bound(thresholds.begin(), thresholds.end(), duration) - thresholds.begin());
+    };
+    std::vector<std::pair<size_t, size_t>> bands;
+    for (size_t i = 1; i < boundary_duration.size(); i++) {
+        bands.emplace_back(level(boundary_duration[i]), level(boundary_duration[i - 1]));
+    }
+
+    auto shapes = extract_bands(raster, thresholds, bands);
+    for (size_t i = 1; i < boundary_duration.size(); i++) {
+        isochrone.push_back(Isochrone(std::move(shapes[i - 1]), boundary_duration[i], boundary_duration[i - 1]));
+    }
     std::reverse(isochrone.begin(), isochrone.end());
     return isochrone;
 }
@@ -48,8 +48,12 @@ struct IsochroneException : public recoverable_exception {
 
 constexpr static double N_RAD_TO_DEG = 57.295779513;
 
-// Delete the circles too small to avoid rounding error in meter
-constexpr static double MIN_RADIUS = 5;
+// Side in meters of the cells of the raster the isochrones are extracted from
+constexpr static double RASTER_MIN_CELL_SIZE = 20;
+// Maximum number of cells on each side of that raster, bigger isochrones get bigger cells
+constexpr static double RASTER_MAX_NB_CELLS = 1000;
+// Number of rows of the raster filled at once by a thread
+constexpr static size_t RASTER_STRIPE_HEIGHT = 16;
 
 type::GeographicalCoord project_in_direction(const type::GeographicalCoord& center,
                                              const double& direction,
@@ -65,7 +69,8 @@ bool in_bound(const T& begin, const T& end, bool clockwise) {
 
 DateTime build_bound(const bool clockwise, const DateTime duration, const DateTime init_dt);
 
-// Create a multi polygon with circles around all the stop points in the isochrone
+// Create a multi polygon covering the points reachable before the bound, walking
+// at the given speed from the origin and from the stop points reached
 type::MultiPolygon build_single_isochrone(RAPTOR& raptor,
                                           const std::vector<type::StopPoint*>& stop_points,
                                           const bool clockwise,
@@ -83,6 +88,8 @@ struct Isochrone {
         : shape(std::move(shape)), min_duration(min_duration), max_duration(max_duration) {}
 };
 
+// Create the isochrones between each pair of consecutive boundaries (in
+// decreasing order), all extracted from a single raster of the durations
 std::vector<Isochrone> build_isochrones(RAPTOR& raptor,
                                         const bool clockwise,
                                         const type::GeographicalCoord& coord_origin,
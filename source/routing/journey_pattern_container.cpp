@@ -71,6 +71,63 @@ void JourneyPatternContainer::load(const nt::PT_Data& pt_data) {
     }
 }
 
+// Replaces the vjs by their translation, the untranslated ones being
+// removed. Returns true if a vj has been removed.
+template <typename VJ>
+static bool translate_vjs(std::vector<const VJ*>& vjs, const std::vector<const nt::VehicleJourney*>& translation) {
+    const auto nb_vjs = vjs.size();
+    auto out = vjs.begin();
+    for (const auto* vj : vjs) {
+        if (const auto* new_vj = translation.at(vj->idx)) {
+            *out++ = static_cast<const VJ*>(new_vj);
+        }
+    }
+    vjs.erase(out, vjs.end());
+    return vjs.size() != nb_vjs;
+}
+
+boost::dynamic_bitset<> JourneyPatternContainer::update(const nt::PT_Data& pt_data,
+                                                        const JourneyPatternContainer& previous,
+                                                        const std::vector<const nt::VehicleJourney*>& translation,
+                                                        const std::vector<const nt::VehicleJourney*>& touched_vjs) {
+    map = previous.map;
+    jps = previous.jps;
+    jpps = previous.jpps;
+    jps_from_route = previous.jps_from_route;
+    jps_from_phy_mode = previous.jps_from_phy_mode;
+    jpps_from_phy_mode = previous.jpps_from_phy_mode;
+    jp_from_vj.assign(pt_data.vehicle_journeys);
+
+    boost::dynamic_bitset<> touched_jps(jps.size());
+    for (idx_t i = 0; i < jps.size(); ++i) {
+        const auto jp_idx = JpIdx(i);
+        auto& jp = get_mut(jp_idx);
+        const bool discrete_removed = translate_vjs(jp.discrete_vjs, translation);
+        const bool freq_removed = translate_vjs(jp.freq_vjs, translation);
+        if (discrete_removed || freq_removed) {
+            touched_jps.set(i);
+        }
+        jp.for_each_vehicle_journey([&](const nt::VehicleJourney& vj) {
+            jp_from_vj[VjIdx(vj)] = jp_idx;
+            return true;
+        });
+    }
+
+    for (const auto* vj : touched_vjs) {
+        if (const auto* discrete_vj = dynamic_cast<const nt::DiscreteVehicleJourney*>(vj)) {
+            add_vj(*discrete_vj);
+        } else if (const auto* freq_vj = dynamic_cast<const nt::FrequencyVehicleJourney*>(vj)) {
+            add_vj(*freq_vj);
+        } else {
+            continue;
+        }
+        // the new jps are touched
+        touched_jps.resize(jps.size(), true);
+        touched_jps.set(jp_from_vj[VjIdx(*vj)].val);
+    }
+    return touched_jps;
+}
+
 const JppIdx& JourneyPatternContainer::get_jpp(const type::StopTime& st) const {
     const auto& jp = get(jp_from_vj[VjIdx(*st.vehicle_journey)]);
     return jp.jpps.at(st.order());
@@ -32,11 +32,13 @@ www.navitia.io
 
 #include "raptor_utils.h"
 #include <boost/optional.hpp>
+#include <boost/dynamic_bitset.hpp>
 
 namespace navitia {
 namespace type {
 
 struct PT_Data;
+struct VehicleJourney;
 struct DiscreteVehicleJourney;
 struct FrequencyVehicleJourney;
 struct StopTime;
@@ -95,6 +97,15 @@ struct JourneyPatternContainer {
     using JppRange = boost::iterator_range<JppIterator>;
 
     void load(const navitia::type::PT_Data&);
+    // Updates the journey patterns of a previous data for its clone
+    // modified by a realtime batch. translation gives, by idx, the vj
+    // of pt_data corresponding to each vj of the previous data, or
+    // nullptr if the batch touched it, and touched_vjs are the vjs of
+    // pt_data to (re)insert. Returns the jps whose vjs have changed.
+    boost::dynamic_bitset<> update(const navitia::type::PT_Data&,
+                                   const JourneyPatternContainer& previous,
+                                   const std::vector<const type::VehicleJourney*>& translation,
+                                   const std::vector<const type::VehicleJourney*>& touched_vjs);
     size_t nb_jps() const { return jps.size(); }
     size_t nb_jpps() const { return jpps.size(); }
     const JourneyPattern& get(const JpIdx& idx) const {
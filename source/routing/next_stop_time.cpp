@@ -35,10 +35,19 @@ www.navitia.io
 #include "type/pt_data.h"
 #include "type/meta_data.h"
 #include "type/type_utils.h"
+#include "type/mapped_file.h"
 #include "utils/logger.h"
+#include "utils/exception.h"
 
+#include <boost/range/algorithm/lower_bound.hpp>
 #include <boost/range/algorithm/sort.hpp>
+#include <boost/range/algorithm/upper_bound.hpp>
 #include <boost/range/algorithm_ext/push_back.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <fstream>
+#include <cstring>
 
 namespace navitia {
 namespace routing {
@@ -91,6 +100,20 @@ void NextStopTimeData::TimesStopTimes<Getter>::init(const JourneyPattern& jp, co
     }
 }
 
+template <typename Getter>
+void NextStopTimeData::TimesStopTimes<Getter>::translate(
+    const TimesStopTimes& previous,
+    const std::vector<const type::VehicleJourney*>& translation) {
+    // the vjs are the same, thus the order is kept
+    times = previous.times;
+    stop_times.clear();
+    stop_times.reserve(previous.stop_times.size());
+    for (const auto* st : previous.stop_times) {
+        const auto* vj = translation.at(st->vehicle_journey->idx);
+        stop_times.push_back(&vj->stop_time_list[st->order()]);
+    }
+}
+
 void NextStopTimeData::load(const JourneyPatternContainer& jp_container) {
     departure.assign(jp_container.get_jpps_values());
     arrival.assign(jp_container.get_jpps_values());
@@ -104,6 +127,28 @@ void NextStopTimeData::load(const JourneyPatternContainer& jp_container) {
     }
 }
 
+void NextStopTimeData::update(const JourneyPatternContainer& jp_container,
+                              const NextStopTimeData& previous,
+                              const boost::dynamic_bitset<>& touched_jps,
+                              const std::vector<const type::VehicleJourney*>& translation) {
+    departure.assign(jp_container.get_jpps_values());
+    arrival.assign(jp_container.get_jpps_values());
+
+    for (const auto jp : jp_container.get_jps()) {
+        const bool touched = touched_jps[jp.first.val];
+        for (const auto& jpp_idx : jp.second.jpps) {
+            if (touched) {
+                const auto& jpp = jp_container.get(jpp_idx);
+                departure[jpp_idx].init(jp.second, jpp);
+                arrival[jpp_idx].init(jp.second, jpp);
+            } else {
+                departure[jpp_idx].translate(previous.departure[jpp_idx], translation);
+                arrival[jpp_idx].translate(previous.arrival[jpp_idx], translation);
+            }
+        }
+    }
+}
+
 inline static bool is_valid(const type::StopTime* st,
                             const DateTime date,
                             const bool clockwise,
@@ -497,9 +542,173 @@ std::shared_ptr<const CachedNextStopTime> CachedNextStopTimeManager::load(
     const type::RTLevel rt_level,
     const type::AccessibiliteParams& accessibilite_params) {
     CachedNextStopTimeKey key(DateTimeUtils::date(from), rt_level, accessibilite_params);
+    if (!snapshots.empty()) {
+        const auto it = snapshots.find(key);
+        if (it != snapshots.end()) {
+            return it->second;
+        }
+    }
     return lru(key);
 }
 
+namespace {
+
+/*
+ * Layout of a snapshots file, every field being a native uint64_t
+ * except the content of the caches:
+ *
+ *   magic, version, fingerprint of the data, nb_jpps, nb_snapshots
+ *   for each snapshot:
+ *     day
+ *     for the departures then the arrivals:
+ *       nb_dtsts
+ *       until: nb_jpps uint32_t
+ *       dtsts: nb_dtsts {uint32_t datetime, uint32_t vehicle journey idx}
+ *
+ * The stop times are found back with the vehicle journey and the order of the jpp.
+ */
+const uint64_t snapshots_magic = 0x6e6578745f737473;  // "next_sts"
+const uint64_t snapshots_version = 1;
+
+struct FlatDtSt {
+    uint32_t dt;
+    uint32_t vj_idx;
+};
+
+// identify the data the snapshots are built on
+uint64_t data_fingerprint(const type::Data& data, const JourneyPatternContainer& jp_container) {
+    size_t seed = 0;
+    boost::hash_combine(seed, boost::posix_time::to_iso_string(data.meta->publication_date));
+    boost::hash_combine(seed, data.pt_data->vehicle_journeys.size());
+    for (const auto& jpp : jp_container.get_jpps_values()) {
+        boost::hash_combine(seed, jpp.jp_idx.val);
+        boost::hash_combine(seed, jpp.sp_idx.val);
+        boost::hash_combine(seed, jpp.order);
+    }
+    return seed;
+}
+
+template <typename T>
+void write(std::ostream& os, const T* values, const size_t nb) {
+    os.write(reinterpret_cast<const char*>(values), sizeof(T) * nb);
+}
+
+// bounds checked reading of a mapped file
+struct Cursor {
+    const char* cur;
+    const char* end;
+
+    template <typename T>
+    const T* read(const size_t nb) {
+        if (size_t(end - cur) < sizeof(T) * nb) {
+            throw navitia::exception("truncated next stop time snapshots file");
+        }
+        const auto* res = reinterpret_cast<const T*>(cur);
+        cur += sizeof(T) * nb;
+        return res;
+    }
+    uint64_t read_u64() {
+        uint64_t res;
+        std::memcpy(&res, read<char>(sizeof(uint64_t)), sizeof(uint64_t));
+        return res;
+    }
+};
+
+}  // namespace
+
+void CachedNextStopTimeManager::save_snapshots(const std::string& filename,
+                                               const type::Data& data,
+                                               const CachedNextStopTimeKey::Day first_day,
+                                               const size_t nb_days) const {
+    const auto& jp_container = dataRaptor->jp_container;
+    const uint64_t nb_jpps = jp_container.nb_jpps();
+    const uint64_t header[] = {snapshots_magic, snapshots_version, data_fingerprint(data, jp_container), nb_jpps,
+                               nb_days};
+
+    std::ofstream ofs(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    ofs.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+    write(ofs, header, 5);
+
+    const CacheCreator creator(*dataRaptor);
+    for (size_t day = first_day; day < first_day + nb_days; ++day) {
+        const uint64_t u64_day = day;
+        write(ofs, &u64_day, 1);
+        const auto cache = creator({day, type::RTLevel::Base, type::AccessibiliteParams()});
+        for (const auto* dtst_from_jpp : {&cache.departure, &cache.arrival}) {
+            const uint64_t nb_dtsts = dtst_from_jpp->dtsts.size();
+            write(ofs, &nb_dtsts, 1);
+            std::vector<uint32_t> until;
+            until.reserve(nb_jpps);
+            for (const auto& jpp_until : dtst_from_jpp->until) {
+                until.push_back(jpp_until.second);
+            }
+            write(ofs, until.data(), until.size());
+            std::vector<FlatDtSt> flat_dtsts;
+            flat_dtsts.reserve(nb_dtsts);
+            for (const auto& dtst : dtst_from_jpp->dtsts) {
+                flat_dtsts.push_back({dtst.first, uint32_t(dtst.second->vehicle_journey->idx)});
+            }
+            write(ofs, flat_dtsts.data(), flat_dtsts.size());
+        }
+    }
+}
+
+size_t CachedNextStopTimeManager::load_snapshots(const std::string& filename, const type::Data& data) {
+    auto logger = log4cplus::Logger::getInstance("log");
+    const auto& jp_container = dataRaptor->jp_container;
+    const type::MappedFile file(filename);
+    Cursor cursor{file.begin, file.end()};
+
+    if (cursor.read_u64() != snapshots_magic || cursor.read_u64() != snapshots_version) {
+        throw navitia::exception(filename + " is not a next stop time snapshots file");
+    }
+    if (cursor.read_u64() != data_fingerprint(data, jp_container) || cursor.read_u64() != jp_container.nb_jpps()) {
+        LOG4CPLUS_WARN(logger, filename << " has not been built on the loaded data, it is ignored");
+        return 0;
+    }
+
+    const auto& vjs = data.pt_data->vehicle_journeys;
+    const auto nb_jpps = jp_container.nb_jpps();
+    std::map<CachedNextStopTimeKey, std::shared_ptr<const CachedNextStopTime>> loaded;
+    for (auto nb_snapshots = cursor.read_u64(); nb_snapshots > 0; --nb_snapshots) {
+        const auto day = cursor.read_u64();
+        std::vector<CachedNextStopTime::DtStFromJpp> dtst_from_jpps;
+        for (int i = 0; i < 2; ++i) {
+            const auto nb_dtsts = cursor.read_u64();
+            const auto* until_begin = cursor.read<uint32_t>(nb_jpps);
+            const auto* flat_dtsts = cursor.read<FlatDtSt>(nb_dtsts);
+
+            IdxMap<JourneyPatternPoint, uint32_t> until;
+            until.assign(jp_container.get_jpps_values(), 0);
+            CachedNextStopTime::vDtSt dtsts;
+            dtsts.reserve(nb_dtsts);
+            uint32_t pos = 0;
+            for (size_t jpp = 0; jpp < nb_jpps; ++jpp) {
+                const JppIdx jpp_idx(jpp);
+                const auto order = jp_container.get(jpp_idx).order;
+                until[jpp_idx] = until_begin[jpp];
+                if (until_begin[jpp] < pos || until_begin[jpp] > nb_dtsts) {
+                    throw navitia::exception("corrupted next stop time snapshots file " + filename);
+                }
+                for (; pos < until_begin[jpp]; ++pos) {
+                    const auto& flat_dtst = flat_dtsts[pos];
+                    if (flat_dtst.vj_idx >= vjs.size() || order >= vjs[flat_dtst.vj_idx]->stop_time_list.size()) {
+                        throw navitia::exception("corrupted next stop time snapshots file " + filename);
+                    }
+                    dtsts.emplace_back(flat_dtst.dt, &vjs[flat_dtst.vj_idx]->stop_time_list[order]);
+                }
+            }
+            dtst_from_jpps.emplace_back(std::move(dtsts), std::move(until));
+        }
+        loaded[CachedNextStopTimeKey(day, type::RTLevel::Base, type::AccessibiliteParams())] =
+            std::shared_ptr<const CachedNextStopTime>(
+                new CachedNextStopTime(std::move(dtst_from_jpps[0]), std::move(dtst_from_jpps[1])));
+    }
+    snapshots = std::move(loaded);
+    LOG4CPLUS_INFO(logger, snapshots.size() << " next stop time snapshots loaded from " << filename);
+    return snapshots.size();
+}
+
 inline static bool within(u_int32_t val, std::pair<u_int32_t, u_int32_t> bound) {
     return val >= bound.first && val <= bound.second;
 }
@@ -32,16 +32,18 @@ www.navitia.io
 
 #include "routing/stop_event.h"
 #include "routing/raptor_utils.h"
+#include "routing/time_search.h"
 #include "utils/idx_map.h"
 #include "utils/lru.h"
 #include "type/rt_level.h"
 #include "type/type.h"
 
-#include <boost/range/algorithm/lower_bound.hpp>
-#include <boost/range/algorithm/upper_bound.hpp>
 #include <boost/optional.hpp>
 #include <boost/dynamic_bitset.hpp>
 
+#include <map>
+#include <string>
+
 namespace navitia {
 
 namespace type {
@@ -62,6 +64,13 @@ struct NextStopTimeData {
     typedef boost::iterator_range<std::vector<const type::StopTime*>::const_reverse_iterator> StopTimeReverseIter;
 
     void load(const JourneyPatternContainer&);
+    // Reuses the sorted stop times of the jpps of a previous data whose
+    // jp has not been touched, translated to the vjs of its clone (see
+    // JourneyPatternContainer::update), the touched ones being loaded.
+    void update(const JourneyPatternContainer&,
+                const NextStopTimeData& previous,
+                const boost::dynamic_bitset<>& touched_jps,
+                const std::vector<const type::VehicleJourney*>& translation);
 
     // Returns the range of the stop times in increasing time order
     inline StopTimeIter stop_time_range_forward(const JppIdx jpp_idx, const StopEvent stop_event) const {
@@ -128,17 +137,16 @@ private:
         }
         // Returns the range of stop times next to hour(dt)
         inline StopTimeIter next_stop_time_range(const DateTime dt) const {
-            const auto it = boost::lower_bound(times, DateTimeUtils::hour(dt));
-            const auto idx = it - times.begin();
+            const auto idx = lower_bound_time(times.data(), times.size(), DateTimeUtils::hour(dt));
             return boost::make_iterator_range(stop_times.begin() + idx, stop_times.end());
         }
         // Returns the range of stop times previous to hour(dt)
         inline StopTimeReverseIter prev_stop_time_range(const DateTime dt) const {
-            const auto it = boost::upper_bound(times, DateTimeUtils::hour(dt));
-            const auto idx = it - times.begin();
+            const auto idx = upper_bound_time(times.data(), times.size(), DateTimeUtils::hour(dt));
             return boost::make_iterator_range(stop_times.rend() - idx, stop_times.rend());
         }
         void init(const JourneyPattern& jp, const JourneyPatternPoint& jpp);
+        void translate(const TimesStopTimes& previous, const std::vector<const type::VehicleJourney*>& translation);
     };
     IdxMap<JourneyPatternPoint, TimesStopTimes<Departure>> departure;
     IdxMap<JourneyPatternPoint, TimesStopTimes<Arrival>> arrival;
@@ -226,10 +234,13 @@ struct CachedNextStopTime {
                                                               const bool clockwise) const;
 
 private:
+    friend struct CachedNextStopTimeManager;
+
     // This structure provide the same interface as a vDtStByJpp, but
     // in a condensed and read only view.
     struct DtStFromJpp {
         DtStFromJpp(const vDtStByJpp& map);
+        DtStFromJpp(vDtSt&& d, IdxMap<JourneyPatternPoint, uint32_t>&& u) : dtsts(std::move(d)), until(std::move(u)) {}
 
         // Returns the range corresponding to map[jpp_idx], i.e. from
         // dtsts[until[prev(jpp_idx)]] to dtsts[until[jpp_idx]]
@@ -237,6 +248,8 @@ private:
         boost::iterator_range<vDtSt::const_iterator> operator[](const JppIdx& jpp_idx) const;
 
     private:
+        friend struct CachedNextStopTimeManager;
+
         // let map[JppIdx(40)] == []
         //     map[JppIdx(41)] == [a, l]
         //     map[JppIdx(42)] == [x, y, z]
@@ -259,12 +272,15 @@ private:
         // map[jpp_idx], and to the begin of map[next(jpp_idx)]
         IdxMap<JourneyPatternPoint, uint32_t> until;
     };
+    CachedNextStopTime(DtStFromJpp&& d, DtStFromJpp&& a) : departure(std::move(d)), arrival(std::move(a)) {}
+
     DtStFromJpp departure;
     DtStFromJpp arrival;
 };
 
 struct CachedNextStopTimeManager {
-    explicit CachedNextStopTimeManager(const dataRAPTOR& dataRaptor, size_t max_cache) : lru({dataRaptor}, max_cache) {}
+    explicit CachedNextStopTimeManager(const dataRAPTOR& dataRaptor, size_t max_cache)
+        : lru({dataRaptor}, max_cache), dataRaptor(&dataRaptor) {}
     CachedNextStopTimeManager& operator=(CachedNextStopTimeManager&&) = default;
     ~CachedNextStopTimeManager();
 
@@ -272,8 +288,24 @@ struct CachedNextStopTimeManager {
                                                    const type::RTLevel rt_level,
                                                    const type::AccessibiliteParams& accessibilite_params);
 
+    // The snapshots are bound to the data they have been built on (stop
+    // times, jpps), so they are not given to the caches of another data
     void warmup(const CachedNextStopTimeManager& other) { this->lru.warmup(other.lru); }
 
+    // Builds and saves in a file the base schedule caches of nb_days days
+    // from first_day, for the default accessibility (the most used keys)
+    void save_snapshots(const std::string& filename,
+                        const type::Data& data,
+                        const CachedNextStopTimeKey::Day first_day,
+                        const size_t nb_days) const;
+
+    // Maps a file written by save_snapshots and uses its caches instead
+    // of building them on the first requests.  The file is ignored if it
+    // has not been built on the same data.  Returns the number of loaded caches.
+    size_t load_snapshots(const std::string& filename, const type::Data& data);
+
+    size_t nb_snapshots() const { return snapshots.size(); }
+
 private:
     struct CacheCreator {
         typedef CachedNextStopTimeKey const& argument_type;
@@ -284,6 +316,9 @@ private:
     };
 
     ConcurrentLru<CacheCreator> lru;
+    const dataRAPTOR* dataRaptor;
+    // pre-built caches, only filled at the loading of the data, before any request
+    std::map<CachedNextStopTimeKey, std::shared_ptr<const CachedNextStopTime>> snapshots;
 };
 
 DateTime get_next_stop_time(const StopEvent stop_event,
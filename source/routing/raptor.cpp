@@ -95,6 +95,7 @@ bool RAPTOR::apply_vj_extension(const Visitor& v,
 
             working_labels.mut_dt_pt(sp_idx) = workingDt;
             best_labels_pts[sp_idx] = workingDt;
+            marked_sps.mark(sp_idx);
             result = true;
         }
         vj = v.get_extension_vj(vj);
@@ -109,17 +110,13 @@ bool RAPTOR::foot_path(const Visitor& v) {
     const auto& cnx_list = v.clockwise() ? data.dataRaptor->connections.forward_connections
                                          : data.dataRaptor->connections.backward_connections;
 
-    for (const auto sp_cnx : cnx_list) {
+    // Only the stop points improved during this round have their
+    // label initialized in working_labels, thus we only look at them.
+    for (const auto sp_idx : marked_sps) {
         // for all stop point, we check if we can improve the stop points they are in connection with
-        const auto& sp_idx = sp_cnx.first;
-
-        if (!working_labels.pt_is_initialized(sp_idx)) {
-            continue;
-        }
-
         const DateTime previous = working_labels.dt_pt(sp_idx);
 
-        for (const auto& conn : sp_cnx.second) {
+        for (const auto& conn : cnx_list[sp_idx]) {
             const SpIdx destination_sp_idx = conn.sp_idx;
             const DateTime next = v.combine(previous, conn.duration);
 
@@ -130,22 +127,22 @@ bool RAPTOR::foot_path(const Visitor& v) {
             // if we can improve the best label, we mark it
             working_labels.mut_dt_transfer(destination_sp_idx) = next;
             best_labels_transfers[destination_sp_idx] = next;
+            marked_transfer_sps.mark(destination_sp_idx);
             result = true;
         }
     }
+    marked_sps.clear();
 
-    for (const auto sp_jpps : jpps_from_sp) {
-        if (!working_labels.transfer_is_initialized(sp_jpps.first)) {
-            continue;
-        }
-
+    for (const auto sp_idx : marked_transfer_sps) {
         // we mark the jpp order
-        for (const auto& jpp : sp_jpps.second) {
+        for (const auto& jpp : jpps_from_sp[sp_idx]) {
             if (v.comp(jpp.order, Q[jpp.jp_idx])) {
                 Q[jpp.jp_idx] = jpp.order;
+                marked_jps.mark(jpp.jp_idx);
             }
         }
     }
+    marked_transfer_sps.clear();
 
     return result;
 }
@@ -153,6 +150,9 @@ bool RAPTOR::foot_path(const Visitor& v) {
 void RAPTOR::clear(const bool clockwise, const DateTime bound) {
     const int queue_value = clockwise ? std::numeric_limits<int>::max() : -1;
     Q.assign(data.dataRaptor->jp_container.get_jps_values(), queue_value);
+    marked_jps.clear();
+    marked_sps.clear();
+    marked_transfer_sps.clear();
     if (labels.empty()) {
         labels.resize(5);
     }
@@ -165,6 +165,17 @@ void RAPTOR::clear(const bool clockwise, const DateTime bound) {
     boost::fill(best_labels_transfers.values(), bound);
 }
 
+RAPTOR& RAPTOR::get_range_worker(const size_t i) {
+    while (range_workers.size() <= i) {
+        range_workers.push_back(std::make_unique<RAPTOR>(data));
+    }
+    auto& worker = *range_workers[i];
+    worker.valid_journey_patterns = valid_journey_patterns;
+    worker.valid_stop_points = valid_stop_points;
+    worker.jpps_from_sp = jpps_from_sp;
+    return worker;
+}
+
 void RAPTOR::init(const map_stop_point_duration& dep,
                   const DateTime bound,
                   const bool clockwise,
@@ -178,10 +189,9 @@ void RAPTOR::init(const map_stop_point_duration& dep,
         labels[0].mut_dt_transfer(sp_dt.first) = begin_dt;
         best_labels_transfers[sp_dt.first] = begin_dt;
         for (const auto& jpp : jpps_from_sp[sp_dt.first]) {
-            if (clockwise && Q[jpp.jp_idx] > jpp.order) {
-                Q[jpp.jp_idx] = jpp.order;
-            } else if (!clockwise && Q[jpp.jp_idx] < jpp.order) {
+            if ((clockwise && Q[jpp.jp_idx] > jpp.order) || (!clockwise && Q[jpp.jp_idx] < jpp.order)) {
                 Q[jpp.jp_idx] = jpp.order;
+                marked_jps.mark(jpp.jp_idx);
             }
         }
     }
@@ -668,84 +678,92 @@ void RAPTOR::raptor_loop(Visitor visitor, const nt::RTLevel rt_level, uint32_t m
         }
         const auto& prec_labels = labels[count - 1];
         auto& working_labels = labels[this->count];
+        const auto& timetables = data.dataRaptor->jp_timetables;
         /*
          * We need to store it so we can apply stay_in after applying normal vjs
          * We want to do it, to favoritize normal vj against stay_in vjs
+         *
+         * Only the journey patterns marked during the previous round
+         * have an order in Q, so we don't need to scan the whole Q.
+         * They are sorted to keep a memory friendly access.
          */
-        for (auto q_elt : Q) {
-            const JpIdx jp_idx = q_elt.first;
-            if (q_elt.second != visitor.init_queue_item()) {
-                bool is_onboard = false;
-                DateTime workingDt = visitor.worst_datetime();
-                DateTime base_dt = workingDt;
-                typename Visitor::stop_time_iterator it_st;
-                uint16_t l_zone = std::numeric_limits<uint16_t>::max();
-                const auto& jpps_to_explore =
-                    visitor.jpps_from_order(data.dataRaptor->jpps_from_jp, jp_idx, q_elt.second);
-                for (const auto& jpp : jpps_to_explore) {
-                    if (is_onboard) {
-                        ++it_st;
-                        // We update workingDt with the new arrival time
-                        // We need at each journey pattern point when we have a st
-                        // If we don't it might cause problem with overmidnight vj
-                        const type::StopTime& st = *it_st;
-                        workingDt = st.section_end(base_dt, visitor.clockwise());
-                        // We check if there are no drop_off_only and if the local_zone is okay
-                        if (st.valid_end(visitor.clockwise())
-                            && (l_zone == std::numeric_limits<uint16_t>::max() || l_zone != st.local_traffic_zone)
-                            && visitor.comp(workingDt, best_labels_pts[jpp.sp_idx])
-                            && valid_stop_points[jpp.sp_idx.val])  // we need to check the accessibility
-                        {
-                            working_labels.mut_dt_pt(jpp.sp_idx) = workingDt;
-                            best_labels_pts[jpp.sp_idx] = working_labels.dt_pt(jpp.sp_idx);
-                            continue_algorithm = true;
-                        }
+        marked_jps.sort();
+        ++nb_rounds;
+        nb_scanned_jps += marked_jps.size();
+        for (const JpIdx jp_idx : marked_jps) {
+            auto& q_elt = Q[jp_idx];
+            bool is_onboard = false;
+            DateTime workingDt = visitor.worst_datetime();
+            DateTime base_dt = workingDt;
+            // position of the current stop time in the timetables, and vj we are onboard
+            uint32_t st_pos = 0;
+            const type::VehicleJourney* onboard_vj = nullptr;
+            uint16_t l_zone = std::numeric_limits<uint16_t>::max();
+            const auto& jpps_to_explore = visitor.jpps_from_order(data.dataRaptor->jpps_from_jp, jp_idx, q_elt);
+            for (const auto& jpp : jpps_to_explore) {
+                if (is_onboard) {
+                    st_pos = visitor.next_st_pos(st_pos);
+                    // We update workingDt with the new arrival time
+                    // We need at each journey pattern point when we have a st
+                    // If we don't it might cause problem with overmidnight vj
+                    workingDt = timetables.section_end(st_pos, base_dt, visitor.clockwise());
+                    // We check if there are no drop_off_only and if the local_zone is okay
+                    if (jpp.valid_end(visitor.clockwise())
+                        && (l_zone == std::numeric_limits<uint16_t>::max() || l_zone != jpp.local_traffic_zone)
+                        && visitor.comp(workingDt, best_labels_pts[jpp.sp_idx])
+                        && valid_stop_points[jpp.sp_idx.val])  // we need to check the accessibility
+                    {
+                        working_labels.mut_dt_pt(jpp.sp_idx) = workingDt;
+                        best_labels_pts[jpp.sp_idx] = working_labels.dt_pt(jpp.sp_idx);
+                        marked_sps.mark(jpp.sp_idx);
+                        continue_algorithm = true;
                     }
+                }
 
-                    // We try to get on a vehicle, if we were already on a vehicle, but we arrived
-                    // before on the previous via a connection, we try to catch a vehicle leaving this
-                    // journey pattern point before
-                    const DateTime previous_dt = prec_labels.dt_transfer(jpp.sp_idx);
-                    if (prec_labels.transfer_is_initialized(jpp.sp_idx) && valid_stop_points[jpp.sp_idx.val]
-                        && (!is_onboard || visitor.better_or_equal(previous_dt, base_dt, *it_st))) {
-                        const auto tmp_st_dt =
-                            next_st->next_stop_time(visitor.stop_event(), jpp.idx, previous_dt, visitor.clockwise());
-                        if (tmp_st_dt.first != nullptr) {
-                            if (!is_onboard || &*it_st != tmp_st_dt.first) {
-                                // st_range is quite cache
-                                // unfriendly, so avoid using it if
-                                // not really needed.
-                                it_st = visitor.st_range(*tmp_st_dt.first).begin();
-                                is_onboard = true;
-                                l_zone = it_st->local_traffic_zone;
-                                // note that if we have found a better
-                                // pickup, and that this pickup does
-                                // not have the same local traffic
-                                // zone, we may miss some interesting
-                                // solutions.
-                            } else if (l_zone != it_st->local_traffic_zone) {
-                                // if we can pick up in this vj with 2
-                                // different zones, we can drop off
-                                // anywhere (we'll chose later at
-                                // which stop we pickup)
-                                l_zone = std::numeric_limits<uint16_t>::max();
-                            }
-                            workingDt = tmp_st_dt.second;
-                            base_dt = tmp_st_dt.first->base_dt(workingDt, visitor.clockwise());
-                            BOOST_ASSERT(!visitor.comp(workingDt, previous_dt));
+                // We try to get on a vehicle, if we were already on a vehicle, but we arrived
+                // before on the previous via a connection, we try to catch a vehicle leaving this
+                // journey pattern point before
+                const DateTime previous_dt = prec_labels.dt_transfer(jpp.sp_idx);
+                if (prec_labels.transfer_is_initialized(jpp.sp_idx) && valid_stop_points[jpp.sp_idx.val]
+                    && (!is_onboard
+                        || visitor.be(previous_dt, timetables.section_end(st_pos, base_dt, !visitor.clockwise())))) {
+                    const auto tmp_st_dt =
+                        next_st->next_stop_time(visitor.stop_event(), jpp.idx, previous_dt, visitor.clockwise());
+                    if (tmp_st_dt.first != nullptr) {
+                        const uint32_t tmp_st_pos = timetables.st_pos(*tmp_st_dt.first);
+                        if (!is_onboard || st_pos != tmp_st_pos) {
+                            st_pos = tmp_st_pos;
+                            onboard_vj = tmp_st_dt.first->vehicle_journey;
+                            is_onboard = true;
+                            l_zone = jpp.local_traffic_zone;
+                            // note that if we have found a better
+                            // pickup, and that this pickup does
+                            // not have the same local traffic
+                            // zone, we may miss some interesting
+                            // solutions.
+                        } else if (l_zone != jpp.local_traffic_zone) {
+                            // if we can pick up in this vj with 2
+                            // different zones, we can drop off
+                            // anywhere (we'll chose later at
+                            // which stop we pickup)
+                            l_zone = std::numeric_limits<uint16_t>::max();
                         }
+                        workingDt = tmp_st_dt.second;
+                        base_dt = timetables.base_dt(st_pos, workingDt, visitor.clockwise());
+                        BOOST_ASSERT(!visitor.comp(workingDt, previous_dt));
                     }
                 }
-                if (is_onboard) {
-                    const type::VehicleJourney* vj_stay_in = visitor.get_extension_vj(it_st->vehicle_journey);
-                    if (vj_stay_in) {
-                        bool applied = apply_vj_extension(visitor, rt_level, vj_stay_in, l_zone, base_dt);
-                        continue_algorithm = continue_algorithm || applied;
-                    }
+            }
+            if (is_onboard) {
+                const type::VehicleJourney* vj_stay_in = visitor.get_extension_vj(onboard_vj);
+                if (vj_stay_in) {
+                    bool applied = apply_vj_extension(visitor, rt_level, vj_stay_in, l_zone, base_dt);
+                    continue_algorithm = continue_algorithm || applied;
                 }
             }
-            q_elt.second = visitor.init_queue_item();
+            q_elt = visitor.init_queue_item();
         }
+        marked_jps.clear();
         continue_algorithm = continue_algorithm && this->foot_path(visitor);
     }
 }
@@ -33,6 +33,7 @@ www.navitia.io
 #include <unordered_map>
 #include <queue>
 #include <limits>
+#include <memory>
 #include "type/type.h"
 #include "type/data.h"
 #include "type/datetime.h"
@@ -82,10 +83,35 @@ struct RAPTOR {
     dataRAPTOR::JppsFromSp jpps_from_sp;
     /// Order of the first journey_pattern point of each journey_pattern
     IdxMap<JourneyPattern, int> Q;
+    /// Journey patterns having an order in Q, i.e. the ones to scan in the next round
+    MarkedIdxSet<JourneyPattern> marked_jps;
+    /// Stop points improved by public transport during the current round
+    MarkedIdxSet<type::StopPoint> marked_sps;
+    /// Stop points improved by a transfer during the current round
+    MarkedIdxSet<type::StopPoint> marked_transfer_sps;
 
     // set to store if the stop_point is valid
     boost::dynamic_bitset<> valid_stop_points;
 
+    /// Number of rounds and of journey patterns scanned by this
+    /// instance since its construction, for benchmark purposes
+    size_t nb_rounds = 0;
+    size_t nb_scanned_jps = 0;
+
+    /// Number of threads splitting the departure time window of a
+    /// range request (i.e. with a timeframe_duration), see call_raptor
+    size_t nb_range_threads = 1;
+    /// Instances used by the other threads of a range request, lazily built
+    std::vector<std::unique_ptr<RAPTOR>> range_workers;
+
+    /// Number of threads rasterizing the graphical isochrones computed
+    /// from this instance, see build_isochrones
+    size_t nb_isochrone_threads = 1;
+
+    /// Number of threads filling the heat maps computed from this
+    /// instance, see fill_heat_map
+    size_t nb_heat_map_threads = 1;
+
     explicit RAPTOR(const navitia::type::Data& data)
         : data(data),
           best_labels_pts(data.pt_data->stop_points),
@@ -96,10 +122,18 @@ struct RAPTOR {
           valid_stop_points(data.pt_data->stop_points.size()) {
         labels.assign(10, data.dataRaptor->labels_const);
         first_pass_labels.assign(10, data.dataRaptor->labels_const);
+        marked_jps.init(data.dataRaptor->jp_container.nb_jps());
+        marked_sps.init(data.pt_data->stop_points.size());
+        marked_transfer_sps.init(data.pt_data->stop_points.size());
     }
 
     void clear(bool clockwise, DateTime bound);
 
+    /// Get the i-th instance used to compute a range request in
+    /// parallel.  It shares the valid journey patterns and stop points
+    /// computed by set_valid_jp_and_jpp on this instance.
+    RAPTOR& get_range_worker(size_t i);
+
     /// Initialize starting points
     void init(const map_stop_point_duration& dep,
               const DateTime bound,
@@ -43,6 +43,7 @@ www.navitia.io
 #include <boost/range/algorithm/count.hpp>
 #include <unordered_set>
 #include <chrono>
+#include <future>
 #include <string>
 
 namespace navitia {
@@ -107,6 +108,131 @@ static boost::optional<DateTime> get_timeframe_limit(const DateTime request_date
     return limit;
 }
 
+namespace {
+/**
+ * @brief Successive raptor calls, each one starting just after the
+ * journeys found by the previous one
+ */
+struct RaptorCalls {
+    const map_stop_point_duration& departures;
+    const map_stop_point_duration& destinations;
+    const type::RTLevel rt_level;
+    const navitia::time_duration& transfer_penalty;
+    const type::AccessibiliteParams& accessibilite_params;
+    const bool clockwise;
+    const boost::optional<navitia::time_duration>& direct_path_duration;
+    const uint32_t nb_direct_path;
+    const DateTime bound;
+    const uint32_t max_transfers;
+    const size_t max_extra_second_pass;
+    const double night_bus_filter_max_factor;
+    const int32_t night_bus_filter_base_factor;
+
+    // Call raptor from request_date_secs while keep_going, add the
+    // found journeys to `journeys` and return the date time of the
+    // next call
+    DateTime operator()(RAPTOR& raptor,
+                        DateTime request_date_secs,
+                        const boost::optional<uint32_t>& min_nb_journeys,
+                        const boost::optional<DateTime>& timeframe_limit,
+                        JourneySet& journeys,
+                        uint32_t& nb_try) const {
+        log4cplus::Logger logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
+        int total_nb_journeys = 0;
+
+        do {
+            auto raptor_journeys = raptor.compute_all_journeys(
+                departures, destinations, request_date_secs, rt_level, transfer_penalty, bound, max_transfers,
+                accessibilite_params, clockwise, direct_path_duration, max_extra_second_pass);
+
+            LOG4CPLUS_DEBUG(logger, "raptor found " << raptor_journeys.size() << " solutions");
+
+            // Remove direct path
+            filter_direct_path(raptor_journeys);
+
+            // filter joureys that are too late.....with the magic formula...
+            NightBusFilter::Params params{request_date_secs, clockwise, night_bus_filter_max_factor,
+                                          night_bus_filter_base_factor};
+            filter_late_journeys(raptor_journeys, params);
+
+            LOG4CPLUS_DEBUG(logger, "after filtering late journeys: " << raptor_journeys.size() << " solution(s) left");
+
+            if (raptor_journeys.empty()) {
+                break;
+            }
+
+            // filter the similar journeys
+            for (const auto& journey : raptor_journeys) {
+                journeys.insert(journey);
+            }
+
+            nb_try++;
+
+            total_nb_journeys = journeys.size() + nb_direct_path;
+
+            // Prepare next call for raptor with min_nb_journeys option
+            request_date_secs = prepare_next_call_for_raptor(raptor_journeys, clockwise);
+
+        } while (keep_going(total_nb_journeys, nb_try, clockwise, request_date_secs, min_nb_journeys, timeframe_limit,
+                            max_transfers));
+
+        return request_date_secs;
+    }
+};
+
+/**
+ * @brief Range mode: split [request_date_secs, timeframe_limit] in
+ * nb_range_threads slices, and compute the successive raptor calls of
+ * each slice in its own thread, with its own RAPTOR instance.
+ *
+ * A call at the end of a slice may find the first journeys of the next
+ * slice, they are merged by the JourneySet.
+ */
+DateTime call_raptor_by_range(const RaptorCalls& raptor_calls,
+                              RAPTOR& raptor,
+                              const DateTime request_date_secs,
+                              const DateTime timeframe_limit,
+                              JourneySet& journeys,
+                              uint32_t& nb_try) {
+    const size_t nb_slices = raptor.nb_range_threads;
+    const bool clockwise = raptor_calls.clockwise;
+    const DateTime window = clockwise ? timeframe_limit - request_date_secs : request_date_secs - timeframe_limit;
+    auto slice_limit = [&](size_t slice) -> DateTime {
+        const DateTime offset = DateTime(uint64_t(window) * slice / nb_slices);
+        return clockwise ? request_date_secs + offset : request_date_secs - offset;
+    };
+
+    struct Slice {
+        JourneySet journeys;
+        uint32_t nb_try = 0;
+        DateTime next_request_date_secs;
+    };
+    std::vector<Slice> slices(nb_slices);
+    auto compute_slice = [&](RAPTOR& slice_raptor, size_t slice) {
+        auto& res = slices[slice];
+        res.next_request_date_secs =
+            raptor_calls(slice_raptor, slice_limit(slice), boost::none, slice_limit(slice + 1), res.journeys, res.nb_try);
+    };
+
+    std::vector<std::future<void>> futures;
+    for (size_t slice = 1; slice < nb_slices; ++slice) {
+        futures.push_back(std::async(std::launch::async, compute_slice, std::ref(raptor.get_range_worker(slice - 1)),
+                                     slice));
+    }
+    compute_slice(raptor, 0);
+    for (auto& future : futures) {
+        // rethrow the exceptions of the other threads
+        future.get();
+    }
+
+    for (const auto& slice : slices) {
+        journeys.insert(slice.journeys.begin(), slice.journeys.end());
+        nb_try += slice.nb_try;
+    }
+    return slices.back().next_request_date_secs;
+}
+}  // namespace
+
 /**
  * @brief internal function to call raptor in a loop
  */
@@ -158,46 +284,40 @@ static std::vector<Path> call_raptor(navitia::PbCreator& pb_creator,
         // Raptor Loop
         JourneySet journeys;
         uint32_t nb_try = 0;
-        int total_nb_journeys = 0;
 
         raptor.set_valid_jp_and_jpp(DateTimeUtils::date(request_date_secs), accessibilite_params, forbidden_uri,
                                     allowed_ids, rt_level);
 
-        do {
-            auto raptor_journeys = raptor.compute_all_journeys(
-                departures, destinations, request_date_secs, rt_level, transfer_penalty, bound, max_transfers,
-                accessibilite_params, clockwise, direct_path_duration, max_extra_second_pass);
-
-            LOG4CPLUS_DEBUG(logger, "raptor found " << raptor_journeys.size() << " solutions");
-
-            // Remove direct path
-            filter_direct_path(raptor_journeys);
-
-            // filter joureys that are too late.....with the magic formula...
-            NightBusFilter::Params params{request_date_secs, clockwise, night_bus_filter_max_factor,
-                                          night_bus_filter_base_factor};
-            filter_late_journeys(raptor_journeys, params);
-
-            LOG4CPLUS_DEBUG(logger, "after filtering late journeys: " << raptor_journeys.size() << " solution(s) left");
-
-            if (raptor_journeys.empty()) {
-                break;
-            }
-
-            // filter the similar journeys
-            for (const auto& journey : raptor_journeys) {
-                journeys.insert(journey);
-            }
-
-            nb_try++;
-
-            total_nb_journeys = journeys.size() + nb_direct_path;
-
-            // Prepare next call for raptor with min_nb_journeys option
-            request_date_secs = prepare_next_call_for_raptor(raptor_journeys, clockwise);
-
-        } while (keep_going(total_nb_journeys, nb_try, clockwise, request_date_secs, min_nb_journeys, timeframe_limit,
-                            max_transfers));
+        const RaptorCalls raptor_calls{departures,
+                                       destinations,
+                                       rt_level,
+                                       transfer_penalty,
+                                       accessibilite_params,
+                                       clockwise,
+                                       direct_path_duration,
+                                       nb_direct_path,
+                                       bound,
+                                       max_transfers,
+                                       max_extra_second_pass,
+                                       night_bus_filter_max_factor,
+                                       night_bus_filter_base_factor};
+
+        const bool is_range = raptor.nb_range_threads > 1 && timeframe_limit
+                              && (clockwise ? request_date_secs < *timeframe_limit
+                                            : request_date_secs > *timeframe_limit);
+        if (is_range) {
+            request_date_secs =
+                call_raptor_by_range(raptor_calls, raptor, request_date_secs, *timeframe_limit, journeys, nb_try);
+            LOG4CPLUS_DEBUG(logger, "range raptor found " << journeys.size() << " journeys with "
+                                                          << raptor.nb_range_threads << " threads");
+        }
+        // In range mode, we may still miss some journeys to reach min_nb_journeys
+        if (!is_range
+            || keep_going(journeys.size() + nb_direct_path, nb_try, clockwise, request_date_secs, min_nb_journeys,
+                          timeframe_limit, max_transfers)) {
+            request_date_secs =
+                raptor_calls(raptor, request_date_secs, min_nb_journeys, timeframe_limit, journeys, nb_try);
+        }
 
         // create date time for next
         if (request_date_secs != to_datetime(datetime, raptor.data)) {
@@ -1071,8 +1191,8 @@ boost::optional<routing::map_stop_point_duration> get_stop_points(const type::En
             }
             const auto admin = data.geo_ref->admins[it_admin->second];
 
-            for (auto stop_area : admin->main_stop_areas) {
-                for (auto stop_point : stop_area->stop_point_list) {
+            for (auto sa_idx : admin->main_stop_areas) {
+                for (auto stop_point : data.pt_data->stop_areas[sa_idx]->stop_point_list) {
                     add_free_stop_point(stop_point, concerned_path_finder, result);
                 }
             }
@@ -1090,8 +1210,8 @@ boost::optional<routing::map_stop_point_duration> get_stop_points(const type::En
     // we need to check if the admin has zone odt
     const auto& admins = find_admins(ep, data);
     for (const auto* admin : admins) {
-        for (const auto* odt_admin_stop_point : admin->odt_stop_points) {
-            add_free_stop_point(odt_admin_stop_point, concerned_path_finder, result);
+        for (const auto sp_idx : admin->odt_stop_points) {
+            add_free_stop_point(data.pt_data->stop_points[sp_idx], concerned_path_finder, result);
         }
     }
 
@@ -1107,7 +1227,7 @@ boost::optional<routing::map_stop_point_duration> get_stop_points(const type::En
 
     // We add the center of the admin, and look for the stop points around
     auto nearest = worker.find_nearest_stop_points(ep.streetnetwork_params.max_duration,
-                                                   data.pt_data->stop_point_proximity_list, use_second);
+                                                   *data.pt_data->stop_point_proximity_list, use_second);
     for (const auto& elt : nearest) {
         const SpIdx sp_idx{elt.first};
         if (result.find(sp_idx) == result.end()) {
@@ -1129,7 +1249,7 @@ void free_radius_filter(routing::map_stop_point_duration& sp_list,
 
         // Find stop point list with a free radius constraint
         LOG4CPLUS_DEBUG(logger, "filtering with free radius (" << free_radius << " meters)");
-        auto excluded_elements = data.pt_data->stop_point_proximity_list.find_within(ep.coordinates, free_radius);
+        auto excluded_elements = data.pt_data->stop_point_proximity_list->find_within(ep.coordinates, free_radius);
         LOG4CPLUS_DEBUG(logger, "find " << excluded_elements.size() << " stop points in free radius");
 
         // For each excluded stop point
@@ -1501,14 +1621,16 @@ static void add_graphical_isochrone(const type::MultiPolygon& shape,
     add_common_isochrone(pb_creator, center, clockwise, datetime, pb_isochrone);
 }
 
-static void add_heat_map(const std::string& heat_map,
+static void add_heat_map(const HeatMap& heat_map,
                          PbCreator& pb_creator,
                          type::EntryPoint center,
                          bool clockwise,
                          bt::ptime datetime) {
     auto pb_heat_map = pb_creator.add_heat_maps();
     pb_heat_map->mutable_heat_matrix();
-    pb_heat_map->set_heat_matrix(heat_map);
+    pb_heat_map->set_heat_matrix(print_grid(heat_map));
+    // the compact grid, for the clients that do not need to parse the json one
+    pb_heat_map->set_heat_matrix_bytes(encode_grid(heat_map));
     add_common_isochrone(pb_creator, center, clockwise, datetime, pb_heat_map);
 }
 
@@ -1643,9 +1765,9 @@ void make_heat_map(navitia::PbCreator& pb_creator,
         return;
     }
 
-    auto heat_map = build_raster_isochrone(worker.geo_ref, end_speed, end_mode, isochrone_common.init_dt, raptor,
-                                           isochrone_common.coord_origin, max_duration, clockwise,
-                                           isochrone_common.bound, resolution);
+    const auto heat_map = build_raster_isochrone(worker.geo_ref, end_speed, end_mode, isochrone_common.init_dt, raptor,
+                                                 isochrone_common.coord_origin, max_duration, clockwise,
+                                                 isochrone_common.bound, resolution);
     add_heat_map(heat_map, pb_creator, center, clockwise, isochrone_common.datetime);
 }
 
@@ -31,9 +31,14 @@ www.navitia.io
 #pragma once
 
 #include <boost/container/flat_map.hpp>
+#include <boost/dynamic_bitset.hpp>
 #include "type/datetime.h"
 #include "utils/idx_map.h"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 namespace navitia {
 
 namespace type {
@@ -63,41 +68,127 @@ inline bool is_dt_initialized(const DateTime dt) {
     return dt != DateTimeUtils::inf && dt != DateTimeUtils::min;
 }
 
+/*
+ * Labels of a raptor round.
+ *
+ * Each label is stamped with the epoch of its last write.  A label
+ * with an older stamp than the current epoch has the clean value,
+ * thus clearing the labels is just incrementing the epoch instead of
+ * copying every label.
+ */
 struct Labels {
     inline friend void swap(Labels& lhs, Labels& rhs) {
         swap(lhs.dt_pts, rhs.dt_pts);
         swap(lhs.dt_transfers, rhs.dt_transfers);
+        std::swap(lhs.clean_dt, rhs.clean_dt);
+        std::swap(lhs.epoch, rhs.epoch);
     }
     // initialize the structure according to the number of jpp
     inline void init_inf(const std::vector<type::StopPoint*>& stops) { init(stops, DateTimeUtils::inf); }
     // initialize the structure according to the number of jpp
     inline void init_min(const std::vector<type::StopPoint*>& stops) { init(stops, DateTimeUtils::min); }
-    // clear the structure according to a given structure. Same as a
-    // copy without touching the boarding_jpp fields
+    // clear the structure according to a given structure (built with
+    // the same stop points). Same result as a copy, in O(1).
     inline void clear(const Labels& clean) {
-        dt_pts = clean.dt_pts;
-        dt_transfers = clean.dt_transfers;
+        clean_dt = clean.clean_dt;
+        ++epoch;
+        if (epoch == 0) {
+            // the epoch has wrapped around, the old stamps can't be trusted anymore
+            reset(clean_dt);
+        }
     }
-    inline const DateTime& dt_transfer(SpIdx sp_idx) const { return dt_transfers[sp_idx]; }
-    inline const DateTime& dt_pt(SpIdx sp_idx) const { return dt_pts[sp_idx]; }
-    inline DateTime& mut_dt_transfer(SpIdx sp_idx) { return dt_transfers[sp_idx]; }
-    inline DateTime& mut_dt_pt(SpIdx sp_idx) { return dt_pts[sp_idx]; }
+    inline const DateTime& dt_transfer(SpIdx sp_idx) const { return get(dt_transfers[sp_idx]); }
+    inline const DateTime& dt_pt(SpIdx sp_idx) const { return get(dt_pts[sp_idx]); }
+    inline DateTime& mut_dt_transfer(SpIdx sp_idx) { return get_mut(dt_transfers[sp_idx]); }
+    inline DateTime& mut_dt_pt(SpIdx sp_idx) { return get_mut(dt_pts[sp_idx]); }
 
     inline bool pt_is_initialized(SpIdx sp_idx) const { return is_dt_initialized(dt_pt(sp_idx)); }
     inline bool transfer_is_initialized(SpIdx sp_idx) const { return is_dt_initialized(dt_transfer(sp_idx)); }
 
 private:
+    struct StampedDt {
+        DateTime dt;
+        uint32_t epoch;
+    };
+
     inline void init(const std::vector<type::StopPoint*>& stops, DateTime val) {
-        dt_pts.assign(stops, val);
-        dt_transfers.assign(stops, val);
+        clean_dt = val;
+        epoch = 0;
+        dt_pts.assign(stops, {val, epoch});
+        dt_transfers.assign(stops, {val, epoch});
+    }
+    inline void reset(DateTime val) {
+        for (auto& label : dt_pts.values()) {
+            label = {val, epoch};
+        }
+        for (auto& label : dt_transfers.values()) {
+            label = {val, epoch};
+        }
+    }
+    inline const DateTime& get(const StampedDt& label) const { return label.epoch == epoch ? label.dt : clean_dt; }
+    inline DateTime& get_mut(StampedDt& label) {
+        if (label.epoch != epoch) {
+            label = {clean_dt, epoch};
+        }
+        return label.dt;
     }
 
     // All these vectors are indexed by sp_idx
     //
     // At what time can we reach this label with public transport
-    IdxMap<type::StopPoint, DateTime> dt_pts;
+    IdxMap<type::StopPoint, StampedDt> dt_pts;
     // At what time wan we reach this label with a transfer
-    IdxMap<type::StopPoint, DateTime> dt_transfers;
+    IdxMap<type::StopPoint, StampedDt> dt_transfers;
+
+    // value of the labels not written since the last clear
+    DateTime clean_dt = DateTimeUtils::inf;
+    uint32_t epoch = 0;
+};
+
+/*
+ * Sparse set of indexes, used as a work-list.
+ *
+ * A dense bitset gives an O(1) membership test, and a compact vector
+ * of the marked indexes allows to iterate (and clear) in O(number of
+ * marked elements) instead of O(number of elements).
+ */
+template <typename T>
+struct MarkedIdxSet {
+    using Index = Idx<T>;
+    using const_iterator = typename std::vector<Index>::const_iterator;
+
+    inline void init(const size_t nb_elts) {
+        is_marked_bits.clear();
+        is_marked_bits.resize(nb_elts);
+        marked.clear();
+    }
+    // return true if the index was not already marked
+    inline bool mark(const Index& idx) {
+        if (is_marked_bits[idx.val]) {
+            return false;
+        }
+        is_marked_bits.set(idx.val);
+        marked.push_back(idx);
+        return true;
+    }
+    inline bool is_marked(const Index& idx) const { return is_marked_bits[idx.val]; }
+    inline void clear() {
+        for (const auto& idx : marked) {
+            is_marked_bits.reset(idx.val);
+        }
+        marked.clear();
+    }
+    // sort the marked indexes to iterate on them in memory order
+    inline void sort() { std::sort(marked.begin(), marked.end()); }
+
+    inline bool empty() const { return marked.empty(); }
+    inline size_t size() const { return marked.size(); }
+    inline const_iterator begin() const { return marked.begin(); }
+    inline const_iterator end() const { return marked.end(); }
+
+private:
+    boost::dynamic_bitset<> is_marked_bits;
+    std::vector<Index> marked;
 };
 
 }  // namespace routing
@@ -10,9 +10,8 @@ struct raptor_visitor {
     typedef std::vector<type::StopTime>::const_iterator stop_time_iterator;
     typedef boost::iterator_range<stop_time_iterator> stop_time_range;
 
-    inline bool better_or_equal(const DateTime& a, const DateTime& current_dt, const type::StopTime& st) const {
-        return a <= st.section_end(current_dt, !clockwise());
-    }
+    // position of the next stop time of a vj in dataRAPTOR::JpTimetables
+    inline uint32_t next_st_pos(uint32_t st_pos) const { return st_pos + 1; }
 
     inline boost::iterator_range<std::vector<dataRAPTOR::JppsFromJp::Jpp>::const_iterator>
     jpps_from_order(const dataRAPTOR::JppsFromJp& jpps_from_jp, JpIdx jp_idx, uint16_t jpp_order) const {
@@ -65,9 +64,8 @@ struct raptor_reverse_visitor {
     typedef std::vector<type::StopTime>::const_reverse_iterator stop_time_iterator;
     typedef boost::iterator_range<stop_time_iterator> stop_time_range;
 
-    inline bool better_or_equal(const DateTime& a, const DateTime& current_dt, const type::StopTime& st) const {
-        return a >= st.section_end(current_dt, !clockwise());
-    }
+    // position of the previous stop time of a vj in dataRAPTOR::JpTimetables
+    inline uint32_t next_st_pos(uint32_t st_pos) const { return st_pos - 1; }
 
     inline boost::iterator_range<std::vector<dataRAPTOR::JppsFromJp::Jpp>::const_reverse_iterator>
     jpps_from_order(const dataRAPTOR::JppsFromJp& jpps_from_jp, JpIdx jp_idx, uint16_t jpp_order) const {
@@ -116,7 +116,7 @@ bool use_crow_fly(const type::EntryPoint& point,
         // even if the stop_area is not in the admin
         auto admin = data.geo_ref->admins[data.geo_ref->admin_map[point.uri]];
         auto it = find_if(begin(admin->main_stop_areas), end(admin->main_stop_areas),
-                          [stop_point](const type::StopArea* stop_area) { return stop_area == stop_point.stop_area; });
+                          [stop_point](const type::idx_t sa_idx) { return sa_idx == stop_point.stop_area->idx; });
         return it != end(admin->main_stop_areas);
     } else {
         // if the request is on any other type we don't want a crowfly section
@@ -82,6 +82,29 @@ BOOST_AUTO_TEST_CASE(ok_before_and_after_disruption) {
     // a clone and set
     auto data_cloned = data_manager.get_data_clone();
     data_cloned->build_raptor();
+
+    // the georef is shared, and the cloned pt objects use its admins
+    BOOST_CHECK_EQUAL(data_cloned->geo_ref, data_manager.get_data()->geo_ref);
+    BOOST_CHECK_EQUAL(data_cloned->fare, data_manager.get_data()->fare);
+    BOOST_CHECK_NE(data_cloned->pt_data->stop_points.front(), data_manager.get_data()->pt_data->stop_points.front());
+    for (const auto* sp : data_cloned->pt_data->stop_points) {
+        for (const auto* admin : sp->admin_list) {
+            BOOST_CHECK_EQUAL(admin, data_cloned->geo_ref->admins[admin->idx]);
+        }
+    }
+    // so are the autocompletes and the proximity lists of the pt objects, until the realtime changes them
+    const auto& source_pt_data = *data_manager.get_data()->pt_data;
+    BOOST_CHECK_EQUAL(data_cloned->pt_data->stop_area_autocomplete, source_pt_data.stop_area_autocomplete);
+    BOOST_CHECK_EQUAL(data_cloned->pt_data->stop_point_proximity_list, source_pt_data.stop_point_proximity_list);
+    const auto nb_source_lines = source_pt_data.line_autocomplete->word_quality_list.size();
+    data_cloned->update_pt_autocomplete();
+    // the lines missing in the autocomplete are only added to the one of the clone
+    BOOST_CHECK_EQUAL(source_pt_data.line_autocomplete->word_quality_list.size(), nb_source_lines);
+    for (const auto* line : data_cloned->pt_data->lines) {
+        if (!line->name.empty()) {
+            BOOST_CHECK_EQUAL(data_cloned->pt_data->line_autocomplete->word_quality_list.count(line->idx), 1);
+        }
+    }
     data_manager.set_data(data_cloned);
 
     // we ask for a journey, we should have the same thing
@@ -43,7 +43,9 @@ www.navitia.io
 #include "utils/logger.h"
 
 #include <boost/test/unit_test.hpp>
+#include <cstring>
 #include <iomanip>
+#include <algorithm>
 #include <vector>
 #include <boost/geometry.hpp>
 #include <boost/geometry/geometries/polygon.hpp>
@@ -66,20 +68,19 @@ BOOST_AUTO_TEST_CASE(print_map_test) {
      *
      */
     std::vector<SingleCoord> header;
-    std::vector<std::pair<SingleCoord, std::vector<navitia::time_duration>>> body;
-    int length = 3;
-    for (int i = 0; i < length; i++) {
+    std::vector<SingleCoord> lines;
+    size_t length = 3;
+    for (size_t i = 0; i < length; i++) {
         header.push_back((SingleCoord(i + length + 1, 1)));
-        std::vector<navitia::time_duration> local_duration;
-        auto lon = SingleCoord(i, 1);
-        for (int j = 0; j < length; j++) {
-            local_duration.push_back(navitia::minutes(j + i * length));
+        lines.push_back(SingleCoord(i, 1));
+    }
+    auto heat_map = HeatMap(header, lines);
+    for (size_t i = 0; i < length; i++) {
+        for (size_t j = 0; j < length; j++) {
+            heat_map.set_duration(i, j, navitia::minutes(j + i * length));
         }
-        auto local_body = std::make_pair(lon, local_duration);
-        body.push_back(std::move(local_body));
     }
-    auto heat_map = HeatMap(header, body);
-    heat_map.body[2].second[2] = bt::pos_infin;
+    heat_map.set_duration(2, 2, bt::pos_infin);
     const auto heat_map_string = R"({"line_headers":[{"cell_lat":{"min_lat":4,"center_lat":4.5,"max_lat":5}},)"
                                  R"({"cell_lat":{"min_lat":5,"center_lat":5.5,"max_lat":6}},)"
                                  R"({"cell_lat":{"min_lat":6,"center_lat":6.5,"max_lat":7}}],)"
@@ -92,6 +93,34 @@ BOOST_AUTO_TEST_CASE(print_map_test) {
     BOOST_CHECK(heat_map_string == print_grid(heat_map));
 }
 
+BOOST_AUTO_TEST_CASE(encode_grid_test) {
+    std::vector<SingleCoord> header;
+    std::vector<SingleCoord> lines;
+    for (size_t i = 0; i < 3; i++) {
+        header.push_back((SingleCoord(i + 4, 1)));
+        lines.push_back(SingleCoord(i, 1));
+    }
+    auto heat_map = HeatMap(header, lines);
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 3; j++) {
+            heat_map.set_duration(i, j, navitia::minutes(j + i * 3));
+        }
+    }
+    heat_map.set_duration(2, 2, bt::pos_infin);
+    const auto grid = encode_grid(heat_map);
+    // 2 varints for the sizes, 4 doubles for the coordinates and 9 cells
+    BOOST_REQUIRE_EQUAL(grid.size(), 2 + 4 * 8 + 10);
+    BOOST_CHECK_EQUAL(grid[0], 3);
+    BOOST_CHECK_EQUAL(grid[1], 3);
+    double min_lat;
+    std::memcpy(&min_lat, grid.data() + 2 + 2 * 8, sizeof(min_lat));
+    BOOST_CHECK_EQUAL(min_lat, 4);
+    // first cell: 0s + 1, zigzag encoded, then +60s for each of the 7 next cells,
+    // then back to 0 for the unreached cell: -421, zigzag encoded on 2 bytes
+    const std::string cells = {2, 120, 120, 120, 120, 120, 120, 120, char(0xc9), 6};
+    BOOST_CHECK(grid.substr(2 + 4 * 8) == cells);
+}
+
 BOOST_AUTO_TEST_CASE(heat_map_test) {
     /*
      *
@@ -183,8 +212,8 @@ BOOST_AUTO_TEST_CASE(heat_map_test) {
     auto mode = navitia::type::Mode_e::Walking;
     const auto bound = navitia::DateTimeUtils::set(0, "09:00"_t);
     const auto init_dt = navitia::DateTimeUtils::set(0, "07:00"_t);
-    const auto isochrone = build_raster_isochrone(*b.data->geo_ref, speed, mode, init_dt, raptor, A, max_duration, true,
-                                                  bound, resolution);
+    const auto isochrone = print_grid(build_raster_isochrone(*b.data->geo_ref, speed, mode, init_dt, raptor, A,
+                                                             max_duration, true, bound, resolution));
     BOOST_CHECK(isochrone.size() > 0);
     const auto header = R"({"line_headers":[{"cell_lat":)";
     std::size_t found_header = isochrone.find(header);
@@ -198,7 +227,7 @@ BOOST_AUTO_TEST_CASE(heat_map_test) {
     std::vector<navitia::time_duration> result;
     for (size_t i = 0; i < step; i++) {
         for (size_t j = 0; j < step; j++) {
-            result.push_back(heat_map.body[i].second[j]);
+            result.push_back(heat_map.get_duration(i, j));
         }
     }
     BOOST_CHECK_EQUAL(result[0].total_seconds(), 236);
@@ -207,4 +236,17 @@ BOOST_AUTO_TEST_CASE(heat_map_test) {
     for (size_t i = 3; i < result.size(); i++) {
         BOOST_CHECK(result[i].is_pos_infinity());
     }
+
+    // with several stripes of lines, the threads fill them at the same time
+    const size_t fine_step = 4 * RASTER_STRIPE_HEIGHT;
+    const auto fine_height_step = (A.lat() - D.lat()) / fine_step;
+    const auto fine_width_step = (D.lon() - A.lon()) / fine_step;
+    const auto fine_min_dist = std::min(500., std::max(fine_height_step, fine_width_step) * N_DEG_TO_DISTANCE);
+    const auto fine_heat_map = fill_heat_map(box, fine_height_step, fine_width_step, *b.data->geo_ref, fine_min_dist,
+                                             max_duration, speed, distances, fine_step, 1);
+    BOOST_CHECK(std::any_of(fine_heat_map.durations.begin(), fine_heat_map.durations.end(),
+                            [](const uint16_t duration) { return duration != HEAT_MAP_UNREACHED; }));
+    const auto fine_heat_map_threads = fill_heat_map(box, fine_height_step, fine_width_step, *b.data->geo_ref,
+                                                     fine_min_dist, max_duration, speed, distances, fine_step, 4);
+    BOOST_CHECK(fine_heat_map_threads.durations == fine_heat_map.durations);
 }
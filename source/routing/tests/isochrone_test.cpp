@@ -218,4 +218,15 @@ BOOST_AUTO_TEST_CASE(build_ischrons_test) {
 #endif
     BOOST_CHECK(boost::geometry::equals(isochrone_8h30[0].shape, isochrone_8h_8h30_9h[0].shape));
     BOOST_CHECK(boost::geometry::equals(isochrone_8h30_9h[0].shape, isochrone_8h_8h30_9h[1].shape));
+
+    // the bands share their borders without overlapping, whatever the number of threads
+    raptor.nb_isochrone_threads = 4;
+    std::vector<navitia::routing::Isochrone> isochrone_8h_8h30_9h_threads =
+        build_isochrones(raptor, true, coord_Paris, d, speed, duration_1h_30min_0min, init_dt);
+    BOOST_REQUIRE_EQUAL(isochrone_8h_8h30_9h_threads.size(), 2);
+    BOOST_CHECK(boost::geometry::equals(isochrone_8h_8h30_9h[0].shape, isochrone_8h_8h30_9h_threads[0].shape));
+    BOOST_CHECK(boost::geometry::equals(isochrone_8h_8h30_9h[1].shape, isochrone_8h_8h30_9h_threads[1].shape));
+    navitia::type::MultiPolygon overlap;
+    boost::geometry::intersection(isochrone_8h_8h30_9h[0].shape, isochrone_8h_8h30_9h[1].shape, overlap);
+    BOOST_CHECK_SMALL(boost::geometry::area(overlap), 1e-12);
 }
@@ -32,6 +32,8 @@ www.navitia.io
 #define BOOST_TEST_MODULE journey_pattern_container_test
 
 #include "routing/journey_pattern_container.h"
+#include "routing/dataraptor.h"
+#include "type/data.h"
 #include "ed/build_helper.h"
 #include "tests/utils_test.h"
 #include "type/pt_data.h"
@@ -246,3 +248,42 @@ BOOST_AUTO_TEST_CASE(lightly_overtaking2) {
     BOOST_CHECK_EQUAL(check_jp_container(jps), 2);
     BOOST_CHECK_EQUAL(jps.nb_jps(), 2);
 }
+
+// the compact timetables must give the same times and properties as the stop times
+BOOST_AUTO_TEST_CASE(jp_timetables) {
+    ed::builder b("20150101");
+    b.vj("1", "000111")("A", "8:00"_t, "8:01"_t)("B", "8:10"_t, "8:11"_t)("C", "8:20"_t, "8:21"_t);
+    b.vj("1", "000111")("A", "8:05"_t, "8:06"_t)("B", "8:15"_t, "8:16"_t)("C", "8:25"_t, "8:26"_t);
+    b.vj("1", "000111")("A", "7:55"_t, "7:55"_t)("B", "8:15"_t, "8:15"_t, std::numeric_limits<uint16_t>::max(), true,
+                                                   false)("C", "8:35"_t, "8:35"_t);
+    b.frequency_vj("2", "8:00"_t, "18:00"_t, "00:05"_t)("A", "8:00"_t)("C", "8:10"_t);
+
+    b.data->pt_data->sort_and_index();
+    b.finish();
+    b.data->build_raptor();
+    b.data->build_uri();
+
+    const auto& data_raptor = *b.data->dataRaptor;
+    const auto& timetables = data_raptor.jp_timetables;
+    const navitia::DateTime base_dt = navitia::DateTimeUtils::set(1, 0);
+    for (const auto jp : data_raptor.jp_container.get_jps()) {
+        const auto& jpps = data_raptor.jpps_from_jp[jp.first];
+        jp.second.for_each_vehicle_journey([&](const nt::VehicleJourney& vj) {
+            BOOST_REQUIRE_EQUAL(jpps.size(), vj.stop_time_list.size());
+            const auto first_pos = timetables.st_pos(vj.stop_time_list.front());
+            for (const auto& st : vj.stop_time_list) {
+                const auto pos = timetables.st_pos(st);
+                BOOST_CHECK_EQUAL(pos, first_pos + st.order());
+                for (const bool clockwise : {true, false}) {
+                    BOOST_CHECK_EQUAL(timetables.section_end(pos, base_dt, clockwise),
+                                      st.section_end(base_dt, clockwise));
+                    const auto dt = st.section_end(base_dt, !clockwise);
+                    BOOST_CHECK_EQUAL(timetables.base_dt(pos, dt, clockwise), st.base_dt(dt, clockwise));
+                    BOOST_CHECK_EQUAL(jpps[st.order()].valid_end(clockwise), st.valid_end(clockwise));
+                }
+                BOOST_CHECK_EQUAL(jpps[st.order()].local_traffic_zone, st.local_traffic_zone);
+            }
+            return true;
+        });
+    }
+}
@@ -40,6 +40,9 @@ www.navitia.io
 #include "type/pt_data.h"
 #include "type/datetime.h"
 
+#include <boost/filesystem.hpp>
+#include <random>
+
 using namespace navitia;
 using namespace navitia::routing;
 
@@ -2593,3 +2596,87 @@ BOOST_AUTO_TEST_CASE(freq_next_stop_time_with_distant_bounds) {
         BOOST_CHECK_EQUAL(st->stop_point->stop_area->name, spa2);
     }
 }
+
+/*
+ * The vectorized searches must give the same result as the standard ones,
+ * on every block size (before and after the dichotomy) and on the bounds
+ */
+BOOST_AUTO_TEST_CASE(time_search_same_as_std) {
+    std::mt19937 rng(42);
+    for (const auto impl : {TimeSearchImpl::Scalar, TimeSearchImpl::SSE2, TimeSearchImpl::AVX2}) {
+        BOOST_TEST_MESSAGE("time search implementation: " << to_string(impl));
+        for (size_t n = 0; n < 200; ++n) {
+            std::vector<DateTime> times;
+            // few distinct values to have duplicates
+            std::uniform_int_distribution<DateTime> gen_time(0, n / 2 + 1);
+            for (size_t i = 0; i < n; ++i) {
+                times.push_back(gen_time(rng) * 60);
+            }
+            // big values to check that the search is unsigned
+            if (n % 2) {
+                times.push_back(DateTimeUtils::inf - 1);
+                times.push_back(DateTimeUtils::inf);
+            }
+            std::sort(times.begin(), times.end());
+
+            for (const DateTime key : {DateTime(0), DateTime(59), DateTime(60), DateTime(n * 15), DateTime(n * 30 + 1),
+                                       DateTime(n * 60 + 120), DateTimeUtils::inf - 1, DateTimeUtils::inf}) {
+                const size_t lower = std::lower_bound(times.begin(), times.end(), key) - times.begin();
+                const size_t upper = std::upper_bound(times.begin(), times.end(), key) - times.begin();
+                BOOST_REQUIRE_EQUAL(lower_bound_time(impl, times.data(), times.size(), key), lower);
+                BOOST_REQUIRE_EQUAL(upper_bound_time(impl, times.data(), times.size(), key), upper);
+            }
+        }
+    }
+}
+
+/*
+ * The snapshots of the caches saved in a file must give the same next stop
+ * times as the caches built on the fly
+ */
+BOOST_AUTO_TEST_CASE(cached_next_st_snapshots) {
+    ed::builder b("20120614");
+    b.vj("A")("stop1", "8:00"_t)("stop2", "8:10"_t, "8:12"_t)("stop3", "8:20"_t);
+    b.vj("A", "10101010")("stop1", "9:00"_t)("stop2", "9:10"_t, "9:12"_t)("stop3", "9:20"_t);
+    b.vj("A")("stop1", "23:50"_t)("stop2", "24:10"_t, "24:12"_t)("stop3", "24:20"_t);
+    b.frequency_vj("B", "8:00"_t, "18:00"_t, 30 * 60)("stop1", "8:00"_t)("stop3", "8:15"_t);
+    b.finish();
+    b.data->pt_data->sort_and_index();
+    b.data->build_uri();
+    b.data->build_raptor();
+
+    const auto filename = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    const auto& dataRaptor = *b.data->dataRaptor;
+    dataRaptor.cached_next_st_manager->save_snapshots(filename, *b.data, 1, 3);
+
+    CachedNextStopTimeManager built(dataRaptor, 10);
+    CachedNextStopTimeManager mapped(dataRaptor, 10);
+    BOOST_REQUIRE_EQUAL(mapped.load_snapshots(filename, *b.data), 3u);
+    boost::filesystem::remove(filename);
+
+    const nt::AccessibiliteParams accessibilite_params;
+    for (int day = 1; day <= 3; ++day) {
+        const auto from = DateTimeUtils::set(day, 0);
+        const auto built_cache = built.load(from, nt::RTLevel::Base, accessibilite_params);
+        const auto mapped_cache = mapped.load(from, nt::RTLevel::Base, accessibilite_params);
+        BOOST_CHECK_NE(built_cache, mapped_cache);
+        for (const auto jpp : dataRaptor.jp_container.get_jpps()) {
+            for (DateTime dt = from; dt < from + 2 * DateTimeUtils::SECONDS_PER_DAY; dt += 10 * 60) {
+                for (const auto stop_event : {StopEvent::pick_up, StopEvent::drop_off}) {
+                    for (const bool clockwise : {true, false}) {
+                        const auto expected = built_cache->next_stop_time(stop_event, jpp.first, dt, clockwise);
+                        const auto res = mapped_cache->next_stop_time(stop_event, jpp.first, dt, clockwise);
+                        BOOST_CHECK_EQUAL(res.first, expected.first);
+                        BOOST_CHECK_EQUAL(res.second, expected.second);
+                    }
+                }
+            }
+        }
+    }
+
+    // the snapshots are only used for the base level
+    const auto base_cache = mapped.load(DateTimeUtils::set(1, 0), nt::RTLevel::Base, accessibilite_params);
+    const auto rt_cache = mapped.load(DateTimeUtils::set(1, 0), nt::RTLevel::RealTime, accessibilite_params);
+    BOOST_CHECK_EQUAL(mapped.load(DateTimeUtils::set(1, 0), nt::RTLevel::Base, accessibilite_params), base_cache);
+    BOOST_CHECK_NE(rt_cache, base_cache);
+}
@@ -839,8 +839,8 @@ BOOST_FIXTURE_TEST_CASE(direct_path_under_the_limit, direct_path_routing_api_dat
     auto a_s_distance = B.distance_to(S) + distance_ab;
     auto a_s_dur = to_duration(a_s_distance, navitia::type::Mode_e::Walking);
 
-    auto sp = worker.find_nearest_stop_points(a_s_dur - navitia::seconds(1), b.data->pt_data->stop_point_proximity_list,
-                                              false);
+    auto sp = worker.find_nearest_stop_points(a_s_dur - navitia::seconds(1),
+                                              *b.data->pt_data->stop_point_proximity_list, false);
 
     navitia::routing::map_stop_point_duration tested_map;
     tested_map[navitia::routing::SpIdx(*(b.data->pt_data->stop_points_map["stop_point:stopB"]))] =
@@ -853,7 +853,7 @@ BOOST_FIXTURE_TEST_CASE(direct_path_exactly_the_limit, direct_path_routing_api_d
     auto a_s_distance = B.distance_to(S) + distance_ab;
     auto a_s_dur = to_duration(a_s_distance, navitia::type::Mode_e::Walking);
 
-    auto sp = worker.find_nearest_stop_points(a_s_dur, b.data->pt_data->stop_point_proximity_list, false);
+    auto sp = worker.find_nearest_stop_points(a_s_dur, *b.data->pt_data->stop_point_proximity_list, false);
 
     navitia::routing::map_stop_point_duration tested_map;
     tested_map[navitia::routing::SpIdx(*(b.data->pt_data->stop_points_map["stop_point:stopB"]))] =
@@ -868,8 +868,8 @@ BOOST_FIXTURE_TEST_CASE(direct_path_over_the_limit, direct_path_routing_api_data
     auto a_s_distance = B.distance_to(S) + distance_ab;
     auto a_s_dur = to_duration(a_s_distance, navitia::type::Mode_e::Walking);
 
-    auto sp = worker.find_nearest_stop_points(a_s_dur + navitia::seconds(1), b.data->pt_data->stop_point_proximity_list,
-                                              false);
+    auto sp = worker.find_nearest_stop_points(a_s_dur + navitia::seconds(1),
+                                              *b.data->pt_data->stop_point_proximity_list, false);
 
     navitia::routing::map_stop_point_duration tested_map;
     tested_map[navitia::routing::SpIdx(*(b.data->pt_data->stop_points_map["stop_point:stopB"]))] =
@@ -1865,7 +1865,7 @@ BOOST_AUTO_TEST_CASE(use_crow_fly) {
     BOOST_CHECK(nr::use_crow_fly(ep, sp2, empty_sn_path, data));
     BOOST_CHECK(!nr::use_crow_fly(ep, sp2, filled_sn_path, data));
 
-    admin->main_stop_areas.push_back(&sa2);
+    admin->main_stop_areas.push_back(sa2.idx);
     BOOST_CHECK(nr::use_crow_fly(ep, sp2, empty_sn_path, data));
     BOOST_CHECK(nr::use_crow_fly(ep, sp2, filled_sn_path, data));
 }
@@ -3486,6 +3486,66 @@ BOOST_AUTO_TEST_CASE(journeys_with_time_frame_duration) {
     BOOST_REQUIRE_EQUAL(resp.response_type(), pbnavitia::NO_SOLUTION);
 }
 
+/**
+ * @brief The time frame is split between several threads in range mode,
+ * and the journeys must be the same as the ones found by one thread
+ *
+ * Same data as journeys_with_time_frame_duration, one vj every 10 min from 08:00
+ */
+BOOST_AUTO_TEST_CASE(journeys_with_time_frame_duration_by_range) {
+    ed::builder b("20180309");
+
+    b.sa("stop_area:sa1")("stop_point:sa1:s1", 2.39592, 48.84848, false);
+    b.sa("stop_area:sa3")("stop_point:sa3:s1", 2.36381, 48.86650, false);
+
+    auto dep_time = "08:00:00"_t;
+    auto arr_time = "08:05:00"_t;
+    for (int nb = 0; nb < 20; ++nb) {
+        b.vj("A", "1", "", false, "vjC_" + std::to_string(nb))("stop_point:sa1:s1", dep_time + nb * "00:10::00"_t)(
+            "stop_point:sa3:s1", arr_time + nb * "00:10::00"_t);
+    }
+
+    b.finish();
+    b.data->pt_data->sort_and_index();
+    b.data->build_raptor();
+    b.data->build_uri();
+    b.data->build_proximity_list();
+    b.data->meta->production_date =
+        boost::gregorian::date_period(boost::gregorian::date(2018, 3, 9), boost::gregorian::days(1));
+
+    navitia::type::EntryPoint origin(navitia::type::Type_e::StopPoint, "stop_point:sa1:s1");
+    navitia::type::EntryPoint destination(navitia::type::Type_e::StopPoint, "stop_point:sa3:s1");
+    ng::StreetNetwork sn_worker(*b.data->geo_ref);
+    const uint32_t timeframe_duration = 60 * 60;
+
+    auto compute = [&](size_t nb_range_threads, bool clockwise, const std::string& datetime) {
+        nr::RAPTOR raptor(*(b.data));
+        raptor.nb_range_threads = nb_range_threads;
+        navitia::PbCreator pb_creator(b.data.get(), "20180309T075900"_dt, null_time_period);
+        make_response(pb_creator, raptor, origin, destination, {ntest::to_posix_timestamp(datetime)}, clockwise,
+                      navitia::type::AccessibiliteParams(), {}, {}, sn_worker, nt::RTLevel::Base, 2_min,
+                      24 * 60 * 60, 10, 0, 0, 0, boost::none, 1.5, 900, timeframe_duration);
+        return pb_creator.get_response();
+    };
+
+    for (const bool clockwise : {true, false}) {
+        const std::string datetime = clockwise ? "20180309T075900" : "20180309T093500";
+        const auto resp = compute(1, clockwise, datetime);
+        const auto resp_range = compute(3, clockwise, datetime);
+        BOOST_REQUIRE_EQUAL(resp.response_type(), pbnavitia::ITINERARY_FOUND);
+        BOOST_REQUIRE_EQUAL(resp_range.response_type(), pbnavitia::ITINERARY_FOUND);
+        BOOST_REQUIRE_EQUAL(resp.journeys_size(), 7);
+        BOOST_REQUIRE_EQUAL(resp_range.journeys_size(), resp.journeys_size());
+
+        const auto journeys = sort_journeys_by(resp, JourneySectionCompare());
+        const auto journeys_range = sort_journeys_by(resp_range, JourneySectionCompare());
+        for (size_t i = 0; i < journeys.size(); ++i) {
+            BOOST_CHECK_EQUAL(journeys_range[i].departure_date_time(), journeys[i].departure_date_time());
+            BOOST_CHECK_EQUAL(journeys_range[i].arrival_date_time(), journeys[i].arrival_date_time());
+        }
+    }
+}
+
 // basic journey without min_nb_journey nor timeframe_limit
 BOOST_AUTO_TEST_CASE(keep_going_tests_simple) {
     // no solution found: stop the search
@@ -0,0 +1,170 @@
+/* Copyright © 2001-2015, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "time_search.h"
+
+#include <limits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define NAVITIA_TIME_SEARCH_X86
+#include <immintrin.h>
+#endif
+
+namespace navitia {
+namespace routing {
+
+namespace {
+
+// Below this size, the block is scanned instead of being split in two
+constexpr size_t block_size = 32;
+
+size_t count_less_scalar(const DateTime* times, size_t n, const DateTime key) {
+    size_t res = 0;
+    for (size_t i = 0; i < n; ++i) {
+        res += times[i] < key;
+    }
+    return res;
+}
+
+#ifdef NAVITIA_TIME_SEARCH_X86
+// There is no unsigned comparison in SSE2/AVX2, flipping the sign bit
+// transforms the unsigned order into the signed one.
+constexpr int sign_flip = std::numeric_limits<int32_t>::min();
+
+size_t count_less_sse2(const DateTime* times, size_t n, const DateTime key) {
+    const __m128i flip = _mm_set1_epi32(sign_flip);
+    const __m128i k = _mm_xor_si128(_mm_set1_epi32(static_cast<int>(key)), flip);
+    size_t res = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(times + i)), flip);
+        const int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(k, v)));
+        res += __builtin_popcount(mask);
+    }
+    return res + count_less_scalar(times + i, n - i, key);
+}
+
+__attribute__((target("avx2"))) size_t count_less_avx2(const DateTime* times, size_t n, const DateTime key) {
+    const __m256i flip = _mm256_set1_epi32(sign_flip);
+    const __m256i k = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(key)), flip);
+    size_t res = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(times + i)), flip);
+        const int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(k, v)));
+        res += __builtin_popcount(mask);
+    }
+    return res + count_less_scalar(times + i, n - i, key);
+}
+#endif
+
+template <typename CountLess>
+size_t block_lower_bound(const DateTime* times, size_t n, const DateTime key, CountLess count_less) {
+    size_t first = 0;
+    while (n > block_size) {
+        const size_t half = n / 2;
+        if (times[first + half] < key) {
+            first += half + 1;
+            n -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    // the block is sorted, so the number of times less than key is the position of key in it
+    return first + count_less(times + first, n, key);
+}
+
+TimeSearchImpl supported(const TimeSearchImpl impl) {
+    return impl <= best_time_search_impl() ? impl : TimeSearchImpl::Scalar;
+}
+
+TimeSearchImpl detect_time_search_impl() {
+#ifdef NAVITIA_TIME_SEARCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return TimeSearchImpl::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return TimeSearchImpl::SSE2;
+    }
+#endif
+    return TimeSearchImpl::Scalar;
+}
+
+}  // namespace
+
+TimeSearchImpl best_time_search_impl() {
+    static const TimeSearchImpl impl = detect_time_search_impl();
+    return impl;
+}
+
+const char* to_string(const TimeSearchImpl impl) {
+    switch (impl) {
+        case TimeSearchImpl::Scalar:
+            return "scalar";
+        case TimeSearchImpl::SSE2:
+            return "sse2";
+        case TimeSearchImpl::AVX2:
+            return "avx2";
+    }
+    return "unknown";
+}
+
+size_t lower_bound_time(const TimeSearchImpl impl, const DateTime* times, const size_t n, const DateTime key) {
+    switch (supported(impl)) {
+#ifdef NAVITIA_TIME_SEARCH_X86
+        case TimeSearchImpl::AVX2:
+            return block_lower_bound(times, n, key, count_less_avx2);
+        case TimeSearchImpl::SSE2:
+            return block_lower_bound(times, n, key, count_less_sse2);
+#endif
+        default:
+            return block_lower_bound(times, n, key, count_less_scalar);
+    }
+}
+
+size_t upper_bound_time(const TimeSearchImpl impl, const DateTime* times, const size_t n, const DateTime key) {
+    // on integers, the first time greater than key is the first time not less than key + 1
+    if (key == std::numeric_limits<DateTime>::max()) {
+        return n;
+    }
+    return lower_bound_time(impl, times, n, key + 1);
+}
+
+size_t lower_bound_time(const DateTime* times, const size_t n, const DateTime key) {
+    return lower_bound_time(best_time_search_impl(), times, n, key);
+}
+
+size_t upper_bound_time(const DateTime* times, const size_t n, const DateTime key) {
+    return upper_bound_time(best_time_search_impl(), times, n, key);
+}
+
+}  // namespace routing
+}  // namespace navitia
@@ -0,0 +1,65 @@
+/* Copyright © 2001-2015, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include "type/datetime.h"
+
+#include <cstddef>
+
+namespace navitia {
+namespace routing {
+
+/*
+ * Search of a time in the sorted times of a journey pattern point.
+ *
+ * It's the hot spot of the next stop time search, so instead of a plain
+ * binary search, the range is narrowed by dichotomy down to a small block
+ * that is then scanned with SIMD comparisons (no unpredictable branches).
+ * The instruction set is chosen at runtime, with a scalar fallback.
+ */
+enum class TimeSearchImpl { Scalar, SSE2, AVX2 };
+
+// The best implementation available on the running cpu
+TimeSearchImpl best_time_search_impl();
+const char* to_string(TimeSearchImpl impl);
+
+// Index of the first time of [times, times + n) not less than key, like std::lower_bound
+size_t lower_bound_time(const DateTime* times, size_t n, DateTime key);
+// Index of the first time of [times, times + n) greater than key, like std::upper_bound
+size_t upper_bound_time(const DateTime* times, size_t n, DateTime key);
+
+// Same, with a given implementation, mainly for tests and benchmarks.
+// If the implementation is not supported by the cpu, the scalar one is used.
+size_t lower_bound_time(TimeSearchImpl impl, const DateTime* times, size_t n, DateTime key);
+size_t upper_bound_time(TimeSearchImpl impl, const DateTime* times, size_t n, DateTime key);
+
+}  // namespace routing
+}  // namespace navitia
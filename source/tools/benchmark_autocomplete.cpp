@@ -0,0 +1,132 @@
+/* Copyright © 2001-2015, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+#include <boost/program_options.hpp>
+
+#include "utils/init.h"  // init_app()
+#include "utils/timer.h"
+#include "type/data.h"
+#include "type/pt_data.h"
+#include "type/stop_area.h"
+#include "georef/georef.h"
+
+using namespace navitia;
+
+namespace po = boost::program_options;
+
+// the queries typed by a user searching a name: all its prefixes, a keystroke each
+static std::vector<std::string> make_queries(const std::vector<std::string>& names, size_t nb_names) {
+    std::vector<std::string> queries;
+    const size_t step = std::max(size_t(1), names.size() / std::max(size_t(1), nb_names));
+    for (size_t i = 0; i < names.size(); i += step) {
+        for (size_t len = 1; len <= names[i].size(); ++len) {
+            queries.push_back(names[i].substr(0, len));
+        }
+    }
+    return queries;
+}
+
+template <typename F>
+static void run(const std::string& label, const std::vector<std::string>& queries, int nb_runs, const F& search) {
+    size_t nb_results = 0;
+    Timer timer;
+    for (int run = 0; run < nb_runs; ++run) {
+        for (const auto& q : queries) {
+            nb_results += search(q).size();
+        }
+    }
+    const double ms = timer.ms();
+    std::cout << "\t" << label << ": " << ms * 1000 / (queries.size() * nb_runs) << " us per query, " << nb_results
+              << " results" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    navitia::init_app();
+    po::options_description desc("options of the autocomplete benchmark");
+    std::string file;
+    size_t nb_names, nbmax;
+    int nb_runs;
+
+    // clang-format off
+    desc.add_options()
+            ("help", "Show this message")
+            ("file,f", po::value<std::string>(&file)->default_value("data.nav.lz4"),
+                     "Path to the data file")
+            ("nb_names,n", po::value<size_t>(&nb_names)->default_value(1000),
+                     "Number of names whose prefixes are searched")
+            ("nbmax,m", po::value<size_t>(&nbmax)->default_value(10),
+                     "Number of results of each search")
+            ("nb_runs,r", po::value<int>(&nb_runs)->default_value(3),
+                     "Number of runs of all the queries");
+    // clang-format on
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        std::cout << "This is used to benchmark the autocomplete searches, "
+                  << "with the prefixes of the names of the stop areas and of the ways as queries" << std::endl;
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    type::Data data;
+    data.load_nav(file);
+    const auto& ghostwords = data.geo_ref->ghostwords;
+    const auto keep_all = [](type::idx_t) { return true; };
+
+    std::vector<std::string> names;
+    for (const auto* sa : data.pt_data->stop_areas) {
+        names.push_back(sa->name);
+    }
+    const auto sa_queries = make_queries(names, nb_names);
+    names.clear();
+    for (const auto* way : data.geo_ref->ways) {
+        names.push_back(way->name);
+    }
+    const auto way_queries = make_queries(names, nb_names);
+
+    const auto& sa_ac = *data.pt_data->stop_area_autocomplete;
+    std::cout << file << ", " << sa_queries.size() << " stop area queries:" << std::endl;
+    run("complete", sa_queries, nb_runs,
+        [&](const std::string& q) { return sa_ac.find_complete(q, nbmax, keep_all, ghostwords); });
+    run("pattern", sa_queries, nb_runs, [&](const std::string& q) {
+        return sa_ac.find_partial_with_pattern(q, data.geo_ref->word_weight, nbmax, keep_all, ghostwords);
+    });
+
+    const auto& way_ac = data.geo_ref->fl_way;
+    std::cout << file << ", " << way_queries.size() << " way queries:" << std::endl;
+    run("complete", way_queries, nb_runs,
+        [&](const std::string& q) { return way_ac.find_complete(q, nbmax, keep_all, ghostwords); });
+    run("pattern", way_queries, nb_runs, [&](const std::string& q) {
+        return way_ac.find_partial_with_pattern(q, data.geo_ref->word_weight, nbmax, keep_all, ghostwords);
+    });
+    return 0;
+}
@@ -0,0 +1,214 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#include "utils/init.h"  // init_app()
+#include "utils/timer.h"
+#include "type/data.h"
+#include "type/type.h"
+#include "georef/dijkstra_path_finder.h"
+
+using namespace navitia;
+
+namespace po = boost::program_options;
+
+// the graph replaced by the compressed graph, each vertex with its own vector of out edges
+using AdjacencyList = boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS, georef::Vertex, georef::Edge>;
+
+// time a plain boost dijkstra from each start vertex on the graph, filtered by the mode
+template <typename Graph>
+static double time_dijkstras(const Graph& graph,
+                             const georef::GeoRef& geo_ref,
+                             const type::Mode_e mode,
+                             const float speed_factor,
+                             const navitia::time_duration& radius,
+                             const std::vector<georef::vertex_t>& start_vertices) {
+    using filtered_graph = boost::filtered_graph<Graph, boost::keep_all, georef::TransportationModeFilter>;
+    const auto g = filtered_graph(graph, {}, georef::TransportationModeFilter(mode, geo_ref));
+    const size_t n = boost::num_vertices(graph);
+    std::vector<georef::vertex_t> predecessors(n);
+    std::vector<navitia::time_duration> distances(n);
+    double ms = 0;
+    for (const auto start : start_vertices) {
+        std::iota(predecessors.begin(), predecessors.end(), 0);
+        std::fill(distances.begin(), distances.end(), bt::pos_infin);
+        distances[start] = navitia::seconds(0);
+        Timer timer;
+        try {
+            boost::dijkstra_shortest_paths_no_init(
+                g, start, &predecessors[0], &distances[0], boost::get(&georef::Edge::duration, graph),
+                boost::identity_property_map(), std::less<navitia::time_duration>(),
+                georef::SpeedDistanceCombiner(speed_factor), navitia::seconds(0),
+                georef::dijkstra_distance_visitor(radius, distances));
+        } catch (georef::DestinationFound) {
+        }
+        ms += timer.ms();
+    }
+    return ms / start_vertices.size();
+}
+
+static void compare_with_adjacency_list(const georef::GeoRef& geo_ref,
+                                        const type::Mode_e mode,
+                                        const float speed_factor,
+                                        const navitia::time_duration& radius,
+                                        const std::vector<georef::vertex_t>& start_vertices) {
+    const auto& graph = geo_ref.graph;
+    AdjacencyList adjacency_list(boost::num_vertices(graph));
+    for (georef::vertex_t v = 0; v < boost::num_vertices(graph); ++v) {
+        adjacency_list[v] = graph[v];
+    }
+    for (const auto e : boost::make_iterator_range(boost::edges(graph))) {
+        boost::add_edge(boost::source(e, graph), boost::target(e, graph), graph[e], adjacency_list);
+    }
+
+    const size_t n = boost::num_vertices(graph), m = boost::num_edges(graph);
+    const size_t compressed_bytes =
+        n * (sizeof(georef::Vertex) + sizeof(uint32_t)) + m * sizeof(georef::Graph::OutEdge);
+    // a vector of out edges by vertex, and for each edge its target and a pointer to its property, allocated apart
+    // with the overhead of malloc
+    const size_t adjacency_list_bytes = n * (sizeof(georef::Vertex) + sizeof(std::vector<georef::vertex_t>))
+                                        + m * (2 * sizeof(void*) + sizeof(georef::Edge) + 2 * sizeof(void*));
+    std::cout << n << " vertices, " << m << " edges:" << std::endl;
+    std::cout << "	compressed graph: " << compressed_bytes / 1024 / 1024 << " MB, "
+              << time_dijkstras(graph, geo_ref, mode, speed_factor, radius, start_vertices) << " ms per dijkstra"
+              << std::endl;
+    std::cout << "	adjacency list: about " << adjacency_list_bytes / 1024 / 1024 << " MB, "
+              << time_dijkstras(adjacency_list, geo_ref, mode, speed_factor, radius, start_vertices)
+              << " ms per dijkstra" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    navitia::init_app();
+    po::options_description desc("options of the street network dijkstra benchmark");
+    std::string file, mode_str;
+    int nb_queries, max_duration;
+    float speed_factor;
+
+    // clang-format off
+    desc.add_options()
+            ("help", "Show this message")
+            ("file,f", po::value<std::string>(&file)->default_value("data.nav.lz4"),
+                     "Path to the data file")
+            ("mode,m", po::value<std::string>(&mode_str)->default_value("bike"),
+                     "Mode of the street network (walking, bike, car...)")
+            ("nb_queries,q", po::value<int>(&nb_queries)->default_value(100),
+                     "Number of dijkstras")
+            ("max_duration,d", po::value<int>(&max_duration)->default_value(3600),
+                     "Radius of the dijkstras, in seconds")
+            ("speed_factor,s", po::value<float>(&speed_factor)->default_value(1),
+                     "Speed factor of the mode");
+    // clang-format on
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        std::cout << "This is used to benchmark the dijkstra of the street network, "
+                  << "comparing the d-ary heap with the radix heap, the compressed graph with an adjacency list, "
+                  << "and the vertices in a random order with the vertices along a hilbert curve"
+                  << std::endl;
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    type::Data data;
+    data.load_nav(file);
+    auto& geo_ref = *data.geo_ref;
+    const auto mode = type::static_data::get()->modeByCaption(mode_str);
+    const auto radius = navitia::seconds(max_duration);
+
+    // the dijkstras start from random vertices of the mode
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<georef::vertex_t> vertex_dist(
+        geo_ref.offsets[mode], geo_ref.offsets[mode] + geo_ref.nb_vertex_by_mode - 1);
+    std::vector<georef::vertex_t> start_vertices;
+    std::vector<type::GeographicalCoord> starts;
+    for (int i = 0; i < nb_queries; ++i) {
+        start_vertices.push_back(vertex_dist(rng));
+        starts.push_back(geo_ref.graph[start_vertices.back()].coord);
+    }
+
+    georef::DijkstraPathFinder heap_dijkstra(geo_ref);
+    georef::DijkstraPathFinder radix_dijkstra(geo_ref);
+    radix_dijkstra.radix_heap_by_mode[mode] = true;
+
+    std::cout << nb_queries << " dijkstras in " << mode << " within " << max_duration << "s, on "
+              << boost::num_vertices(geo_ref.graph) << " vertices:" << std::endl;
+    const auto bench = [&](const std::string& label, georef::DijkstraPathFinder& dijkstra) {
+        size_t nb_reached = 0;
+        double ms = 0;
+        for (const auto& start : starts) {
+            dijkstra.init(start, mode, speed_factor);
+            Timer timer;
+            dijkstra.start_distance_dijkstra(radius);
+            ms += timer.ms();
+            nb_reached += std::count_if(dijkstra.distances.begin(), dijkstra.distances.end(),
+                                        [&](const navitia::time_duration& d) { return d <= radius; });
+        }
+        std::cout << "\t" << label << ": " << ms / nb_queries << " ms per dijkstra, " << nb_reached / nb_queries
+                  << " vertices reached per dijkstra" << std::endl;
+    };
+    bench("d-ary heap", heap_dijkstra);
+    bench("radix heap", radix_dijkstra);
+
+    compare_with_adjacency_list(geo_ref, mode, speed_factor, radius, start_vertices);
+
+    // the vertices shuffled, like in the order of the database, then renumbered like ed2nav does
+    geo_ref.contraction_hierarchies = {{{}}};
+    std::vector<georef::vertex_t> random_index(geo_ref.nb_vertex_by_mode);
+    std::iota(random_index.begin(), random_index.end(), 0);
+    std::shuffle(random_index.begin(), random_index.end(), rng);
+    geo_ref.permute_vertices(random_index);
+    bench("random vertex order", heap_dijkstra);
+    geo_ref.reorder_vertices();
+    bench("hilbert vertex order", heap_dijkstra);
+
+    // the two heaps must give the same durations
+    size_t nb_diffs = 0;
+    for (const auto& start : starts) {
+        heap_dijkstra.init(start, mode, speed_factor);
+        heap_dijkstra.start_distance_dijkstra(radius);
+        radix_dijkstra.init(start, mode, speed_factor);
+        radix_dijkstra.start_distance_dijkstra(radius);
+        for (size_t v = 0; v < heap_dijkstra.distances.size(); ++v) {
+            if ((heap_dijkstra.distances[v] <= radius || radix_dijkstra.distances[v] <= radius)
+                && heap_dijkstra.distances[v] != radix_dijkstra.distances[v]) {
+                ++nb_diffs;
+            }
+        }
+    }
+    std::cout << nb_diffs << " different durations" << std::endl;
+    return nb_diffs == 0 ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include <boost/program_options.hpp>
+#include <random>
+
+#include "utils/init.h"  // init_app()
+#include "utils/timer.h"
+#include "type/data.h"
+#include "type/pt_data.h"
+#include "routing/raptor.h"
+#include "fare/fare.h"
+
+using namespace navitia;
+
+namespace po = boost::program_options;
+
+int main(int argc, char** argv) {
+    navitia::init_app();
+    po::options_description desc("options of the fare benchmark");
+    std::string file;
+    int nb_journeys, nb_iterations;
+
+    // clang-format off
+    desc.add_options()
+            ("help", "Show this message")
+            ("file,f", po::value<std::string>(&file)->default_value("data.nav.lz4"),
+                     "Path to the data file")
+            ("nb_journeys,j", po::value<int>(&nb_journeys)->default_value(200),
+                     "Number of journeys computed between random stop areas")
+            ("nb_iterations,i", po::value<int>(&nb_iterations)->default_value(100),
+                     "Number of fare computations of each journey");
+    // clang-format on
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        std::cout << "This is used to benchmark the fare computation of journeys, "
+                  << "with the fare compiled at load and with the fare compiled for each computation" << std::endl;
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    type::Data data;
+    data.load_nav(file);
+    data.build_raptor();
+    const auto& fare = *data.fare;
+    if (fare.nb_transitions() < 2) {
+        std::cout << "no fare in " << file << std::endl;
+        return 1;
+    }
+
+    // the journeys of the morning between random stop areas
+    std::vector<routing::Path> paths;
+    routing::RAPTOR raptor(data);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> sa_dist(0, data.pt_data->stop_areas.size() - 1);
+    for (int i = 0; i < nb_journeys; ++i) {
+        const auto* from = data.pt_data->stop_areas[sa_dist(rng)];
+        const auto* to = data.pt_data->stop_areas[sa_dist(rng)];
+        const auto res = raptor.compute(from, to, 8 * 3600, 7, DateTimeUtils::set(8, 8 * 3600), type::RTLevel::Base,
+                                        2_min, true, {}, 10);
+        paths.insert(paths.end(), res.begin(), res.end());
+    }
+
+    // the same fare, no longer compiled: an isolated state changes no fare
+    fare::Fare not_compiled = fare;
+    not_compiled.add_state(fare::State());
+
+    size_t nb_tickets = 0, nb_diffs = 0;
+    const auto bench = [&](const std::string& label, const fare::Fare& f) {
+        Timer timer;
+        for (int i = 0; i < nb_iterations; ++i) {
+            for (const auto& path : paths) {
+                nb_tickets += f.compute_fare(path).tickets.size();
+            }
+        }
+        std::cout << "\t" << label << ": " << timer.ms() * 1000. / (nb_iterations * paths.size())
+                  << " us per journey" << std::endl;
+    };
+    std::cout << paths.size() << " journeys, " << fare.nb_transitions() << " fare transitions:" << std::endl;
+    bench("compiled at load", fare);
+    bench("compiled for each journey", not_compiled);
+
+    for (const auto& path : paths) {
+        const auto res = fare.compute_fare(path);
+        const auto expected = not_compiled.compute_fare(path);
+        if (res.total != expected.total || res.tickets.size() != expected.tickets.size()) {
+            ++nb_diffs;
+        }
+    }
+    std::cout << nb_tickets << " tickets, " << nb_diffs << " different fares" << std::endl;
+    return nb_diffs == 0 ? 0 : 1;
+}
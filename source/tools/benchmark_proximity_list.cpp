@@ -0,0 +1,151 @@
+/* Copyright © 2001-2015, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+#include <boost/program_options.hpp>
+#include <functional>
+#include <random>
+
+#include "utils/init.h"  // init_app()
+#include "utils/timer.h"
+#include "type/data.h"
+#include "georef/georef.h"
+
+using namespace navitia;
+
+namespace po = boost::program_options;
+
+using type::GeographicalCoord;
+
+// the searches of the previous index: the items sorted by longitude, scanned in the longitude band of the radius
+template <typename T>
+static size_t find_within_lon_band(const std::vector<typename proximitylist::ProximityList<T>::Item>& sorted_items,
+                                   const GeographicalCoord& coord,
+                                   double distance) {
+    using Item = typename proximitylist::ProximityList<T>::Item;
+    const double distance_degree = distance / 111320;
+    const double coslat = ::cos(coord.lat() * GeographicalCoord::N_DEG_TO_RAD);
+    auto begin = std::lower_bound(sorted_items.begin(), sorted_items.end(), coord.lon() - distance_degree / coslat,
+                                  [](const Item& i, double min) { return i.coord.lon() < min; });
+    auto end = std::upper_bound(begin, sorted_items.end(), coord.lon() + distance_degree / coslat,
+                                [](double max, const Item& i) { return max < i.coord.lon(); });
+    std::vector<std::pair<T, GeographicalCoord>> result;
+    for (; begin != end; ++begin) {
+        if (begin->coord.approx_sqr_distance(coord, coslat) <= distance * distance) {
+            result.push_back(std::make_pair(begin->element, begin->coord));
+        }
+    }
+    std::sort(result.begin(), result.end(), [&](const std::pair<T, GeographicalCoord>& a,
+                                                const std::pair<T, GeographicalCoord>& b) {
+        return a.second.approx_sqr_distance(coord, coslat) < b.second.approx_sqr_distance(coord, coslat);
+    });
+    return result.size();
+}
+
+template <typename T>
+static void run(const std::string& name,
+                const proximitylist::ProximityList<T>& pl,
+                int nb_queries,
+                double distance,
+                size_t k) {
+    if (pl.items.empty()) {
+        std::cout << name << ": empty" << std::endl;
+        return;
+    }
+    // the queries are around the items, where the users are
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> item_dist(0, pl.items.size() - 1);
+    std::uniform_real_distribution<double> jitter(-0.002, 0.002);
+    std::vector<GeographicalCoord> queries;
+    for (int i = 0; i < nb_queries; ++i) {
+        const auto& coord = pl.items[item_dist(rng)].coord;
+        queries.emplace_back(coord.lon() + jitter(rng), coord.lat() + jitter(rng));
+    }
+    auto sorted_items = pl.items;
+    std::sort(sorted_items.begin(), sorted_items.end(),
+              [](const typename proximitylist::ProximityList<T>::Item& a,
+                 const typename proximitylist::ProximityList<T>::Item& b) { return a.coord < b.coord; });
+
+    std::cout << name << ", " << pl.items.size() << " items, " << nb_queries << " queries:" << std::endl;
+    const auto bench = [&](const std::string& label, const std::function<size_t(const GeographicalCoord&)>& search) {
+        size_t nb_found = 0;
+        Timer timer;
+        for (const auto& coord : queries) {
+            nb_found += search(coord);
+        }
+        std::cout << "\t" << label << ": " << timer.ms() * 1000. / nb_queries << " us per query, " << nb_found
+                  << " found" << std::endl;
+    };
+    const auto radius = std::to_string(int(distance));
+    bench("longitude band find_within(" + radius + ")",
+          [&](const GeographicalCoord& coord) { return find_within_lon_band<T>(sorted_items, coord, distance); });
+    bench("grid find_within(" + radius + ")",
+          [&](const GeographicalCoord& coord) { return pl.find_within(coord, distance).size(); });
+    bench("grid find_k_nearest(" + std::to_string(k) + ", " + radius + ")",
+          [&](const GeographicalCoord& coord) { return pl.find_k_nearest(coord, k, distance).size(); });
+}
+
+int main(int argc, char** argv) {
+    navitia::init_app();
+    po::options_description desc("options of the proximity list benchmark");
+    std::string file;
+    int nb_queries;
+    double distance;
+    size_t k;
+
+    // clang-format off
+    desc.add_options()
+            ("help", "Show this message")
+            ("file,f", po::value<std::string>(&file)->default_value("data.nav.lz4"),
+                     "Path to the data file")
+            ("nb_queries,q", po::value<int>(&nb_queries)->default_value(10000),
+                     "Number of searches")
+            ("distance,d", po::value<double>(&distance)->default_value(500),
+                     "Radius of the searches, in meters")
+            ("k,k", po::value<size_t>(&k)->default_value(10),
+                     "Number of nearest elements searched");
+    // clang-format on
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        std::cout << "This is used to benchmark the proximity lists, "
+                  << "comparing the grid with the longitude band scan it replaced" << std::endl;
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    type::Data data;
+    data.load_nav(file);
+
+    run("pois", data.geo_ref->poi_proximity_list, nb_queries, distance, k);
+    run("vertices", data.geo_ref->pl, nb_queries, distance, k);
+    return 0;
+}
@@ -0,0 +1,111 @@
+/* Copyright © 2001-2015, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include <boost/program_options.hpp>
+
+#include "utils/init.h"  // init_app()
+#include "utils/timer.h"
+#include "type/data.h"
+#include "type/pt_data.h"
+
+using namespace navitia;
+
+namespace po = boost::program_options;
+
+// as the realtime does when adding trips: new lines, with a route each
+static void add_lines(type::PT_Data& pt_data, int nb_lines, int batch) {
+    auto* network = pt_data.get_or_create_network("network:benchmark", "benchmark network");
+    auto* mode = pt_data.get_or_create_commercial_mode("commercial_mode:benchmark", "benchmark mode");
+    for (int i = 0; i < nb_lines; ++i) {
+        const auto id = std::to_string(batch) + "_" + std::to_string(i);
+        auto* line = pt_data.get_or_create_line("line:benchmark_" + id, "benchmark line " + id, network, mode);
+        pt_data.get_or_create_route("route:benchmark_" + id, "benchmark route " + id, line);
+    }
+}
+
+int main(int argc, char** argv) {
+    navitia::init_app();
+    po::options_description desc("options of the realtime autocomplete benchmark");
+    std::string file;
+    int nb_batches, nb_lines;
+
+    // clang-format off
+    desc.add_options()
+            ("help", "Show this message")
+            ("file,f", po::value<std::string>(&file)->default_value("data.nav.lz4"),
+                     "Path to the data file")
+            ("nb_batches,b", po::value<int>(&nb_batches)->default_value(10),
+                     "Number of realtime batches")
+            ("nb_lines,l", po::value<int>(&nb_lines)->default_value(1),
+                     "Number of lines added by each batch");
+    // clang-format on
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        std::cout << "This is used to benchmark the autocomplete step of a realtime batch, "
+                  << "with a full rebuild of the public transport autocomplete and with its update" << std::endl;
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    type::Data data;
+    data.load_nav(file);
+
+    double build_ms = 0, update_ms = 0;
+    for (int batch = 0; batch < nb_batches; ++batch) {
+        add_lines(*data.pt_data, nb_lines, batch);
+
+        // before: the public transport autocomplete was rebuilt, with the scores
+        {
+            type::Data rebuilt;
+            rebuilt.clone_from(data);
+            Timer timer;
+            rebuilt.pt_data->build_autocomplete(*rebuilt.geo_ref);
+            rebuilt.pt_data->stop_point_autocomplete->compute_score(*rebuilt.pt_data, *rebuilt.geo_ref,
+                                                                    type::Type_e::StopPoint);
+            rebuilt.pt_data->stop_area_autocomplete->compute_score(*rebuilt.pt_data, *rebuilt.geo_ref,
+                                                                   type::Type_e::StopArea);
+            build_ms += timer.ms();
+        }
+
+        // after: only the new objects are inserted, and kept for the next batch
+        Timer timer;
+        data.update_pt_autocomplete();
+        update_ms += timer.ms();
+    }
+
+    std::cout << file << ", " << nb_batches << " batches of " << nb_lines << " new lines:" << std::endl
+              << "\tfull rebuild: " << build_ms / nb_batches << " ms per batch" << std::endl
+              << "\tupdate: " << update_ms / nb_batches << " ms per batch" << std::endl;
+    return 0;
+}
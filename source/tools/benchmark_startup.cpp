@@ -0,0 +1,100 @@
+/* Copyright © 2001-2015, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+#include <boost/program_options.hpp>
+#include <sys/resource.h>
+
+#include "utils/init.h"  // init_app()
+#include "utils/timer.h"
+#include "type/data.h"
+
+using namespace navitia;
+
+namespace po = boost::program_options;
+
+// peak resident memory of the process in MB
+static long max_rss_mb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024;
+}
+
+int main(int argc, char** argv) {
+    navitia::init_app();
+    po::options_description desc("options of the startup benchmark");
+    std::string file, output;
+    int raptor_cache_size;
+
+    // clang-format off
+    desc.add_options()
+            ("help", "Show this message")
+            ("file,f", po::value<std::string>(&file)->default_value("data.nav.lz4"),
+                     "Path to the data file, compressed or not")
+            ("raptor_cache_size", po::value<int>(&raptor_cache_size)->default_value(10),
+                     "maximum number of stored raptor caches")
+            ("raw_output", po::value<std::string>(&output),
+                     "Convert the data file in the uncompressed format");
+    // clang-format on
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        std::cout << "This is used to benchmark the time and memory needed by kraken to be ready with a data file"
+                  << std::endl;
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    // same steps as the DataManager, without the disruptions
+    type::Data data;
+    Timer load_timer;
+    data.load_nav(file);
+    const auto load_ms = load_timer.ms();
+    const auto load_rss = max_rss_mb();
+
+    Timer raptor_timer;
+    data.build_raptor(raptor_cache_size);
+    data.load_next_st_snapshots(file);
+    const auto raptor_ms = raptor_timer.ms();
+
+    std::cout << file << ":" << std::endl
+              << "\tload_nav: " << load_ms << " ms (peak memory " << load_rss << " MB)" << std::endl
+              << "\tbuild_raptor: " << raptor_ms << " ms" << std::endl
+              << "\tready in " << load_ms + raptor_ms << " ms (peak memory " << max_rss_mb() << " MB)" << std::endl;
+
+    if (!output.empty()) {
+        Timer save_timer;
+        data.save(output, type::NavFormat::Raw);
+        std::cout << "saved in the uncompressed format in " << output << " in " << save_timer.ms() << " ms"
+                  << std::endl;
+    }
+    return 0;
+}
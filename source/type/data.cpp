@@ -43,6 +43,7 @@ www.navitia.io
 #include "type/serialization.h"
 #include <boost/range/algorithm/find.hpp>
 #include <boost/container/container_fwd.hpp>
+#include <set>
 #include <thread>
 
 #include <eos_portable_archive/portable_iarchive.hpp>
@@ -56,6 +57,7 @@ www.navitia.io
 #include "georef/georef.h"
 #include "fare/fare.h"
 #include "type/meta_data.h"
+#include "type/mapped_file.h"
 #include "kraken/fill_disruption_from_database.h"
 
 namespace pt = boost::posix_time;
@@ -63,7 +65,7 @@ namespace pt = boost::posix_time;
 namespace navitia {
 namespace type {
 
-const unsigned int Data::data_version = 69;  //< *INCREMENT* every time serialized data are modified
+const unsigned int Data::data_version = 77;  //< *INCREMENT* every time serialized data are modified
 
 Data::Data(size_t data_identifier)
     : _last_rt_data_loaded(boost::posix_time::not_a_date_time),
@@ -71,9 +73,9 @@ Data::Data(size_t data_identifier)
       data_identifier(data_identifier),
       meta(std::make_unique<MetaData>()),
       pt_data(std::make_unique<PT_Data>()),
-      geo_ref(std::make_unique<navitia::georef::GeoRef>()),
+      geo_ref(std::make_shared<navitia::georef::GeoRef>()),
       dataRaptor(std::make_unique<navitia::routing::dataRAPTOR>()),
-      fare(std::make_unique<navitia::fare::Fare>()),
+      fare(std::make_shared<navitia::fare::Fare>()),
       find_admins([&](const GeographicalCoord& c, georef::AdminRtree& admin_tree) {
           return geo_ref->find_admins(c, admin_tree);
       }),
@@ -85,10 +87,51 @@ Data::Data(size_t data_identifier)
 
 Data::~Data() {}
 
+// The admins are in the georef, the stop points and the stop areas refer to them by their idx in the archive
+template <typename T>
+static std::vector<std::vector<idx_t>> get_admin_idx(const std::vector<T*>& objects) {
+    std::vector<std::vector<idx_t>> admin_idx;
+    admin_idx.reserve(objects.size());
+    for (const auto* object : objects) {
+        admin_idx.emplace_back();
+        for (const auto* admin : object->admin_list) {
+            admin_idx.back().push_back(admin->idx);
+        }
+    }
+    return admin_idx;
+}
+
+template <typename T>
+static void set_admins(std::vector<T*>& objects,
+                       const std::vector<std::vector<idx_t>>& admin_idx,
+                       const georef::GeoRef& geo_ref) {
+    if (admin_idx.size() != objects.size()) {
+        throw navitia::exception("inconsistent admins of the public transport objects");
+    }
+    for (size_t i = 0; i < objects.size(); ++i) {
+        objects[i]->admin_list.clear();
+        for (const auto idx : admin_idx[i]) {
+            objects[i]->admin_list.push_back(geo_ref.admins.at(idx));
+        }
+    }
+}
+
+// The autocompletes and the proximity lists of the public transport objects
+// are not in the archive of pt_data, so that the clones can share them
+template <class Archive>
+static void serialize_pt_indexes(Archive& ar, PT_Data& pt_data) {
+    ar& *pt_data.stop_area_autocomplete& *pt_data.stop_point_autocomplete& *pt_data.line_autocomplete&
+        *pt_data.network_autocomplete& *pt_data.mode_autocomplete& *pt_data.route_autocomplete&
+            *pt_data.stop_area_proximity_list& *pt_data.stop_point_proximity_list;
+}
+
 template <class Archive>
 void Data::save(Archive& ar, const unsigned int) const {
-    ar& pt_data& geo_ref& meta& fare& last_load_at& loaded& last_load_succeeded& is_connected_to_rabbitmq&
-        is_realtime_loaded;
+    const auto stop_point_admins = get_admin_idx(pt_data->stop_points);
+    const auto stop_area_admins = get_admin_idx(pt_data->stop_areas);
+    ar& pt_data& *geo_ref& meta& *fare& last_load_at& loaded& last_load_succeeded& is_connected_to_rabbitmq&
+        is_realtime_loaded& stop_point_admins& stop_area_admins;
+    serialize_pt_indexes(ar, *pt_data);
 }
 template <class Archive>
 void Data::load(Archive& ar, const unsigned int version) {
@@ -100,18 +143,29 @@ void Data::load(Archive& ar, const unsigned int version) {
             % version % v;
         throw navitia::data::wrong_version(msg.str());
     }
-    ar& pt_data& geo_ref& meta& fare& last_load_at& loaded& last_load_succeeded& is_connected_to_rabbitmq&
-        is_realtime_loaded;
+    std::vector<std::vector<idx_t>> stop_point_admins, stop_area_admins;
+    ar& pt_data& *geo_ref& meta& *fare& last_load_at& loaded& last_load_succeeded& is_connected_to_rabbitmq&
+        is_realtime_loaded& stop_point_admins& stop_area_admins;
+    serialize_pt_indexes(ar, *pt_data);
+    set_admins(pt_data->stop_points, stop_point_admins, *geo_ref);
+    set_admins(pt_data->stop_areas, stop_area_admins, *geo_ref);
 }
 SPLIT_SERIALIZABLE(Data)
 
+// tag at the beginning of the uncompressed binary data files
+static const std::string raw_nav_tag = "navitia_raw_nav";
+
+static bool is_raw_nav(const char* begin, size_t size) {
+    return size >= raw_nav_tag.size() && std::equal(raw_nav_tag.begin(), raw_nav_tag.end(), begin);
+}
+
 /**
- * @brief Load data (in nav.lz4).
- * 1. Uncompress lz4 file
- * 2. Read .nav
- * 3. Load in type::Data structure
+ * @brief Load data (in nav.lz4 or uncompressed).
+ * 1. Map the file in memory
+ * 2. Uncompress lz4 if the file is not tagged as uncompressed, in parallel for the chunked lz4 container
+ * 3. Load in type::Data structure, the pages of the file being released once read
  *
- * @param filename Lz4 data File name (file.nav.lz4)
+ * @param filename data File name (file.nav.lz4)
  */
 void Data::load_nav(const std::string& filename) {
     // Add logger
@@ -124,9 +178,25 @@ void Data::load_nav(const std::string& filename) {
     }
 
     try {
-        std::ifstream ifs(filename.c_str(), std::ios::in | std::ios::binary);
-        ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        this->load(ifs);
+        MappedFile file(filename);
+        if (is_raw_nav(file.begin, file.size)) {
+            LOG4CPLUS_DEBUG(logger, "Uncompressed binary data file");
+            this->load_raw(file);
+        } else if (lz4_chunked::is_chunked(file.begin, file.size)) {
+            LOG4CPLUS_DEBUG(logger, "Chunked lz4 data file, decompressed in parallel");
+            boost::iostreams::filtering_streambuf<boost::iostreams::input> in;
+            in.push(LZ4ChunkedSource(file.begin, file.size, lz4_chunked::default_nb_threads(),
+                                     [&file](const char* until) { file.release(until); }),
+                    8192 * 500, 8192 * 500);
+            eos::portable_iarchive ia(in);
+            ia >> *this;
+        } else {
+            boost::iostreams::filtering_streambuf<boost::iostreams::input> in;
+            in.push(LZ4Decompressor(2048 * 500), 8192 * 500, 8192 * 500);
+            in.push(MappedFileSource(file));
+            eos::portable_iarchive ia(in);
+            ia >> *this;
+        }
         loaded = true;
         last_load_at = pt::microsec_clock::universal_time();
         last_load_succeeded = true;
@@ -143,10 +213,12 @@ void Data::load_nav(const std::string& filename) {
     LOG4CPLUS_DEBUG(logger, "Finished to load nav");
 }
 
-void Data::load(std::istream& ifs) {
+void Data::load_raw(MappedFile& file) {
+    if (!is_raw_nav(file.begin, file.size)) {
+        throw navitia::exception("not an uncompressed binary data file");
+    }
     boost::iostreams::filtering_streambuf<boost::iostreams::input> in;
-    in.push(LZ4Decompressor(2048 * 500), 8192 * 500, 8192 * 500);
-    in.push(ifs);
+    in.push(MappedFileSource(file, raw_nav_tag.size()));
     eos::portable_iarchive ia(in);
     ia >> *this;
 }
@@ -197,14 +269,63 @@ void Data::build_raptor(size_t cache_size) {
     log4cplus::Logger logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
     LOG4CPLUS_DEBUG(logger, "Start to build data Raptor");
     dataRaptor->load(*this->pt_data, cache_size);
+    pt_data->vj_delta.clear();
     LOG4CPLUS_DEBUG(logger, "Finished to build data Raptor");
 }
 
+/**
+ * @brief Build Data Raptor from the one of the data this one has been
+ * cloned from, only the vehicle journeys touched by the realtime since
+ * the clone being rebuilt
+ */
+void Data::update_raptor(const Data& previous, size_t cache_size) {
+    log4cplus::Logger logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
+    LOG4CPLUS_DEBUG(logger, "Start to update data Raptor");
+    dataRaptor->load(*this->pt_data, *previous.dataRaptor, cache_size);
+    pt_data->vj_delta.clear();
+    LOG4CPLUS_DEBUG(logger, "Finished to update data Raptor");
+}
+
+static std::string next_st_snapshots_filename(const std::string& filename) {
+    return filename + ".next_st";
+}
+
+void Data::load_next_st_snapshots(const std::string& filename) {
+    log4cplus::Logger logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
+    const auto snapshots_filename = next_st_snapshots_filename(filename);
+    if (!boost::filesystem::exists(snapshots_filename)) {
+        LOG4CPLUS_DEBUG(logger, "No next stop time snapshots for " << filename);
+        return;
+    }
+    // the snapshots are only an optimization, the data is still usable without them
+    try {
+        dataRaptor->cached_next_st_manager->load_snapshots(snapshots_filename, *this);
+    } catch (const std::exception& ex) {
+        LOG4CPLUS_WARN(logger, "Unable to load next stop time snapshots: " << ex.what());
+    }
+}
+
+void Data::save_next_st_snapshots(const std::string& filename, size_t nb_days) const {
+    log4cplus::Logger logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
+    const auto& production_date = meta->production_date;
+    const auto today = boost::gregorian::day_clock::local_day();
+    const size_t first_day = production_date.contains(today) ? (today - production_date.begin()).days() : 0;
+    nb_days = std::min(nb_days, size_t(production_date.length().days()) - first_day);
+
+    LOG4CPLUS_INFO(logger, "Saving the next stop time snapshots of " << nb_days << " days from day " << first_day);
+    try {
+        dataRaptor->cached_next_st_manager->save_snapshots(next_st_snapshots_filename(filename), *this, first_day,
+                                                           nb_days);
+    } catch (const std::ofstream::failure& e) {
+        throw navitia::exception(std::string("Unable to write next stop time snapshots: ") + e.what());
+    }
+}
+
 void Data::warmup(const Data& other) {
     this->dataRaptor->warmup(*other.dataRaptor);
 }
 
-void Data::save(const std::string& filename) const {
+void Data::save(const std::string& filename, NavFormat format) const {
     log4cplus::Logger logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT("logger"));
     boost::filesystem::path p(filename);
     boost::filesystem::path dir = p.parent_path();
@@ -220,7 +341,11 @@ void Data::save(const std::string& filename) const {
     std::ofstream ofs(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
     ofs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
     try {
-        this->save(ofs);
+        if (format == NavFormat::Raw) {
+            this->save_raw(ofs);
+        } else {
+            this->save(ofs);
+        }
     } catch (const boost::filesystem::filesystem_error& e) {
         if (e.code() == boost::system::errc::permission_denied)
             LOG4CPLUS_ERROR(logger, "Writing permission is denied for " << p);
@@ -245,8 +370,20 @@ void Data::save(const std::string& filename) const {
 
 void Data::save(std::ostream& ofs) const {
     boost::iostreams::filtering_streambuf<boost::iostreams::output> out;
-    out.push(LZ4Compressor(2048 * 500), 1024 * 500, 1024 * 500);
+    out.push(LZ4ChunkedCompressor(), 1024 * 500, 1024 * 500);
     out.push(ofs);
+    {
+        eos::portable_oarchive oa(out);
+        oa << *this;
+    }
+    // writes the last chunks and the index, the errors would be lost if done by the destructor
+    out.reset();
+}
+
+void Data::save_raw(std::ostream& ofs) const {
+    ofs.write(raw_nav_tag.data(), raw_nav_tag.size());
+    boost::iostreams::filtering_streambuf<boost::iostreams::output> out;
+    out.push(ofs, 1024 * 500, 1024 * 500);
     eos::portable_oarchive oa(out);
     oa << *this;
 }
@@ -314,7 +451,7 @@ void Data::build_administrative_regions() {
     for (const auto* sa : pt_data->stop_areas)
         for (auto admin : sa->admin_list)
             if (!admin->from_original_dataset)
-                admin->main_stop_areas.push_back(sa);
+                admin->main_stop_areas.push_back(sa->idx);
 }
 
 void Data::build_autocomplete() {
@@ -323,6 +460,11 @@ void Data::build_autocomplete() {
     pt_data->compute_score_autocomplete(*geo_ref);
 }
 
+void Data::update_pt_autocomplete() {
+    // the stop areas and stop points, and thus the scores, are unchanged
+    pt_data->update_autocomplete(*geo_ref);
+}
+
 ValidityPattern* Data::get_similar_validity_pattern(ValidityPattern* vp) const {
     auto find_vp_predicate = [&](ValidityPattern* vp1) { return ((*vp) == (*vp1)); };
     auto it = std::find_if(this->pt_data->validity_patterns.begin(), this->pt_data->validity_patterns.end(),
@@ -392,7 +534,18 @@ void Data::complete() {
     compute_labels();
 
     start = pt::microsec_clock::local_time();
+    // the admins refer to the stop areas and stop points by idx, which are changed by the sort
+    const auto stop_areas_before_sort = pt_data->stop_areas;
+    const auto stop_points_before_sort = pt_data->stop_points;
     pt_data->sort_and_index();
+    for (auto* admin : geo_ref->admins) {
+        for (auto& sa_idx : admin->main_stop_areas) {
+            sa_idx = stop_areas_before_sort[sa_idx]->idx;
+        }
+        for (auto& sp_idx : admin->odt_stop_points) {
+            sp_idx = stop_points_before_sort[sp_idx]->idx;
+        }
+    }
     sort = (pt::microsec_clock::local_time() - start).total_milliseconds();
 
     start = pt::microsec_clock::local_time();
@@ -470,7 +623,7 @@ void Data::aggregate_odt() {
     // we first store the stops in a set not to have duplicates
     for (const auto& p : odt_stops_by_admin) {
         for (const auto& sp : p.second) {
-            p.first->odt_stop_points.push_back(sp);
+            p.first->odt_stop_points.push_back(sp->idx);
         }
     }
 }
@@ -800,9 +953,9 @@ struct Pipe {
 };
 }  // anonymous namespace
 
-// We want to do a deep clone of a Data.  The problem is that there is a
-// lot of pointers that point to each other, and thus writing a copy
-// assignment operator is really tricky.
+// We want to do a deep clone of the public transport objects of a Data.
+// The problem is that there is a lot of pointers that point to each
+// other, and thus writing a copy assignment operator is really tricky.
 //
 // But we already have a framework that allow this deep clone: boost
 // serialize.  Maybe we can write a dedicated Archive that clone the
@@ -810,17 +963,50 @@ struct Pipe {
 // stream the source object in a binary_oarchive, and then stream it
 // in our object.  To avoid having the whole binary_oarchive in
 // memory, we construct a pipe between 2 threads.
+//
+// The realtime only modifies the public transport objects, so the
+// georef and the fares, the biggest parts, are shared with the source.
+// So are the autocompletes and the proximity lists of the public
+// transport objects, the realtime replacing the ones it updates.
 void Data::clone_from(const Data& from) {
+    geo_ref = from.geo_ref;
+    fare = from.fare;
+
     Pipe p;
     std::thread write([&]() {
         boost::archive::binary_oarchive oa(p.out);
-        oa << from;
+        oa << *from.pt_data << *from.meta;
     });
     {
         boost::archive::binary_iarchive ia(p.in);
-        ia >> *this;
+        ia >> *pt_data >> *meta;
     }
     write.join();
+
+    pt_data->stop_area_autocomplete = from.pt_data->stop_area_autocomplete;
+    pt_data->stop_point_autocomplete = from.pt_data->stop_point_autocomplete;
+    pt_data->line_autocomplete = from.pt_data->line_autocomplete;
+    pt_data->network_autocomplete = from.pt_data->network_autocomplete;
+    pt_data->mode_autocomplete = from.pt_data->mode_autocomplete;
+    pt_data->route_autocomplete = from.pt_data->route_autocomplete;
+    pt_data->stop_area_proximity_list = from.pt_data->stop_area_proximity_list;
+    pt_data->stop_point_proximity_list = from.pt_data->stop_point_proximity_list;
+
+    // The admins are not in the archive of the public transport objects,
+    // the georef being shared, the source ones are used
+    for (const auto* sp : from.pt_data->stop_points) {
+        pt_data->stop_points[sp->idx]->admin_list = sp->admin_list;
+    }
+    for (const auto* sa : from.pt_data->stop_areas) {
+        pt_data->stop_areas[sa->idx]->admin_list = sa->admin_list;
+    }
+
+    version = from.version;
+    loaded = from.loaded.load();
+    last_load_at = from.last_load_at;
+    last_load_succeeded = from.last_load_succeeded;
+    is_connected_to_rabbitmq = from.is_connected_to_rabbitmq.load();
+    is_realtime_loaded = from.is_realtime_loaded.load();
 }
 
 void Data::set_last_rt_data_loaded(const boost::posix_time::ptime& p) const {
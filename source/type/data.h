@@ -101,6 +101,12 @@ struct ContainerTrait<type::MetaVehicleJourney> {
     typedef vect_type associative_type;
 };
 
+/** Storage format of the data files written by ed2nav */
+enum class NavFormat {
+    LZ4,  // compressed binary, the smallest
+    Raw   // uncompressed binary archive, deserialized from a memory mapping
+};
+
 /** Contains all the Public Transport Referential data (aka. PT-Ref), base-schedule and realtime.
  *
  * There are 3 storage formats : text, binary, compressed binary
@@ -126,13 +132,15 @@ public:
     // public transport (PT) referential
     std::unique_ptr<PT_Data> pt_data;
 
-    std::unique_ptr<navitia::georef::GeoRef> geo_ref;
+    // the street network and the fares are never modified by the realtime,
+    // so they are shared by the cloned data (see clone_from)
+    std::shared_ptr<navitia::georef::GeoRef> geo_ref;
 
     // precomputed data for raptor (public transport routing algorithm)
     std::unique_ptr<navitia::routing::dataRAPTOR> dataRaptor;
 
     // Fare data
-    std::unique_ptr<navitia::fare::Fare> fare;
+    std::shared_ptr<navitia::fare::Fare> fare;
 
     // functor to find admins
     std::function<std::vector<georef::Admin*>(const GeographicalCoord&, georef::AdminRtree&)> find_admins;
@@ -200,11 +208,18 @@ public:
     void load_nav(const std::string& filename);
     void load_disruptions(const std::string& database, const std::vector<std::string>& contributors = {});
     void build_raptor(size_t cache_size = 10);
+    /** Build data raptor incrementally, for a data cloned from previous and modified by the realtime */
+    void update_raptor(const Data& previous, size_t cache_size = 10);
+    /** Load the next stop time caches saved next to the data file by save_next_st_snapshots, if any */
+    void load_next_st_snapshots(const std::string& filename);
 
     void warmup(const Data& other);
 
     /** Save data */
-    void save(const std::string& filename) const;
+    void save(const std::string& filename, NavFormat format = NavFormat::LZ4) const;
+
+    /** Save next to the data file the next stop time caches of the next nb_days days (needs build_raptor) */
+    void save_next_st_snapshots(const std::string& filename, size_t nb_days) const;
 
     /** Build ExternalCode index */
     void build_uri();
@@ -212,6 +227,10 @@ public:
     /** Build Autocomplete index */
     void build_autocomplete();
 
+    /** Update the Autocomplete index of the public transport objects with the ones added by the realtime, the
+     * georef ones being unchanged */
+    void update_pt_autocomplete();
+
     /** Build ProximityList index */
     void build_proximity_list();
     /** Set admins*/
@@ -230,17 +249,21 @@ public:
     /** Return the type of the id provided */
     Type_e get_type_of_id(const std::string& id) const;
 
-    /** Load data from a binary file compressed using LZ4
+    /** Save data in a compressed binary file using LZ4*/
+    void save(std::ostream& ifs) const;
+
+    /** Load data from an uncompressed binary archive mapped in memory
      *
-     * LZ4 compression is super fast but its efficiency is average
-     * The goal is to achieve the same read performance with and without compression
+     * The archive is still deserialized into the objects, only the decompression
+     * is skipped. The pages of the file are released as the archive reads them.
      */
-    void load(std::istream& ifs);
+    void load_raw(MappedFile& file);
 
-    /** Save data in a compressed binary file using LZ4*/
-    void save(std::ostream& ifs) const;
+    /** Save data in an uncompressed binary file, begining with a tag to recognize the format */
+    void save_raw(std::ostream& ofs) const;
 
-    // Deep clone from the given Data.
+    // Clone from the given Data: deep copy of the public transport
+    // objects, the immutable parts are shared.
     void clone_from(const Data&);
 
     void set_last_rt_data_loaded(const boost::posix_time::ptime&) const;
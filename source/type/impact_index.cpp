@@ -0,0 +1,137 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "type/impact_index.h"
+#include "type/line.h"
+#include "type/message.h"
+#include "type/network.h"
+#include "type/route.h"
+#include "type/stop_area.h"
+#include "type/type.h"
+#include "type/vehicle_journey.h"
+
+#include <boost/variant/static_visitor.hpp>
+
+#include <algorithm>
+
+namespace navitia {
+namespace type {
+
+namespace {
+
+struct LinkedObjectsVisitor : boost::static_visitor<> {
+    std::vector<std::pair<Type_e, idx_t>>& objects;
+    explicit LinkedObjectsVisitor(std::vector<std::pair<Type_e, idx_t>>& objects) : objects(objects) {}
+
+    void operator()(const disruption::UnknownPtObj&) const {}
+    void operator()(const Network* network) const { objects.emplace_back(Type_e::Network, network->idx); }
+    void operator()(const Line* line) const { objects.emplace_back(Type_e::Line, line->idx); }
+    void operator()(const Route* route) const { objects.emplace_back(Type_e::Route, route->idx); }
+    void operator()(const StopArea* stop_area) const { objects.emplace_back(Type_e::StopArea, stop_area->idx); }
+    void operator()(const StopPoint* stop_point) const { objects.emplace_back(Type_e::StopPoint, stop_point->idx); }
+    void operator()(const MetaVehicleJourney* meta_vj) const {
+        objects.emplace_back(Type_e::MetaVehicleJourney, meta_vj->idx);
+    }
+    void operator()(const disruption::LineSection& line_section) const {
+        // the impact is linked to the stop points of the section of the impacted vehicle journeys,
+        // we take the section of all the vehicle journeys of the routes, whatever their period
+        for (const auto* route : line_section.routes) {
+            route->for_each_vehicle_journey([&](const VehicleJourney& vj) {
+                for (const auto* sp : vj.get_sections_stop_points(line_section.start_point, line_section.end_point)) {
+                    objects.emplace_back(Type_e::StopPoint, sp->idx);
+                }
+                return true;
+            });
+        }
+    }
+};
+
+}  // namespace
+
+void ImpactIndex::add(const boost::shared_ptr<disruption::Impact>& impact) {
+    // an impact can be linked to new objects after having been indexed
+    remove(impact);
+
+    std::vector<Object> objects;
+    LinkedObjectsVisitor visitor(objects);
+    for (const auto& ptobj : impact->informed_entities()) {
+        boost::apply_visitor(visitor, ptobj);
+    }
+    std::sort(objects.begin(), objects.end());
+    objects.erase(std::unique(objects.begin(), objects.end()), objects.end());
+    if (objects.empty()) {
+        return;
+    }
+
+    for (const auto& object : objects) {
+        ++nb_impacts[object];
+    }
+    objects_by_impact[impact] = std::move(objects);
+}
+
+void ImpactIndex::remove(const boost::shared_ptr<disruption::Impact>& impact) {
+    const auto it = objects_by_impact.find(impact);
+    if (it == objects_by_impact.end()) {
+        return;
+    }
+    for (const auto& object : it->second) {
+        auto nb_it = nb_impacts.find(object);
+        if (nb_it != nb_impacts.end() && --nb_it->second == 0) {
+            nb_impacts.erase(nb_it);
+        }
+    }
+    objects_by_impact.erase(it);
+}
+
+void ImpactIndex::rebuild(const disruption::DisruptionHolder& holder) {
+    clear();
+    for (const auto& weak_impact : holder.get_weak_impacts()) {
+        if (const auto impact = weak_impact.lock()) {
+            add(impact);
+        }
+    }
+}
+
+void ImpactIndex::clear() {
+    nb_impacts.clear();
+    objects_by_impact.clear();
+}
+
+Indexes ImpactIndex::get(Type_e type) const {
+    Indexes result;
+    const auto end = nb_impacts.upper_bound({type, invalid_idx});
+    for (auto it = nb_impacts.lower_bound({type, 0}); it != end; ++it) {
+        result.insert(result.end(), it->first.second);
+    }
+    return result;
+}
+
+}  // namespace type
+}  // namespace navitia
@@ -0,0 +1,83 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+#include "type/type_interfaces.h"
+
+#include <boost/shared_ptr.hpp>
+#include <boost/smart_ptr/owner_less.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace navitia {
+namespace type {
+namespace disruption {
+struct Impact;
+class DisruptionHolder;
+}  // namespace disruption
+
+/**
+ * Objects linked to the impacts, to find the disrupted objects without walking the whole network.
+ *
+ * A line section is indexed as the stop points of its section, as they are the objects the impact
+ * is linked to. The index may hold objects without any publishable message, the callers must still
+ * check the messages of the objects they find.
+ *
+ * It is updated when an impact is applied or deleted (see apply_disruption), and rebuilt when the
+ * data is loaded, thus it is not serialized.
+ */
+class ImpactIndex {
+public:
+    // (re)index the objects the impact is linked to
+    void add(const boost::shared_ptr<disruption::Impact>& impact);
+    void remove(const boost::shared_ptr<disruption::Impact>& impact);
+    void rebuild(const disruption::DisruptionHolder& holder);
+    void clear();
+
+    // the indexes of the objects of the given type linked to at least one impact
+    Indexes get(Type_e type) const;
+
+private:
+    using Object = std::pair<Type_e, idx_t>;
+
+    // number of impacts linked to each object
+    std::map<Object, size_t> nb_impacts;
+    // by the ownership of the impacts, not their address that can be reused by a new impact
+    std::map<boost::weak_ptr<disruption::Impact>,
+             std::vector<Object>,
+             boost::owner_less<boost::weak_ptr<disruption::Impact>>>
+        objects_by_impact;
+};
+
+}  // namespace type
+}  // namespace navitia
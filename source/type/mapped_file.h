@@ -0,0 +1,137 @@
+/* Copyright © 2001-2015, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+
+#include "utils/exception.h"
+
+#include <boost/iostreams/concepts.hpp>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace navitia {
+namespace type {
+
+/**
+ * Read only memory mapping of a whole file.
+ *
+ * The file is meant to be read once from its beginning to its end, so the
+ * kernel can read ahead. The pages read stay resident until they are given
+ * back with release() or the mapping is released.
+ */
+struct MappedFile {
+    const char* begin = nullptr;
+    size_t size = 0;
+
+    explicit MappedFile(const std::string& filename) {
+        const int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw navitia::exception("impossible to open " + filename);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw navitia::exception("impossible to stat " + filename);
+        }
+        size = st.st_size;
+        void* addr = size == 0 ? nullptr : ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            throw navitia::exception("impossible to map " + filename);
+        }
+        if (addr) {
+            ::madvise(addr, size, MADV_SEQUENTIAL);
+        }
+        begin = static_cast<const char*>(addr);
+        released = begin;
+    }
+    ~MappedFile() {
+        if (begin) {
+            ::munmap(const_cast<char*>(begin), size);
+        }
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* end() const { return begin + size; }
+
+    // Give back to the kernel the whole pages before until, they are read again from the file if needed
+    void release(const char* until) {
+        const size_t page_size = ::sysconf(_SC_PAGESIZE);
+        const char* last_page = begin + (size_t(std::min(until, end()) - begin) / page_size) * page_size;
+        if (last_page > released) {
+            ::madvise(const_cast<char*>(released), last_page - released, MADV_DONTNEED);
+            released = last_page;
+        }
+    }
+
+private:
+    const char* released = nullptr;
+};
+
+/**
+ * Source reading a mapped file from an offset to its end
+ *
+ * The pages read are released every release_step bytes, so the file is not
+ * kept in memory next to the objects built from it.
+ */
+class MappedFileSource : public boost::iostreams::source {
+    MappedFile* file;
+    const char* pos;
+    const char* last_release;
+
+public:
+    static const size_t release_step = 16 * 1024 * 1024;
+
+    explicit MappedFileSource(MappedFile& file, size_t offset = 0)
+        : file(&file), pos(file.begin + std::min(offset, file.size)), last_release(pos) {}
+
+    std::streamsize read(char* dest, std::streamsize n) {
+        if (pos == file->end()) {
+            return -1;
+        }
+        const size_t nb = std::min(size_t(n), size_t(file->end() - pos));
+        memcpy(dest, pos, nb);
+        pos += nb;
+        if (size_t(pos - last_release) >= release_step || pos == file->end()) {
+            file->release(pos);
+            last_release = pos;
+        }
+        return nb;
+    }
+};
+
+}  // namespace type
+}  // namespace navitia
@@ -434,10 +434,55 @@ void PbCreator::Filler::add_contributor(const T* nav) {
     for (const nt::Contributor* c : contributors) {
         if (!c->license.empty()) {
             pb_creator.contributors.insert(c);
+            if (pb_creator.nb_fragments_in_progress > 0) {
+                pb_creator.fragment_contributors.push_back(c);
+            }
         }
     }
 }
 
+template <typename NAV, typename PB>
+void PbCreator::Filler::fill_with_cache(const NAV* nav_object, PB* pb_object) {
+    auto& cache = pb_creator.data->pt_data->pb_fragment_cache;
+    const nt::PbFragmentCache::Key key{NAV::type,
+                                       nav_object->idx,
+                                       depth,
+                                       dump_message_options.dump_message == DumpMessage::Yes,
+                                       dump_message_options.dump_line_section == DumpLineSectionMessage::Yes,
+                                       pb_creator.disable_geojson,
+                                       pb_creator.disable_feedpublisher};
+    if (const auto fragment = cache.find(key)) {
+        pb_object->MergeFromString(fragment->serialized);
+        for (const auto* c : fragment->contributors) {
+            pb_creator.contributors.insert(c);
+        }
+        if (pb_creator.nb_fragments_in_progress > 0) {
+            auto& contributors = pb_creator.fragment_contributors;
+            contributors.insert(contributors.end(), fragment->contributors.begin(), fragment->contributors.end());
+        }
+        return;
+    }
+
+    // only the fragment of an object filled from scratch can be cached
+    const bool is_empty = pb_object->ByteSizeLong() == 0;
+    const auto nb_uncacheable_fills = pb_creator.nb_uncacheable_fills;
+    const auto first_contributor = pb_creator.fragment_contributors.size();
+    ++pb_creator.nb_fragments_in_progress;
+    fill_uncached_pb_object(nav_object, pb_object);
+    --pb_creator.nb_fragments_in_progress;
+
+    if (is_empty && nb_uncacheable_fills == pb_creator.nb_uncacheable_fills) {
+        nt::PbFragmentCache::Fragment fragment;
+        pb_object->SerializeToString(&fragment.serialized);
+        fragment.contributors.assign(pb_creator.fragment_contributors.begin() + first_contributor,
+                                     pb_creator.fragment_contributors.end());
+        cache.insert(key, std::move(fragment));
+    }
+    if (pb_creator.nb_fragments_in_progress == 0) {
+        pb_creator.fragment_contributors.clear();
+    }
+}
+
 template <typename NAV, typename PB>
 void PbCreator::Filler::fill(NAV* nav_object, PB* pb_object) {
     if (nav_object == nullptr) {
@@ -503,6 +548,10 @@ void PbCreator::Filler::fill_pb_object(const nt::Dataset* ds, pbnavitia::Dataset
 }
 
 void PbCreator::Filler::fill_pb_object(const nt::StopArea* sa, pbnavitia::StopArea* stop_area) {
+    fill_with_cache(sa, stop_area);
+}
+
+void PbCreator::Filler::fill_uncached_pb_object(const nt::StopArea* sa, pbnavitia::StopArea* stop_area) {
     stop_area->set_uri(sa->uri);
     add_contributor(sa);
     stop_area->set_name(sa->name);
@@ -547,7 +596,8 @@ void PbCreator::Filler::fill_pb_object(const ng::Admin* adm, pbnavitia::Administ
     if (depth > 1) {
         // for the admin we add the main stop area, but with the minimum vital information
         auto minimum_filler = Filler(0, {DumpMessage::No, DumpLineSectionMessage::No}, pb_creator);
-        for (const auto& sa : adm->main_stop_areas) {
+        for (const auto sa_idx : adm->main_stop_areas) {
+            const auto* sa = pb_creator.data->pt_data->stop_areas[sa_idx];
             auto* pb_sa = admin->add_main_stop_areas();
 
             minimum_filler.fill_pb_object(sa, pb_sa);
@@ -662,6 +712,10 @@ void PbCreator::Filler::fill_pb_object(const nt::CommercialMode* m, pbnavitia::C
 }
 
 void PbCreator::Filler::fill_pb_object(const nt::Line* l, pbnavitia::Line* line) {
+    fill_with_cache(l, line);
+}
+
+void PbCreator::Filler::fill_uncached_pb_object(const nt::Line* l, pbnavitia::Line* line) {
     fill_comments(l, line);
 
     if (!l->code.empty()) {
@@ -713,6 +767,7 @@ void PbCreator::Filler::fill_pb_object(const nt::Line* l, pbnavitia::Line* line)
          * We could have link the LineSection impact with the line, but that would change the code and
          * the behavior too much.
          * */
+        mark_uncacheable();
         auto fill_line_section_message = [&](const nt::VehicleJourney& vj) {
             for (const auto& impact_ptr : vj.meta_vj->get_publishable_messages(pb_creator.now)) {
                 if (impact_ptr->is_line_section_of(*vj.route->line)) {
@@ -728,6 +783,10 @@ void PbCreator::Filler::fill_pb_object(const nt::Line* l, pbnavitia::Line* line)
 }
 
 void PbCreator::Filler::fill_pb_object(const nt::Route* r, pbnavitia::Route* route) {
+    fill_with_cache(r, route);
+}
+
+void PbCreator::Filler::fill_uncached_pb_object(const nt::Route* r, pbnavitia::Route* route) {
     route->set_name(r->name);
     route->set_direction_type(r->direction_type);
 
@@ -1084,6 +1143,7 @@ static pbnavitia::Severity_Effect get_severity_effect(nd::Effect e) {
 
 template <typename P>
 void PbCreator::Filler::fill_message(const boost::shared_ptr<nd::Impact>& impact, P pb_object) {
+    mark_uncacheable();
     if (pb_creator.disable_disruption) {
         return;
     }
@@ -237,6 +237,8 @@ struct PbCreator {
         this->routing_section_map.clear();
         this->response.Clear();
         this->unknown_ticket = nullptr;
+        this->nb_fragments_in_progress = 0;
+        this->fragment_contributors.clear();
     }
 
     PbCreator(const PbCreator&) = delete;
@@ -345,6 +347,14 @@ struct PbCreator {
 
 private:
     pbnavitia::Response response;
+
+    // fills of cached protobuf fragments in progress (see Filler::fill_with_cache)
+    size_t nb_fragments_in_progress = 0;
+    // incremented by every fill depending on the request, such as the messages
+    size_t nb_uncacheable_fills = 0;
+    // contributors added by the fills in progress
+    std::vector<const nt::Contributor*> fragment_contributors;
+
     struct Filler {
         struct PtObjVisitor;
         const int depth;
@@ -408,6 +418,10 @@ private:
             if (dump_message_options.dump_message == DumpMessage::No) {
                 return;
             }
+            if (nav_obj->has_impacts()) {
+                // the applicable messages depend on the date of the request
+                mark_uncacheable();
+            }
             const bool dump_line_sections = dump_message_options.dump_line_section == DumpLineSectionMessage::Yes;
             for (const auto& message : nav_obj->get_applicable_messages(pb_creator.now, pb_creator.action_period)) {
                 if (!dump_line_sections && message->is_only_line_section()) {
@@ -425,6 +439,15 @@ private:
         template <typename T>
         void add_contributor(const T* nav);
 
+        void mark_uncacheable() { ++pb_creator.nb_uncacheable_fills; }
+
+        // fill the object from the PbFragmentCache of the data when possible, and feed it otherwise
+        template <typename NAV, typename PB>
+        void fill_with_cache(const NAV* nav_object, PB* pb_object);
+        void fill_uncached_pb_object(const nt::StopArea*, pbnavitia::StopArea*);
+        void fill_uncached_pb_object(const nt::Line*, pbnavitia::Line*);
+        void fill_uncached_pb_object(const nt::Route*, pbnavitia::Route*);
+
         template <typename NT, typename PB>
         void fill_codes(const NT* nt, PB* pb) {
             if (nt == nullptr) {
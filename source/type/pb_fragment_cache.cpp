@@ -0,0 +1,76 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#include "type/pb_fragment_cache.h"
+
+#include <boost/functional/hash.hpp>
+
+#include <mutex>
+
+namespace navitia {
+namespace type {
+
+size_t PbFragmentCache::KeyHash::operator()(const Key& key) const {
+    size_t seed = 0;
+    boost::hash_combine(seed, static_cast<int>(key.type));
+    boost::hash_combine(seed, key.idx);
+    boost::hash_combine(seed, key.depth);
+    boost::hash_combine(seed, (key.dump_message << 3) | (key.dump_line_section << 2) | (key.disable_geojson << 1)
+                                  | key.disable_feedpublisher);
+    return seed;
+}
+
+std::shared_ptr<const PbFragmentCache::Fragment> PbFragmentCache::find(const Key& key) const {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex);
+    const auto it = fragments.find(key);
+    if (it == fragments.end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+void PbFragmentCache::insert(const Key& key, Fragment fragment) {
+    auto value = std::make_shared<const Fragment>(std::move(fragment));
+    std::unique_lock<std::shared_timed_mutex> lock(mutex);
+    fragments.emplace(key, std::move(value));
+}
+
+void PbFragmentCache::clear() {
+    std::unique_lock<std::shared_timed_mutex> lock(mutex);
+    fragments.clear();
+}
+
+size_t PbFragmentCache::size() const {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex);
+    return fragments.size();
+}
+
+}  // namespace type
+}  // namespace navitia
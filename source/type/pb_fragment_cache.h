@@ -0,0 +1,91 @@
+/* Copyright © 2001-2014, Canal TP and/or its affiliates. All rights reserved.
+
+This file is part of Navitia,
+    the software to build cool stuff with public transport.
+
+Hope you'll enjoy and contribute to this project,
+    powered by Canal TP (www.canaltp.fr).
+Help us simplify mobility and open public transport:
+    a non ending quest to the responsive locomotion way of traveling!
+
+LICENCE: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Affero General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU Affero General Public License for more details.
+
+You should have received a copy of the GNU Affero General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+Stay tuned using
+twitter @navitia
+IRC #navitia on freenode
+https://groups.google.com/d/forum/navitia
+www.navitia.io
+*/
+
+#pragma once
+#include "type/type_interfaces.h"
+
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace navitia {
+namespace type {
+
+/**
+ * Serialized protobuf of the PT objects, as filled by the PbCreator.
+ *
+ * As long as an object and the objects dumped with it have no impact, its protobuf only depends
+ * on the data and on the fill options, so it is serialized once and merged in the next responses.
+ * The cache is shared by the workers, and it must be cleared whenever an impact is applied or
+ * deleted (see apply_disruption).
+ */
+class PbFragmentCache {
+public:
+    struct Key {
+        Type_e type;
+        idx_t idx;
+        int depth;
+        bool dump_message;
+        bool dump_line_section;
+        bool disable_geojson;
+        bool disable_feedpublisher;
+
+        bool operator==(const Key& other) const {
+            return type == other.type && idx == other.idx && depth == other.depth
+                   && dump_message == other.dump_message && dump_line_section == other.dump_line_section
+                   && disable_geojson == other.disable_geojson
+                   && disable_feedpublisher == other.disable_feedpublisher;
+        }
+    };
+
+    struct Fragment {
+        std::string serialized;
+        // the contributors to add to the feed publishers of the response
+        std::vector<const Contributor*> contributors;
+    };
+
+    std::shared_ptr<const Fragment> find(const Key& key) const;
+    void insert(const Key& key, Fragment fragment);
+    void clear();
+    size_t size() const;
+
+private:
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    mutable std::shared_timed_mutex mutex;
+    std::unordered_map<Key, std::shared_ptr<const Fragment>, KeyHash> fragments;
+};
+
+}  // namespace type
+}  // namespace navitia
@@ -43,9 +43,11 @@ void PT_Data::serialize(Archive& ar, const unsigned int) {
     ar
 #define SERIALIZE_ELEMENTS(type_name, collection_name) &collection_name& collection_name##_map
             ITERATE_NAVITIA_PT_TYPES(SERIALIZE_ELEMENTS)
-        & stop_area_autocomplete& stop_point_autocomplete& line_autocomplete& network_autocomplete& mode_autocomplete&
-              route_autocomplete& stop_area_proximity_list& stop_point_proximity_list& stop_point_connections&
-                  disruption_holder& meta_vjs& stop_points_by_area& comments& codes& headsign_handler& tz_manager;
+        & stop_point_connections& disruption_holder& meta_vjs& stop_points_by_area& comments& codes& headsign_handler&
+              tz_manager;
+    if (Archive::is_loading::value) {
+        impact_index.rebuild(disruption_holder);
+    }
 }
 SERIALIZABLE(PT_Data)
 
@@ -195,8 +197,46 @@ void PT_Data::sort_and_index() {
     std::for_each(stop_point_connections.begin(), stop_point_connections.end(), Indexer<idx_t>());
 }
 
+static std::string line_autocomplete_key(const Line& line) {
+    std::string key = "";
+    if (line.network) {
+        key = line.network->name;
+    }
+    if (line.commercial_mode) {
+        if (!key.empty()) {
+            key += " ";
+        }
+        key += line.commercial_mode->name;
+    }
+    if (!key.empty()) {
+        key += " ";
+    }
+    key += line.code;
+    return key + " " + line.name;
+}
+
+static std::string route_autocomplete_key(const Route& route) {
+    std::string key = "";
+    if (route.line) {
+        if (route.line->network) {
+            key = route.line->network->name;
+        }
+        if (route.line->commercial_mode) {
+            if (!key.empty()) {
+                key += " ";
+            }
+            key += route.line->commercial_mode->name;
+        }
+        if (!key.empty()) {
+            key += " ";
+        }
+        key += route.line->code;
+    }
+    return key + " " + route.name;
+}
+
 void PT_Data::build_autocomplete(const navitia::georef::GeoRef& georef) {
-    this->stop_area_autocomplete.clear();
+    this->stop_area_autocomplete = std::make_shared<autocomplete::Autocomplete<idx_t>>(Type_e::StopArea);
     for (const StopArea* sa : this->stop_areas) {
         // Don't add it to the dictionnary if name is empty
         if ((!sa->name.empty()) && (sa->visible)) {
@@ -206,12 +246,12 @@ void PT_Data::build_autocomplete(const navitia::georef::GeoRef& georef) {
                     key += " " + admin->name;
                 }
             }
-            this->stop_area_autocomplete.add_string(sa->name + key, sa->idx, georef.ghostwords, georef.synonyms);
+            this->stop_area_autocomplete->add_string(sa->name + key, sa->idx, georef.ghostwords, georef.synonyms);
         }
     }
-    this->stop_area_autocomplete.build();
+    this->stop_area_autocomplete->build();
 
-    this->stop_point_autocomplete.clear();
+    this->stop_point_autocomplete = std::make_shared<autocomplete::Autocomplete<idx_t>>(Type_e::StopPoint);
     for (const StopPoint* sp : this->stop_points) {
         // Don't add it to the dictionnary if name is empty
         if ((!sp->name.empty()) && ((sp->stop_area == nullptr) || (sp->stop_area->visible))) {
@@ -221,73 +261,69 @@ void PT_Data::build_autocomplete(const navitia::georef::GeoRef& georef) {
                     key += key + " " + admin->name;
                 }
             }
-            this->stop_point_autocomplete.add_string(sp->name + key, sp->idx, georef.ghostwords, georef.synonyms);
+            this->stop_point_autocomplete->add_string(sp->name + key, sp->idx, georef.ghostwords, georef.synonyms);
         }
     }
-    this->stop_point_autocomplete.build();
+    this->stop_point_autocomplete->build();
 
-    this->line_autocomplete.clear();
+    this->line_autocomplete = std::make_shared<autocomplete::Autocomplete<idx_t>>(Type_e::Line);
     for (const Line* line : this->lines) {
         if (!line->name.empty()) {
-            std::string key = "";
-            if (line->network) {
-                key = line->network->name;
-            }
-            if (line->commercial_mode) {
-                if (!key.empty()) {
-                    key += " ";
-                }
-                key += line->commercial_mode->name;
-            }
-            if (!key.empty()) {
-                key += " ";
-            }
-            key += line->code;
-            this->line_autocomplete.add_string(key + " " + line->name, line->idx, georef.ghostwords, georef.synonyms);
+            this->line_autocomplete->add_string(line_autocomplete_key(*line), line->idx, georef.ghostwords,
+                                                georef.synonyms);
         }
     }
-    this->line_autocomplete.build();
+    this->line_autocomplete->build();
 
-    this->network_autocomplete.clear();
+    this->network_autocomplete = std::make_shared<autocomplete::Autocomplete<idx_t>>(Type_e::Network);
     for (const Network* network : this->networks) {
         if (!network->name.empty()) {
-            this->network_autocomplete.add_string(network->name, network->idx, georef.ghostwords, georef.synonyms);
+            this->network_autocomplete->add_string(network->name, network->idx, georef.ghostwords, georef.synonyms);
         }
     }
-    this->network_autocomplete.build();
+    this->network_autocomplete->build();
 
-    this->mode_autocomplete.clear();
+    this->mode_autocomplete = std::make_shared<autocomplete::Autocomplete<idx_t>>(Type_e::CommercialMode);
     for (const CommercialMode* mode : this->commercial_modes) {
         if (!mode->name.empty()) {
-            this->mode_autocomplete.add_string(mode->name, mode->idx, georef.ghostwords, georef.synonyms);
+            this->mode_autocomplete->add_string(mode->name, mode->idx, georef.ghostwords, georef.synonyms);
         }
     }
-    this->mode_autocomplete.build();
+    this->mode_autocomplete->build();
 
-    this->route_autocomplete.clear();
+    this->route_autocomplete = std::make_shared<autocomplete::Autocomplete<idx_t>>(Type_e::Route);
     for (const Route* route : this->routes) {
         if (!route->name.empty()) {
-            std::string key = "";
-            if (route->line) {
-                if (route->line->network) {
-                    key = route->line->network->name;
-                }
-                if (route->line->commercial_mode) {
-                    if (!key.empty()) {
-                        key += " ";
-                    }
-                    key += route->line->commercial_mode->name;
-                }
-                if (!key.empty()) {
-                    key += " ";
-                }
-                key += route->line->code;
+            this->route_autocomplete->add_string(route_autocomplete_key(*route), route->idx, georef.ghostwords,
+                                                 georef.synonyms);
+        }
+    }
+    this->route_autocomplete->build();
+}
+
+// insert in the autocomplete the objects that are not yet in it
+template <typename T, typename F>
+static void insert_missing(std::shared_ptr<autocomplete::Autocomplete<idx_t>>& ac,
+                           const std::vector<T*>& objects,
+                           const navitia::georef::GeoRef& georef,
+                           const F& key) {
+    for (const T* obj : objects) {
+        if (!obj->name.empty() && ac->word_quality_list.count(obj->idx) == 0) {
+            // still shared with the data it has been cloned from, it is copied before its first change
+            if (ac.use_count() > 1) {
+                ac = std::make_shared<autocomplete::Autocomplete<idx_t>>(*ac);
             }
-            this->route_autocomplete.add_string(key + " " + route->name, route->idx, georef.ghostwords,
-                                                georef.synonyms);
+            ac->insert(key(*obj), obj->idx, georef.ghostwords, georef.synonyms);
         }
     }
-    this->route_autocomplete.build();
+}
+
+void PT_Data::update_autocomplete(const navitia::georef::GeoRef& georef) {
+    // the realtime can only create networks, commercial modes, lines and routes
+    insert_missing(network_autocomplete, networks, georef, [](const Network& network) { return network.name; });
+    insert_missing(mode_autocomplete, commercial_modes, georef, [](const CommercialMode& mode) { return mode.name; });
+    insert_missing(line_autocomplete, lines, georef, line_autocomplete_key);
+    insert_missing(route_autocomplete, routes, georef, route_autocomplete_key);
 }
 
 void PT_Data::compute_score_autocomplete(navitia::georef::GeoRef& georef) {
@@ -296,23 +332,23 @@ void PT_Data::compute_score_autocomplete(navitia::georef::GeoRef& georef) {
     // use the score of each admin for it's objects like "POI", "way" and "stop_point"
     georef.fl_way.compute_score((*this), georef, type::Type_e::Way);
     georef.fl_poi.compute_score((*this), georef, type::Type_e::POI);
-    this->stop_point_autocomplete.compute_score((*this), georef, type::Type_e::StopPoint);
+    this->stop_point_autocomplete->compute_score((*this), georef, type::Type_e::StopPoint);
     // Compute stop_area score using it's stop_point count
-    this->stop_area_autocomplete.compute_score((*this), georef, type::Type_e::StopArea);
+    this->stop_area_autocomplete->compute_score((*this), georef, type::Type_e::StopArea);
 }
 
 void PT_Data::build_proximity_list() {
-    this->stop_area_proximity_list.clear();
+    this->stop_area_proximity_list = std::make_shared<proximitylist::ProximityList<idx_t>>();
     for (const StopArea* stop_area : this->stop_areas) {
-        this->stop_area_proximity_list.add(stop_area->coord, stop_area->idx);
+        this->stop_area_proximity_list->add(stop_area->coord, stop_area->idx);
     }
-    this->stop_area_proximity_list.build();
+    this->stop_area_proximity_list->build();
 
-    this->stop_point_proximity_list.clear();
+    this->stop_point_proximity_list = std::make_shared<proximitylist::ProximityList<idx_t>>();
     for (const StopPoint* stop_point : this->stop_points) {
-        this->stop_point_proximity_list.add(stop_point->coord, stop_point->idx);
+        this->stop_point_proximity_list->add(stop_point->coord, stop_point->idx);
     }
-    this->stop_point_proximity_list.build();
+    this->stop_point_proximity_list->build();
 }
 
 void PT_Data::build_admins_stop_areas() {
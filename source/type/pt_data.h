@@ -43,6 +43,11 @@ www.navitia.io
 #include "code_container.h"
 #include "headsign_handler.h"
 #include "type/timezone_manager.h"
+#include "type/pb_fragment_cache.h"
+#include "type/impact_index.h"
+
+#include <memory>
+#include <unordered_set>
 
 namespace navitia {
 template <>
@@ -53,6 +58,29 @@ namespace type {
 
 typedef std::map<std::string, std::string> code_value_map_type;
 typedef std::map<std::string, code_value_map_type> type_code_codes_map_type;
+
+/**
+ * Uris of the vehicle journeys added, modified (validity patterns) or
+ * removed by the realtime since the last build of the raptor data.
+ *
+ * It is used to update the raptor data of a cloned data incrementally
+ * (see dataRAPTOR::load), thus it is not serialized.
+ */
+struct VehicleJourneyDelta {
+    std::unordered_set<std::string> added;
+    std::unordered_set<std::string> modified;
+    std::unordered_set<std::string> removed;
+
+    bool empty() const { return added.empty() && modified.empty() && removed.empty(); }
+    bool contains(const std::string& vj_uri) const {
+        return added.count(vj_uri) || modified.count(vj_uri) || removed.count(vj_uri);
+    }
+    void clear() {
+        added.clear();
+        modified.clear();
+        removed.clear();
+    }
+};
 struct PT_Data : boost::noncopyable {
     template <typename T>
     const std::vector<T*>& collection() const {
@@ -74,22 +102,26 @@ struct PT_Data : boost::noncopyable {
     std::vector<AssociatedCalendar*> associated_calendars;
 
     // First letter
-    autocomplete::Autocomplete<idx_t> stop_area_autocomplete =
-        autocomplete::Autocomplete<idx_t>(navitia::type::Type_e::StopArea);
-    autocomplete::Autocomplete<idx_t> stop_point_autocomplete =
-        autocomplete::Autocomplete<idx_t>(navitia::type::Type_e::StopPoint);
-    autocomplete::Autocomplete<idx_t> line_autocomplete =
-        autocomplete::Autocomplete<idx_t>(navitia::type::Type_e::Line);
-    autocomplete::Autocomplete<idx_t> network_autocomplete =
-        autocomplete::Autocomplete<idx_t>(navitia::type::Type_e::Network);
-    autocomplete::Autocomplete<idx_t> mode_autocomplete =
-        autocomplete::Autocomplete<idx_t>(navitia::type::Type_e::CommercialMode);
-    autocomplete::Autocomplete<idx_t> route_autocomplete =
-        autocomplete::Autocomplete<idx_t>(navitia::type::Type_e::Route);
+    // The autocompletes and the proximity lists are shared by the data cloned
+    // for the realtime (see Data::clone_from), they are replaced, not modified
+    std::shared_ptr<autocomplete::Autocomplete<idx_t>> stop_area_autocomplete =
+        std::make_shared<autocomplete::Autocomplete<idx_t>>(navitia::type::Type_e::StopArea);
+    std::shared_ptr<autocomplete::Autocomplete<idx_t>> stop_point_autocomplete =
+        std::make_shared<autocomplete::Autocomplete<idx_t>>(navitia::type::Type_e::StopPoint);
+    std::shared_ptr<autocomplete::Autocomplete<idx_t>> line_autocomplete =
+        std::make_shared<autocomplete::Autocomplete<idx_t>>(navitia::type::Type_e::Line);
+    std::shared_ptr<autocomplete::Autocomplete<idx_t>> network_autocomplete =
+        std::make_shared<autocomplete::Autocomplete<idx_t>>(navitia::type::Type_e::Network);
+    std::shared_ptr<autocomplete::Autocomplete<idx_t>> mode_autocomplete =
+        std::make_shared<autocomplete::Autocomplete<idx_t>>(navitia::type::Type_e::CommercialMode);
+    std::shared_ptr<autocomplete::Autocomplete<idx_t>> route_autocomplete =
+        std::make_shared<autocomplete::Autocomplete<idx_t>>(navitia::type::Type_e::Route);
 
     // Proximity list
-    proximitylist::ProximityList<idx_t> stop_area_proximity_list;
-    proximitylist::ProximityList<idx_t> stop_point_proximity_list;
+    std::shared_ptr<proximitylist::ProximityList<idx_t>> stop_area_proximity_list =
+        std::make_shared<proximitylist::ProximityList<idx_t>>();
+    std::shared_ptr<proximitylist::ProximityList<idx_t>> stop_point_proximity_list =
+        std::make_shared<proximitylist::ProximityList<idx_t>>();
 
     // Message
     disruption::DisruptionHolder disruption_holder;
@@ -109,6 +141,15 @@ struct PT_Data : boost::noncopyable {
     // timezone manager
     TimeZoneManager tz_manager;
 
+    // vehicle journeys touched by the realtime since the last raptor build
+    VehicleJourneyDelta vj_delta;
+
+    // serialized protobuf of the objects, filled while answering the requests, thus not serialized
+    mutable PbFragmentCache pb_fragment_cache;
+
+    // objects linked to the impacts, rebuilt when loaded, thus not serialized
+    ImpactIndex impact_index;
+
     template <class Archive>
     void serialize(Archive& ar, const unsigned int);
     /** Construit l'indexe ExternelCode */
@@ -117,6 +158,9 @@ struct PT_Data : boost::noncopyable {
     /** Construit l'indexe Autocomplete */
     void build_autocomplete(const navitia::georef::GeoRef&);
 
+    /** Insert in the Autocomplete index the objects added since its build (by the realtime) */
+    void update_autocomplete(const navitia::georef::GeoRef&);
+
     /** Calcul le score des objectTC */
     void compute_score_autocomplete(navitia::georef::GeoRef&);
 
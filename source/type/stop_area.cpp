@@ -39,8 +39,8 @@ namespace type {
 
 template <class Archive>
 void StopArea::serialize(Archive& ar, const unsigned int) {
-    ar& idx& label& uri& name& coord& stop_point_list& admin_list& _properties& wheelchair_boarding& impacts& visible&
-        timezone;
+    // admin_list is serialized by Data as admin idx, the admins being in the georef
+    ar& idx& label& uri& name& coord& stop_point_list& _properties& wheelchair_boarding& impacts& visible& timezone;
 }
 SERIALIZABLE(StopArea)
 
@@ -46,8 +46,8 @@ void StopPoint::serialize(Archive& ar, const unsigned int) {
     // during serialization and deserialization.
     //
     // stop_point_connection_list is managed by StopPointConnection
-    ar& uri& label& name& stop_area& coord& fare_zone& is_zonal& idx& platform_code& admin_list& _properties& impacts&
-        dataset_list;
+    // admin_list is serialized by Data as admin idx, the admins being in the georef
+    ar& uri& label& name& stop_area& coord& fare_zone& is_zonal& idx& platform_code& _properties& impacts& dataset_list;
 }
 SERIALIZABLE(StopPoint)
 
@@ -42,6 +42,12 @@ www.navitia.io
 
 // Data to test
 #include "type/data.h"
+#include "type/pt_data.h"
+#include "type/stop_point.h"
+#include "type/stop_area.h"
+#include "georef/georef.h"
+#include "georef/adminref.h"
+#include "ed/build_helper.h"
 
 using namespace navitia;
 
@@ -75,6 +81,54 @@ BOOST_AUTO_TEST_CASE(load_data) {
     boost::filesystem::remove(fake_data_path);
 }
 
+BOOST_AUTO_TEST_CASE(load_raw_data) {
+    ed::builder b("20120614");
+    b.vj("A")("stop1", 8000, 8050)("stop2", 8200, 8250);
+    b.vj("B")("stop2", 9000, 9050)("stop3", 9200, 9250)("stop4", 9400, 9450);
+    b.finish();
+    b.data->pt_data->sort_and_index();
+    b.data->geo_ref->admins.push_back(new navitia::georef::Admin());
+    b.data->geo_ref->admins.back()->uri = "admin:1";
+    b.data->geo_ref->admins.back()->idx = 0;
+    b.sps.at("stop2")->admin_list.push_back(b.data->geo_ref->admins.back());
+    b.sas.at("stop2")->admin_list.push_back(b.data->geo_ref->admins.back());
+    const auto sp_idx = b.sps.at("stop2")->idx;
+    const auto sa_idx = b.sas.at("stop2")->idx;
+
+    const std::string raw_data_path = navitia::absolute_path() + "fake_data.nav";
+    const std::string lz4_data_path = navitia::absolute_path() + fake_data_file;
+    b.data->save(raw_data_path, navitia::type::NavFormat::Raw);
+    b.data->save(lz4_data_path);
+
+    // both formats are recognized by load_nav and give the same data
+    for (const auto& path : {raw_data_path, lz4_data_path}) {
+        navitia::type::Data data(0);
+        BOOST_REQUIRE_NO_THROW(data.load_nav(path));
+        BOOST_CHECK_EQUAL(data.last_load_succeeded, true);
+        BOOST_CHECK_EQUAL(data.pt_data->stop_points.size(), b.data->pt_data->stop_points.size());
+        BOOST_CHECK_EQUAL(data.pt_data->vehicle_journeys.size(), 2u);
+        BOOST_CHECK_EQUAL(data.pt_data->nb_stop_times(), 5u);
+        // the admins of the pt objects are the ones of the georef
+        BOOST_REQUIRE_EQUAL(data.geo_ref->admins.size(), 1u);
+        const auto& sp_admins = data.pt_data->stop_points.at(sp_idx)->admin_list;
+        const auto& sa_admins = data.pt_data->stop_areas.at(sa_idx)->admin_list;
+        BOOST_REQUIRE_EQUAL(sp_admins.size(), 1u);
+        BOOST_CHECK_EQUAL(sp_admins.front(), data.geo_ref->admins.front());
+        BOOST_CHECK_EQUAL(sp_admins.front()->uri, "admin:1");
+        BOOST_REQUIRE_EQUAL(sa_admins.size(), 1u);
+        BOOST_CHECK_EQUAL(sa_admins.front(), data.geo_ref->admins.front());
+        BOOST_CHECK_EQUAL(data.pt_data->stop_points.at(b.sps.at("stop1")->idx)->admin_list.size(), 0u);
+    }
+
+    // a truncated raw file is an error, not a partial loading
+    boost::filesystem::resize_file(raw_data_path, boost::filesystem::file_size(raw_data_path) / 2);
+    navitia::type::Data data(0);
+    BOOST_CHECK_THROW(data.load_nav(raw_data_path), navitia::data::data_loading_error);
+
+    boost::filesystem::remove(raw_data_path);
+    boost::filesystem::remove(lz4_data_path);
+}
+
 BOOST_AUTO_TEST_CASE(load_disruptions_fail) {
     navitia::type::Data data(0);
 
@@ -230,6 +230,75 @@ BOOST_AUTO_TEST_CASE(ptref_indexes_test) {
     BOOST_CHECK_EQUAL_RANGE(uris(objs), std::set<std::string>({"c1"}));
 }
 
+/*
+ * The protobuf of the stop areas, lines and routes are cached by the data,
+ * unless they (or the objects dumped with them) have impacts
+ */
+BOOST_AUTO_TEST_CASE(pb_fragment_cache) {
+    ed::builder b("20160101");
+
+    auto* c1 = b.add<nt::Contributor>("c1", "name-c1");
+    c1->license = "license-c1";
+    auto* d1 = b.add<nt::Dataset>("d1", "name-d1");
+    d1->contributor = c1;
+    c1->dataset_list.insert(d1);
+
+    auto* vj = b.vj("A")("stop1", 8000, 8050)("stop2", 8200, 8250).make();
+    vj->dataset = d1;
+    b.data->build_relations();
+    b.make();
+
+    const auto& cache = b.data->pt_data->pb_fragment_cache;
+    const auto* route = b.data->pt_data->routes_map["A:0"];
+    const auto now = "20160101T080000"_dt;
+    const auto period = boost::posix_time::time_period("20160101T000000"_dt, "20160102T000000"_dt);
+    auto line_key = [&](int depth) {
+        return nt::PbFragmentCache::Key{nt::Type_e::Line, route->line->idx, depth, true, false, false, false};
+    };
+    BOOST_CHECK_EQUAL(cache.size(), 0);
+
+    navitia::PbCreator first_creator(b.data.get(), now, period);
+    pbnavitia::Route first_route;
+    first_creator.fill(route, &first_route, 3);
+    // the route and its nested lines, routes and stop areas
+    const auto nb_fragments = cache.size();
+    BOOST_CHECK(cache.find(line_key(2)) != nullptr);
+
+    navitia::PbCreator second_creator(b.data.get(), now, period);
+    pbnavitia::Route second_route;
+    second_creator.fill(route, &second_route, 3);
+    BOOST_CHECK_EQUAL(cache.size(), nb_fragments);
+    BOOST_CHECK_EQUAL(second_route.SerializeAsString(), first_route.SerializeAsString());
+    BOOST_CHECK_EQUAL(second_route.stop_points_size(), 2);
+    BOOST_CHECK_EQUAL_RANGE(uris(second_creator.contributors), std::set<std::string>({"c1"}));
+
+    // another depth is another fragment
+    pbnavitia::Route shallow_route;
+    second_creator.fill(route, &shallow_route, 0);
+    BOOST_CHECK_EQUAL(shallow_route.stop_points_size(), 0);
+    BOOST_CHECK_EQUAL(cache.size(), nb_fragments + 1);
+
+    // an impact clears the cache, and the impacted objects are not cached anymore
+    b.impact(nt::RTLevel::Adapted)
+        .uri("impact_on_line")
+        .publish(period)
+        .application_periods(period)
+        .severity(nt::disruption::Effect::SIGNIFICANT_DELAYS)
+        .on(nt::Type_e::Line, "A")
+        .msg("late");
+    BOOST_CHECK_EQUAL(cache.size(), 0);
+
+    navitia::PbCreator third_creator(b.data.get(), now, period);
+    pbnavitia::Route impacted_route;
+    third_creator.fill(route, &impacted_route, 3);
+    BOOST_REQUIRE_EQUAL(impacted_route.line().impact_uris_size(), 1);
+    BOOST_CHECK_EQUAL(impacted_route.line().impact_uris(0), "impact_on_line");
+    BOOST_CHECK(cache.find(line_key(2)) == nullptr);
+    // the stop areas are still cached
+    BOOST_CHECK(cache.size() > 0);
+    BOOST_CHECK(cache.size() < nb_fragments);
+}
+
 BOOST_AUTO_TEST_CASE(label_formater_line) {
     auto network_rer = std::make_unique<navitia::type::Network>();
     network_rer->name = "RER";
@@ -122,6 +122,7 @@ void cleanup_useless_vj_link(const nt::VehicleJourney* vj, nt::PT_Data& pt_data)
     std::for_each(pt_data.vehicle_journeys.begin(), pt_data.vehicle_journeys.end(), Indexer<nt::idx_t>());
 
     pt_data.vehicle_journeys_map.erase(vj->uri);
+    pt_data.vj_delta.removed.insert(vj->uri);
 }
 }  // anonymous namespace
 
@@ -226,7 +227,11 @@ VJ* MetaVehicleJourney::impl_create_vj(const std::string& uri,
             if (l != RTLevel::Base) {
                 auto new_vp = *vj.validity_patterns[l];
                 new_vp.days &= (mask << vj.shift);
-                vj.validity_patterns[l] = pt_data.get_or_create_validity_pattern(new_vp);
+                auto* vp = pt_data.get_or_create_validity_pattern(new_vp);
+                if (vp != vj.validity_patterns[l]) {
+                    vj.validity_patterns[l] = vp;
+                    pt_data.vj_delta.modified.insert(vj.uri);
+                }
             }
         }
     });
@@ -238,6 +243,7 @@ VJ* MetaVehicleJourney::impl_create_vj(const std::string& uri,
     vj_ptr->idx = pt_data.vehicle_journeys.size();
     pt_data.vehicle_journeys.push_back(ret);
     pt_data.vehicle_journeys_map[ret->uri] = ret;
+    pt_data.vj_delta.added.insert(ret->uri);
     if (route) {
         get_vjs<VJ>(route).push_back(ret);
     }
@@ -287,6 +293,7 @@ void MetaVehicleJourney::cancel_vj(RTLevel level,
 
                 if (concerns_base_at_period(*vj, vp_level, periods, vp_modifier)) {
                     vj->validity_patterns[vp_level] = pt_data.get_or_create_validity_pattern(tmp_vp);
+                    pt_data.vj_delta.modified.insert(vj->uri);
                 }
             }
         }
@@ -248,6 +248,9 @@ public:
 
     std::vector<boost::shared_ptr<disruption::Impact>> get_impacts() const;
 
+    // true if an impact, even an expired one, is linked to the object
+    bool has_impacts() const { return !impacts.empty(); }
+
     void remove_impact(const boost::shared_ptr<disruption::Impact>& impact) {
         auto it = std::find_if(impacts.begin(), impacts.end(),
                                [&impact](const boost::weak_ptr<disruption::Impact>& i) { return i.lock() == impact; });